@@ -581,6 +581,7 @@ fallback_init_debounce(struct fallback_dispatch *dispatch)
 			    timer_name,
 			    debounce_timeout_short,
 			    device);
+	libinput_timer_set_device(&dispatch->debounce.timer_short, &device->base);
 
 	snprintf(timer_name,
 		 sizeof(timer_name),
@@ -591,4 +592,5 @@ fallback_init_debounce(struct fallback_dispatch *dispatch)
 			    timer_name,
 			    debounce_timeout,
 			    device);
+	libinput_timer_set_device(&dispatch->debounce.timer, &device->base);
 }
@@ -198,10 +198,7 @@ fallback_flush_relative_motion(struct fallback_dispatch *dispatch,
 
 	if (device->pointer.filter) {
 		/* Apply pointer acceleration. */
-		accel = filter_dispatch(device->pointer.filter,
-					&raw,
-					device,
-					time);
+		accel = evdev_filter_dispatch(device, &raw, device, time);
 	} else {
 		evdev_log_bug_libinput(device,
 				       "accel filter missing\n");
@@ -973,6 +970,28 @@ fallback_flush_mt_events(struct fallback_dispatch *dispatch,
 	return sent;
 }
 
+static void
+fallback_flush_keys(struct fallback_dispatch *dispatch,
+		    uint64_t time)
+{
+	bool want_debounce = false;
+
+	for (unsigned int code = 0; code <= KEY_MAX; code++) {
+		if (!hw_key_has_changed(dispatch, code))
+			continue;
+
+		if (get_key_type(code) == KEY_TYPE_BUTTON) {
+			want_debounce = true;
+			break;
+		}
+	}
+
+	if (want_debounce)
+		fallback_debounce_handle_state(dispatch, time);
+
+	hw_key_update_last_state(dispatch);
+}
+
 static void
 fallback_handle_state(struct fallback_dispatch *dispatch,
 		      struct evdev_device *device,
@@ -1018,27 +1037,184 @@ fallback_handle_state(struct fallback_dispatch *dispatch,
 	fallback_flush_wheels(dispatch, device, time);
 
 	/* Buttons and keys */
-	if (dispatch->pending_event & EVDEV_KEY) {
-		bool want_debounce = false;
-		for (unsigned int code = 0; code <= KEY_MAX; code++) {
-			if (!hw_key_has_changed(dispatch, code))
+	if (dispatch->pending_event & EVDEV_KEY)
+		fallback_flush_keys(dispatch, time);
+
+	dispatch->pending_event = EVDEV_NONE;
+}
+
+/* The fallback_handle_state_* variants below are used by the specialized
+ * interfaces, see fallback_select_interface(). Each one only flushes what
+ * the device can possibly send, the result must be identical to
+ * fallback_handle_state() for that device. */
+static void
+fallback_handle_state_keyboard(struct fallback_dispatch *dispatch,
+			       struct evdev_device *device,
+			       uint64_t time)
+{
+	if (dispatch->pending_event & EVDEV_KEY)
+		fallback_flush_keys(dispatch, time);
+
+	dispatch->pending_event = EVDEV_NONE;
+}
+
+static void
+fallback_handle_state_pointer(struct fallback_dispatch *dispatch,
+			      struct evdev_device *device,
+			      uint64_t time)
+{
+	if (dispatch->pending_event & EVDEV_RELATIVE_MOTION)
+		fallback_flush_relative_motion(dispatch, device, time);
+
+	/* wheel deltas only accumulate with EVDEV_WHEEL set */
+	if (dispatch->pending_event & EVDEV_WHEEL)
+		fallback_flush_wheels(dispatch, device, time);
+
+	if (dispatch->pending_event & EVDEV_KEY)
+		fallback_flush_keys(dispatch, time);
+
+	dispatch->pending_event = EVDEV_NONE;
+}
+
+static void
+fallback_handle_state_touch_mt(struct fallback_dispatch *dispatch,
+			       struct evdev_device *device,
+			       uint64_t time)
+{
+	if ((dispatch->pending_event & EVDEV_ABSOLUTE_MT) &&
+	    fallback_flush_mt_events(dispatch, device, time))
+		touch_notify_frame(&device->base, time);
+
+	if (dispatch->pending_event & EVDEV_KEY)
+		fallback_flush_keys(dispatch, time);
+
+	dispatch->pending_event = EVDEV_NONE;
+}
+
+static void
+fallback_passthrough_notify_button(struct fallback_dispatch *dispatch,
+				   struct evdev_device *device,
+				   uint64_t time,
+				   int button,
+				   enum libinput_button_state state)
+{
+	int down_count;
+
+	down_count = evdev_update_key_down_count(device, button, state);
+
+	if ((state == LIBINPUT_BUTTON_STATE_PRESSED && down_count == 1) ||
+	    (state == LIBINPUT_BUTTON_STATE_RELEASED && down_count == 0))
+		pointer_notify_button(&device->base, time, button, state);
+}
+
+static void
+fallback_passthrough_flush_buttons(struct fallback_dispatch *dispatch,
+				   struct evdev_device *device,
+				   uint64_t time)
+{
+	for (size_t i = 0; i < ARRAY_LENGTH(dispatch->hw_key_mask); i++) {
+		unsigned long changed = dispatch->hw_key_mask[i] ^
+					dispatch->last_hw_key_mask[i];
+
+		while (changed) {
+			int code = i * LONG_BITS + ffsl(changed) - 1;
+
+			changed &= changed - 1;
+
+			if (get_key_type(code) != KEY_TYPE_BUTTON)
 				continue;
 
-			if (get_key_type(code) == KEY_TYPE_BUTTON) {
-				want_debounce = true;
-				break;
-			}
+			fallback_passthrough_notify_button(
+				dispatch,
+				device,
+				time,
+				code,
+				hw_is_key_down(dispatch, code) ?
+					LIBINPUT_BUTTON_STATE_PRESSED :
+					LIBINPUT_BUTTON_STATE_RELEASED);
 		}
+	}
 
-		if (want_debounce)
-			fallback_debounce_handle_state(dispatch, time);
+	hw_key_update_last_state(dispatch);
+}
 
-		hw_key_update_last_state(dispatch);
+/* Frame handling for raw passthrough, keys are already sent in
+ * fallback_process_key() */
+static void
+fallback_handle_state_passthrough(struct fallback_dispatch *dispatch,
+				  struct evdev_device *device,
+				  uint64_t time)
+{
+	if ((dispatch->pending_event & EVDEV_RELATIVE_MOTION) &&
+	    (device->seat_caps & EVDEV_DEVICE_POINTER)) {
+		struct normalized_coords unaccel;
+		struct device_float_coords raw;
+
+		normalize_delta(device, &dispatch->rel, &unaccel);
+		raw.x = dispatch->rel.x;
+		raw.y = dispatch->rel.y;
+		dispatch->rel.x = 0;
+		dispatch->rel.y = 0;
+
+		if (!normalized_is_zero(unaccel))
+			pointer_notify_motion(&device->base, time, &unaccel, &raw);
 	}
 
+	if (dispatch->pending_event & EVDEV_ABSOLUTE_MOTION)
+		fallback_flush_absolute_motion(dispatch, device, time);
+
+	if (dispatch->pending_event & EVDEV_WHEEL)
+		fallback_flush_wheels(dispatch, device, time);
+
+	if (dispatch->pending_event & EVDEV_KEY)
+		fallback_passthrough_flush_buttons(dispatch, device, time);
+
 	dispatch->pending_event = EVDEV_NONE;
 }
 
+/* Switch between raw passthrough and the normal frame processing. Called
+ * at the end of each frame, the switch is delayed until no button is
+ * down and the debouncing state machine is idle so neither path has to
+ * deal with a half-processed button. */
+static inline void
+fallback_passthrough_apply(struct fallback_dispatch *dispatch,
+			   struct evdev_device *device)
+{
+	if (dispatch->passthrough.want_enabled == dispatch->passthrough.enabled)
+		return;
+
+	if (fallback_any_button_down(dispatch, device))
+		return;
+
+	if (dispatch->debounce.state != DEBOUNCE_STATE_IS_UP &&
+	    dispatch->debounce.state != DEBOUNCE_STATE_DISABLED)
+		return;
+
+	dispatch->passthrough.enabled = dispatch->passthrough.want_enabled;
+	evdev_log_debug(device,
+			"passthrough: %s\n",
+			dispatch->passthrough.enabled ? "on" : "off");
+}
+
+static inline void
+fallback_process_frame(struct fallback_dispatch *dispatch,
+		       struct evdev_device *device,
+		       uint64_t time,
+		       void (*handle_state)(struct fallback_dispatch *dispatch,
+					    struct evdev_device *device,
+					    uint64_t time))
+{
+	struct evdev_stage_timer t = evdev_stage_begin(device);
+
+	if (dispatch->passthrough.enabled)
+		fallback_handle_state_passthrough(dispatch, device, time);
+	else
+		handle_state(dispatch, device, time);
+	evdev_stage_end(device, LIBINPUT_STAGE_FALLBACK_HANDLE_STATE, t);
+
+	fallback_passthrough_apply(dispatch, device);
+}
+
 static void
 fallback_interface_process(struct evdev_dispatch *evdev_dispatch,
 			   struct evdev_device *device,
@@ -1064,11 +1240,100 @@ fallback_interface_process(struct evdev_dispatch *evdev_dispatch,
 		fallback_process_switch(dispatch, device, event, time);
 		break;
 	case EV_SYN:
-		fallback_handle_state(dispatch, device, time);
+		fallback_process_frame(dispatch,
+				       device,
+				       time,
+				       fallback_handle_state);
 		break;
 	}
 }
 
+static void
+fallback_keyboard_interface_process(struct evdev_dispatch *evdev_dispatch,
+				    struct evdev_device *device,
+				    struct input_event *event,
+				    uint64_t time)
+{
+	struct fallback_dispatch *dispatch = fallback_dispatch(evdev_dispatch);
+
+	switch (event->type) {
+	case EV_KEY:
+		fallback_process_key(dispatch, device, event, time);
+		break;
+	case EV_SYN:
+		fallback_process_frame(dispatch,
+				       device,
+				       time,
+				       fallback_handle_state_keyboard);
+		break;
+	}
+}
+
+static void
+fallback_pointer_interface_process(struct evdev_dispatch *evdev_dispatch,
+				   struct evdev_device *device,
+				   struct input_event *event,
+				   uint64_t time)
+{
+	struct fallback_dispatch *dispatch = fallback_dispatch(evdev_dispatch);
+
+	switch (event->type) {
+	case EV_REL:
+		fallback_process_relative(dispatch, device, event, time);
+		break;
+	case EV_KEY:
+		fallback_process_key(dispatch, device, event, time);
+		break;
+	case EV_SYN:
+		fallback_process_frame(dispatch,
+				       device,
+				       time,
+				       fallback_handle_state_pointer);
+		break;
+	}
+}
+
+static void
+fallback_touch_mt_interface_process(struct evdev_dispatch *evdev_dispatch,
+				    struct evdev_device *device,
+				    struct input_event *event,
+				    uint64_t time)
+{
+	struct fallback_dispatch *dispatch = fallback_dispatch(evdev_dispatch);
+
+	if (dispatch->arbitration.in_arbitration)
+		return;
+
+	switch (event->type) {
+	case EV_ABS:
+		fallback_process_touch(dispatch, device, event, time);
+		break;
+	case EV_KEY:
+		fallback_process_key(dispatch, device, event, time);
+		break;
+	case EV_SYN:
+		fallback_process_frame(dispatch,
+				       device,
+				       time,
+				       fallback_handle_state_touch_mt);
+		break;
+	}
+}
+
+static void
+fallback_switch_interface_process(struct evdev_dispatch *evdev_dispatch,
+				  struct evdev_device *device,
+				  struct input_event *event,
+				  uint64_t time)
+{
+	struct fallback_dispatch *dispatch = fallback_dispatch(evdev_dispatch);
+
+	/* Switch events are sent immediately, there is nothing to do on
+	 * EV_SYN */
+	if (event->type == EV_SW)
+		fallback_process_switch(dispatch, device, event, time);
+}
+
 static void
 cancel_touches(struct fallback_dispatch *dispatch,
 	       struct evdev_device *device,
@@ -1437,6 +1702,22 @@ fallback_pair_tablet_mode(struct evdev_device *keyboard,
 	}
 }
 
+static uint32_t
+fallback_interface_pairs_with(struct evdev_device *device)
+{
+	uint32_t classes = 0;
+
+	if (device->tags & EVDEV_TAG_LID_SWITCH)
+		classes |= EVDEV_PAIR_KEYBOARD;
+
+	/* see fallback_pair_tablet_mode() */
+	if ((device->tags & EVDEV_TAG_EXTERNAL_KEYBOARD) == 0 &&
+	    (device->tags & (EVDEV_TAG_TRACKPOINT|EVDEV_TAG_INTERNAL_KEYBOARD)))
+		classes |= EVDEV_PAIR_TABLET_MODE_SWITCH;
+
+	return classes;
+}
+
 static void
 fallback_interface_device_added(struct evdev_device *device,
 				struct evdev_device *added_device)
@@ -1474,20 +1755,91 @@ fallback_interface_device_removed(struct evdev_device *device,
 	}
 }
 
-struct evdev_dispatch_interface fallback_interface = {
-	.process = fallback_interface_process,
-	.suspend = fallback_interface_suspend,
-	.remove = fallback_interface_remove,
-	.destroy = fallback_interface_destroy,
-	.device_added = fallback_interface_device_added,
-	.device_removed = fallback_interface_device_removed,
-	.device_suspended = fallback_interface_device_removed, /* treat as remove */
-	.device_resumed = fallback_interface_device_added,   /* treat as add */
-	.post_added = fallback_interface_sync_initial_state,
-	.touch_arbitration_toggle = fallback_interface_toggle_touch,
-	.touch_arbitration_update_rect = fallback_interface_update_rect,
-	.get_switch_state = fallback_interface_get_switch_state,
-};
+/* All fallback interfaces share the same fallback_dispatch, they only
+ * differ in their process() */
+#define FALLBACK_INTERFACE(process_) { \
+	.process = process_, \
+	.suspend = fallback_interface_suspend, \
+	.remove = fallback_interface_remove, \
+	.destroy = fallback_interface_destroy, \
+	.pairs_with = fallback_interface_pairs_with, \
+	.device_added = fallback_interface_device_added, \
+	.device_removed = fallback_interface_device_removed, \
+	.device_suspended = fallback_interface_device_removed, /* treat as remove */ \
+	.device_resumed = fallback_interface_device_added,   /* treat as add */ \
+	.post_added = fallback_interface_sync_initial_state, \
+	.touch_arbitration_toggle = fallback_interface_toggle_touch, \
+	.touch_arbitration_update_rect = fallback_interface_update_rect, \
+	.get_switch_state = fallback_interface_get_switch_state, \
+}
+
+struct evdev_dispatch_interface fallback_interface =
+	FALLBACK_INTERFACE(fallback_interface_process);
+static struct evdev_dispatch_interface fallback_keyboard_interface =
+	FALLBACK_INTERFACE(fallback_keyboard_interface_process);
+static struct evdev_dispatch_interface fallback_pointer_interface =
+	FALLBACK_INTERFACE(fallback_pointer_interface_process);
+static struct evdev_dispatch_interface fallback_touch_mt_interface =
+	FALLBACK_INTERFACE(fallback_touch_mt_interface_process);
+static struct evdev_dispatch_interface fallback_switch_interface =
+	FALLBACK_INTERFACE(fallback_switch_interface_process);
+
+static const char *
+fallback_interface_name(const struct evdev_dispatch_interface *interface)
+{
+	if (interface == &fallback_keyboard_interface)
+		return "keyboard";
+	if (interface == &fallback_pointer_interface)
+		return "pointer";
+	if (interface == &fallback_touch_mt_interface)
+		return "touch-mt";
+	if (interface == &fallback_switch_interface)
+		return "switch";
+	return "generic";
+}
+
+/* Pick an interface with a process() that skips the event types and
+ * frame state the device can never produce. Anything that doesn't
+ * clearly fit one of the specialized interfaces uses the generic one. */
+static struct evdev_dispatch_interface *
+fallback_select_interface(struct evdev_device *device)
+{
+	struct libevdev *evdev = device->evdev;
+	bool has_key = libevdev_has_event_type(evdev, EV_KEY),
+	     has_rel = libevdev_has_event_type(evdev, EV_REL),
+	     has_abs = libevdev_has_event_type(evdev, EV_ABS),
+	     has_sw = libevdev_has_event_type(evdev, EV_SW);
+	const enum evdev_device_seat_capability pointer_caps =
+		EVDEV_DEVICE_POINTER|EVDEV_DEVICE_KEYBOARD;
+
+	/* For the test suite to compare against the generic path */
+	if (getenv("LIBINPUT_RUNNING_TEST_SUITE") &&
+	    getenv("LIBINPUT_FALLBACK_GENERIC_INTERFACE"))
+		return &fallback_interface;
+
+	if (has_abs || has_sw) {
+		if (device->seat_caps == EVDEV_DEVICE_TOUCH &&
+		    device->is_mt && !has_rel && !has_sw)
+			return &fallback_touch_mt_interface;
+
+		if (device->seat_caps == EVDEV_DEVICE_SWITCH &&
+		    !has_key && !has_rel && !has_abs)
+			return &fallback_switch_interface;
+
+		return &fallback_interface;
+	}
+
+	if (device->seat_caps == EVDEV_DEVICE_KEYBOARD && !has_rel)
+		return &fallback_keyboard_interface;
+
+	/* relative pointers, including mice with keyboard keys */
+	if (has_rel &&
+	    (device->seat_caps & EVDEV_DEVICE_POINTER) &&
+	    (device->seat_caps & ~pointer_caps) == 0)
+		return &fallback_pointer_interface;
+
+	return &fallback_interface;
+}
 
 static void
 fallback_change_to_left_handed(struct evdev_device *device)
@@ -1573,6 +1925,63 @@ fallback_init_rotation(struct fallback_dispatch *dispatch,
 	device->base.config.rotation = &dispatch->rotation.config;
 }
 
+static int
+fallback_passthrough_config_is_available(struct libinput_device *device)
+{
+	/* This function only gets called when we support passthrough */
+	return 1;
+}
+
+static enum libinput_config_status
+fallback_passthrough_config_set_enabled(struct libinput_device *libinput_device,
+					enum libinput_config_passthrough_state enable)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct fallback_dispatch *dispatch = fallback_dispatch(device->dispatch);
+
+	dispatch->passthrough.want_enabled =
+		(enable == LIBINPUT_CONFIG_PASSTHROUGH_ENABLED);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_passthrough_state
+fallback_passthrough_config_get_enabled(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct fallback_dispatch *dispatch = fallback_dispatch(device->dispatch);
+
+	return dispatch->passthrough.want_enabled ?
+		LIBINPUT_CONFIG_PASSTHROUGH_ENABLED :
+		LIBINPUT_CONFIG_PASSTHROUGH_DISABLED;
+}
+
+static enum libinput_config_passthrough_state
+fallback_passthrough_config_get_default_enabled(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_PASSTHROUGH_DISABLED;
+}
+
+static void
+fallback_init_passthrough(struct fallback_dispatch *dispatch,
+			  struct evdev_device *device)
+{
+	/* Touch handling needs the full frame processing */
+	if (device->seat_caps & EVDEV_DEVICE_TOUCH)
+		return;
+
+	if ((device->seat_caps & (EVDEV_DEVICE_POINTER|EVDEV_DEVICE_KEYBOARD)) == 0)
+		return;
+
+	dispatch->passthrough.config.is_available = fallback_passthrough_config_is_available;
+	dispatch->passthrough.config.set_enabled = fallback_passthrough_config_set_enabled;
+	dispatch->passthrough.config.get_enabled = fallback_passthrough_config_get_enabled;
+	dispatch->passthrough.config.get_default_enabled = fallback_passthrough_config_get_default_enabled;
+	dispatch->passthrough.enabled = false;
+	dispatch->passthrough.want_enabled = false;
+	device->base.config.passthrough = &dispatch->passthrough.config;
+}
+
 static inline int
 fallback_dispatch_init_slots(struct fallback_dispatch *dispatch,
 			     struct evdev_device *device)
@@ -1705,6 +2114,7 @@ fallback_init_arbitration(struct fallback_dispatch *dispatch,
 			    timer_name,
 			    fallback_arbitration_timeout,
 			    dispatch);
+	libinput_timer_set_device(&dispatch->arbitration.arbitration_timer, &device->base);
 	dispatch->arbitration.in_arbitration = false;
 }
 
@@ -1717,7 +2127,10 @@ fallback_dispatch_create(struct libinput_device *libinput_device)
 	dispatch = zalloc(sizeof *dispatch);
 	dispatch->device = evdev_device(libinput_device);
 	dispatch->base.dispatch_type = DISPATCH_FALLBACK;
-	dispatch->base.interface = &fallback_interface;
+	dispatch->base.interface = fallback_select_interface(device);
+	evdev_log_debug(device,
+			"fallback: using the %s interface\n",
+			fallback_interface_name(dispatch->base.interface));
 	dispatch->pending_event = EVDEV_NONE;
 	list_init(&dispatch->lid.paired_keyboard_list);
 
@@ -1765,6 +2178,7 @@ fallback_dispatch_create(struct libinput_device *libinput_device)
 
 	fallback_init_debounce(dispatch);
 	fallback_init_arbitration(dispatch, device);
+	fallback_init_passthrough(dispatch, device);
 
 	return &dispatch->base;
 }
@@ -145,6 +145,13 @@ struct fallback_dispatch {
 		struct list paired_keyboard_list;
 	} lid;
 
+	/* raw passthrough, see fallback_passthrough_apply() */
+	struct {
+		bool enabled;
+		bool want_enabled;
+		struct libinput_device_config_passthrough config;
+	} passthrough;
+
 	/* pen/touch arbitration has a delayed state,
 	 * in_arbitration is what decides when to filter.
 	 */
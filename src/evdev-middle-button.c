@@ -711,6 +711,7 @@ evdev_init_middlebutton(struct evdev_device *device,
 			    timer_name,
 			    evdev_middlebutton_handle_timeout,
 			    device);
+	libinput_timer_set_device(&device->middlebutton.timer, &device->base);
 	device->middlebutton.enabled_default = enable;
 	device->middlebutton.want_enabled = enable;
 	device->middlebutton.enabled = enable;
@@ -1015,6 +1015,7 @@ tp_init_buttons(struct tp_dispatch *tp,
 				    tp_libinput_context(tp),
 				    timer_name,
 				    tp_button_handle_timeout, t);
+		libinput_timer_set_device(&t->button.timer, &device->base);
 	}
 }
 
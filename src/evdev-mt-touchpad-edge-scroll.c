@@ -346,6 +346,7 @@ tp_edge_scroll_init(struct tp_dispatch *tp, struct evdev_device *device)
 				    tp_libinput_context(tp),
 				    timer_name,
 				    tp_edge_scroll_handle_timeout, t);
+		libinput_timer_set_device(&t->scroll.timer, &device->base);
 	}
 }
 
@@ -32,6 +32,12 @@
 #define DEFAULT_GESTURE_SWIPE_TIMEOUT ms2us(150)
 #define DEFAULT_GESTURE_PINCH_TIMEOUT ms2us(150)
 
+/* Low-latency mode: commit once both touches moved this far (in mm) and
+ * one of common motion or change in spread dominates by this ratio */
+#define LOW_LATENCY_MIN_TOUCH_MOVE 0.5
+#define LOW_LATENCY_MIN_GESTURE_MOVE 1.0
+#define LOW_LATENCY_DOMINANCE_RATIO 2.0
+
 static inline const char*
 gesture_state_to_str(enum tp_gesture_state state)
 {
@@ -243,31 +249,62 @@ tp_gesture_get_direction(struct tp_dispatch *tp, struct tp_touch *touch)
 }
 
 static void
-tp_gesture_get_pinch_info(struct tp_dispatch *tp,
-			  double *distance,
-			  double *angle,
-			  struct device_float_coords *center)
+tp_gesture_get_pinch_info_for(struct tp_dispatch *tp,
+			      struct device_coords first,
+			      struct device_coords second,
+			      double *distance,
+			      double *angle,
+			      struct device_float_coords *center)
 {
 	struct normalized_coords normalized;
 	struct device_float_coords delta;
-	struct tp_touch *first = tp->gesture.touches[0],
-			*second = tp->gesture.touches[1];
 
-	delta = device_delta(first->point, second->point);
+	delta = device_delta(first, second);
 	normalized = tp_normalize_delta(tp, delta);
 	*distance = normalized_length(normalized);
 	*angle = atan2(normalized.y, normalized.x) * 180.0 / M_PI;
 
-	*center = device_average(first->point, second->point);
+	*center = device_average(first, second);
+}
+
+static inline void
+tp_gesture_get_pinch_info(struct tp_dispatch *tp,
+			  double *distance,
+			  double *angle,
+			  struct device_float_coords *center)
+{
+	struct tp_touch *first = tp->gesture.touches[0],
+			*second = tp->gesture.touches[1];
+
+	tp_gesture_get_pinch_info_for(tp,
+				      first->point,
+				      second->point,
+				      distance,
+				      angle,
+				      center);
 }
 
 static inline void
 tp_gesture_init_pinch(struct tp_dispatch *tp)
 {
-	tp_gesture_get_pinch_info(tp,
-				  &tp->gesture.initial_distance,
-				  &tp->gesture.angle,
-				  &tp->gesture.center);
+	struct tp_touch *first = tp->gesture.touches[0],
+			*second = tp->gesture.touches[1];
+
+	/* In low-latency mode, start from where the touches were when the
+	 * gesture started so the first update includes the motion made
+	 * while we were still undecided. */
+	if (tp->gesture.low_latency.enabled)
+		tp_gesture_get_pinch_info_for(tp,
+					      first->gesture.initial,
+					      second->gesture.initial,
+					      &tp->gesture.initial_distance,
+					      &tp->gesture.angle,
+					      &tp->gesture.center);
+	else
+		tp_gesture_get_pinch_info(tp,
+					  &tp->gesture.initial_distance,
+					  &tp->gesture.angle,
+					  &tp->gesture.center);
 	tp->gesture.prev_scale = 1.0;
 }
 
@@ -546,6 +583,59 @@ tp_gesture_detect_motion_gestures(struct tp_dispatch *tp, uint64_t time)
 	return GESTURE_STATE_PINCH;
 }
 
+/**
+ * Classify the gesture from the motion vectors of the two tracked
+ * touches: if both moved in the same direction, the common motion
+ * dominates and it's a scroll or swipe. If they moved apart or towards
+ * each other, the change in spread dominates and it's a pinch.
+ *
+ * This needs less motion than tp_gesture_detect_motion_gestures() but
+ * gives up on anything it can't decide clearly, e.g. a resting thumb.
+ */
+static enum tp_gesture_state
+tp_gesture_detect_motion_gestures_low_latency(struct tp_dispatch *tp)
+{
+	struct tp_touch *first = tp->gesture.touches[0],
+			*second = tp->gesture.touches[1];
+	struct device_float_coords d0, d1;
+	struct phys_coords mm0, mm1, common, spread;
+	double common_mm, spread_mm;
+
+	d0 = device_delta(first->point, first->gesture.initial);
+	d1 = device_delta(second->point, second->gesture.initial);
+	mm0 = tp_phys_delta(tp, d0);
+	mm1 = tp_phys_delta(tp, d1);
+
+	if (hypot(mm0.x, mm0.y) < LOW_LATENCY_MIN_TOUCH_MOVE ||
+	    hypot(mm1.x, mm1.y) < LOW_LATENCY_MIN_TOUCH_MOVE)
+		return GESTURE_STATE_UNKNOWN;
+
+	common.x = (mm0.x + mm1.x)/2.0;
+	common.y = (mm0.y + mm1.y)/2.0;
+	spread.x = (mm0.x - mm1.x)/2.0;
+	spread.y = (mm0.y - mm1.y)/2.0;
+	common_mm = hypot(common.x, common.y);
+	spread_mm = hypot(spread.x, spread.y);
+
+	if (common_mm >= LOW_LATENCY_MIN_GESTURE_MOVE &&
+	    common_mm >= spread_mm * LOW_LATENCY_DOMINANCE_RATIO) {
+		if (tp->gesture.finger_count == 2) {
+			tp_gesture_set_scroll_buildup(tp);
+			return GESTURE_STATE_SCROLL;
+		}
+		return GESTURE_STATE_SWIPE;
+	}
+
+	if (tp->gesture.finger_count <= tp->num_slots &&
+	    spread_mm >= LOW_LATENCY_MIN_GESTURE_MOVE &&
+	    spread_mm >= common_mm * LOW_LATENCY_DOMINANCE_RATIO) {
+		tp_gesture_init_pinch(tp);
+		return GESTURE_STATE_PINCH;
+	}
+
+	return GESTURE_STATE_UNKNOWN;
+}
+
 static enum tp_gesture_state
 tp_gesture_handle_state_none(struct tp_dispatch *tp, uint64_t time)
 {
@@ -604,6 +694,8 @@ tp_gesture_handle_state_none(struct tp_dispatch *tp, uint64_t time)
 	second->gesture.initial = second->point;
 	tp->gesture.touches[0] = first;
 	tp->gesture.touches[1] = second;
+	tp->gesture.low_latency.held_back.x = 0.0;
+	tp->gesture.low_latency.held_back.y = 0.0;
 
 	return GESTURE_STATE_UNKNOWN;
 }
@@ -612,6 +704,19 @@ tp_gesture_handle_state_none(struct tp_dispatch *tp, uint64_t time)
 static enum tp_gesture_state
 tp_gesture_handle_state_unknown(struct tp_dispatch *tp, uint64_t time)
 {
+	if (tp->gesture.low_latency.enabled && tp->gesture.enabled) {
+		struct device_float_coords delta;
+		enum tp_gesture_state state;
+
+		delta = tp_get_average_touches_delta(tp);
+		tp->gesture.low_latency.held_back.x += delta.x;
+		tp->gesture.low_latency.held_back.y += delta.y;
+
+		state = tp_gesture_detect_motion_gestures_low_latency(tp);
+		if (state != GESTURE_STATE_UNKNOWN)
+			return state;
+	}
+
 	return tp_gesture_detect_motion_gestures(tp, time);
 }
 
@@ -651,6 +756,26 @@ tp_gesture_handle_state_swipe(struct tp_dispatch *tp, uint64_t time)
 	raw = tp_get_average_touches_delta(tp);
 	delta = tp_filter_motion(tp, &raw, time);
 
+	/* The motion held back while the gesture type was unknown goes
+	 * into the first update. It is not accelerated, the accel filter
+	 * would see it as one very fast motion. */
+	if (!tp->gesture.started &&
+	    tp->gesture.low_latency.enabled && tp->gesture.enabled) {
+		struct device_float_coords held_back;
+		struct normalized_coords held_back_delta;
+
+		held_back = device_float_delta(tp->gesture.low_latency.held_back,
+					       raw);
+		held_back_delta = tp_filter_motion_unaccelerated(tp,
+								 &held_back,
+								 time);
+		delta.x += held_back_delta.x;
+		delta.y += held_back_delta.y;
+		raw = tp->gesture.low_latency.held_back;
+		tp->gesture.low_latency.held_back.x = 0.0;
+		tp->gesture.low_latency.held_back.y = 0.0;
+	}
+
 	if (!normalized_is_zero(delta) || !device_float_is_zero(raw)) {
 		unaccel = tp_filter_motion_unaccelerated(tp, &raw, time);
 		tp_gesture_start(tp, time);
@@ -878,6 +1003,46 @@ tp_gesture_handle_state(struct tp_dispatch *tp, uint64_t time)
 	}
 }
 
+static int
+tp_gesture_low_latency_config_is_available(struct libinput_device *device)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	/* semi-mt and single-slot touchpads never detect gestures */
+	return tp->gesture.enabled;
+}
+
+static enum libinput_config_status
+tp_gesture_low_latency_config_set(struct libinput_device *device,
+				  enum libinput_config_gesture_low_latency_state enable)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	tp->gesture.low_latency.enabled =
+		(enable == LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_gesture_low_latency_state
+tp_gesture_low_latency_config_get(struct libinput_device *device)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	return tp->gesture.low_latency.enabled ?
+		LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED :
+		LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED;
+}
+
+static enum libinput_config_gesture_low_latency_state
+tp_gesture_low_latency_config_get_default(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED;
+}
+
 void
 tp_init_gesture(struct tp_dispatch *tp)
 {
@@ -890,6 +1055,13 @@ tp_init_gesture(struct tp_dispatch *tp)
 
 	tp->gesture.state = GESTURE_STATE_NONE;
 
+	tp->gesture.low_latency.config.is_available = tp_gesture_low_latency_config_is_available;
+	tp->gesture.low_latency.config.set_enabled = tp_gesture_low_latency_config_set;
+	tp->gesture.low_latency.config.get_enabled = tp_gesture_low_latency_config_get;
+	tp->gesture.low_latency.config.get_default_enabled = tp_gesture_low_latency_config_get_default;
+	tp->gesture.low_latency.enabled = false;
+	tp->device->base.config.gesture_low_latency = &tp->gesture.low_latency.config;
+
 	snprintf(timer_name,
 		 sizeof(timer_name),
 		 "%s gestures",
@@ -898,6 +1070,7 @@ tp_init_gesture(struct tp_dispatch *tp)
 			    tp_libinput_context(tp),
 			    timer_name,
 			    tp_gesture_finger_count_switch_timeout, tp);
+	libinput_timer_set_device(&tp->gesture.finger_count_switch_timer, &tp->device->base);
 }
 
 void
@@ -26,6 +26,8 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "evdev-mt-touchpad.h"
 
@@ -35,6 +37,14 @@
 #define DEFAULT_DRAGLOCK_TIMEOUT_PERIOD ms2us(300)
 #define DEFAULT_TAP_MOVE_THRESHOLD 1.3 /* mm */
 
+/* Adaptive drag timeout: wait for the 95th percentile of the user's
+ * tap-to-second-touch interval plus some slack, but never longer than
+ * the default */
+#define ADAPTIVE_DRAG_TIMEOUT_MIN_SAMPLES 8
+#define ADAPTIVE_DRAG_TIMEOUT_PERCENTILE 95
+#define ADAPTIVE_DRAG_TIMEOUT_SLACK ms2us(20)
+#define ADAPTIVE_DRAG_TIMEOUT_MIN ms2us(80)
+
 enum tap_event {
 	TAP_EVENT_TOUCH = 12,
 	TAP_EVENT_MOTION,
@@ -149,9 +159,118 @@ tp_tap_notify(struct tp_dispatch *tp,
 				    state);
 }
 
+static int
+tp_tap_cmp_interval(const void *a, const void *b)
+{
+	uint64_t ia = *(const uint64_t *)a,
+		 ib = *(const uint64_t *)b;
+
+	return ia < ib ? -1 : ia > ib;
+}
+
+static void
+tp_tap_adaptive_update_timeout(struct tp_dispatch *tp)
+{
+	uint64_t sorted[TOUCHPAD_TAP_INTERVALS];
+	unsigned int n = tp->tap.adaptive.nintervals;
+	unsigned int idx;
+	uint64_t timeout;
+
+	if (n < ADAPTIVE_DRAG_TIMEOUT_MIN_SAMPLES) {
+		tp->tap.adaptive.drag_timeout = DEFAULT_DRAG_TIMEOUT_PERIOD_BASE;
+		return;
+	}
+
+	memcpy(sorted, tp->tap.adaptive.intervals, n * sizeof(*sorted));
+	qsort(sorted, n, sizeof(*sorted), tp_tap_cmp_interval);
+
+	idx = (n * ADAPTIVE_DRAG_TIMEOUT_PERCENTILE + 99)/100 - 1;
+	timeout = sorted[idx] + ADAPTIVE_DRAG_TIMEOUT_SLACK;
+	timeout = max(timeout, ADAPTIVE_DRAG_TIMEOUT_MIN);
+	timeout = min(timeout, DEFAULT_DRAG_TIMEOUT_PERIOD_BASE);
+
+	if (timeout != tp->tap.adaptive.drag_timeout)
+		evdev_log_debug(tp->device,
+				"tap: adaptive drag timeout %ums\n",
+				us2ms(timeout));
+	tp->tap.adaptive.drag_timeout = timeout;
+}
+
+/* Record the time between a tap and the next touch. This is what the
+ * drag timeout must cover for a double-tap or tap-and-drag to work. */
+static void
+tp_tap_adaptive_add_interval(struct tp_dispatch *tp,
+			     uint64_t release_time,
+			     uint64_t time,
+			     int nfingers_tapped)
+{
+	uint64_t perfinger = nfingers_tapped *
+			     DEFAULT_DRAG_TIMEOUT_PERIOD_PERFINGER;
+	uint64_t interval;
+	unsigned int idx;
+
+	if (!tp->tap.adaptive.enabled || time < release_time)
+		return;
+
+	interval = time - release_time;
+	interval = interval > perfinger ? interval - perfinger : 0;
+
+	idx = tp->tap.adaptive.index;
+	tp->tap.adaptive.intervals[idx] = interval;
+	tp->tap.adaptive.index = (idx + 1) % TOUCHPAD_TAP_INTERVALS;
+	tp->tap.adaptive.nintervals = min(tp->tap.adaptive.nintervals + 1,
+					  TOUCHPAD_TAP_INTERVALS);
+
+	tp_tap_adaptive_update_timeout(tp);
+}
+
+/* A tap was committed because the drag timeout expired */
+static void
+tp_tap_adaptive_tap_committed(struct tp_dispatch *tp,
+			      int nfingers_tapped)
+{
+	tp->tap.adaptive.ntaps++;
+
+	if (tp->tap.adaptive.timer_period == 0)
+		return;
+
+	tp->tap.adaptive.saved += tp->tap.adaptive.timer_default_period -
+				  tp->tap.adaptive.timer_period;
+
+	/* If the next touch comes in before the default timeout would
+	 * have expired, we split a double-tap into two taps. Count it
+	 * and learn from it so the timeout grows again. */
+	if (tp->tap.adaptive.enabled &&
+	    tp->tap.adaptive.timer_period < tp->tap.adaptive.timer_default_period) {
+		tp->tap.adaptive.split_pending = true;
+		tp->tap.adaptive.split_release_time = tp->tap.saved_release_time;
+		tp->tap.adaptive.split_nfingers = nfingers_tapped;
+	}
+}
+
+static void
+tp_tap_adaptive_check_split(struct tp_dispatch *tp, uint64_t time)
+{
+	uint64_t release_time = tp->tap.adaptive.split_release_time;
+	int nfingers = tp->tap.adaptive.split_nfingers;
+
+	if (!tp->tap.adaptive.split_pending)
+		return;
+
+	tp->tap.adaptive.split_pending = false;
+
+	if (time - release_time >= DEFAULT_DRAG_TIMEOUT_PERIOD_BASE +
+				   nfingers * DEFAULT_DRAG_TIMEOUT_PERIOD_PERFINGER)
+		return;
+
+	tp->tap.adaptive.nsplit++;
+	tp_tap_adaptive_add_interval(tp, release_time, time, nfingers);
+}
+
 static void
 tp_tap_set_timer(struct tp_dispatch *tp, uint64_t time)
 {
+	tp->tap.adaptive.timer_period = 0;
 	libinput_timer_set(&tp->tap.timer, time + DEFAULT_TAP_TIMEOUT_PERIOD);
 }
 
@@ -159,10 +278,19 @@ static void
 tp_tap_set_drag_timer(struct tp_dispatch *tp, uint64_t time,
 		      int nfingers_tapped)
 {
+	uint64_t perfinger = nfingers_tapped *
+			     DEFAULT_DRAG_TIMEOUT_PERIOD_PERFINGER;
+	uint64_t base = DEFAULT_DRAG_TIMEOUT_PERIOD_BASE;
+
+	if (tp->tap.adaptive.enabled)
+		base = tp->tap.adaptive.drag_timeout;
+
+	tp->tap.adaptive.timer_period = base + perfinger;
+	tp->tap.adaptive.timer_default_period =
+		DEFAULT_DRAG_TIMEOUT_PERIOD_BASE + perfinger;
+
 	libinput_timer_set(&tp->tap.timer,
-			   time + DEFAULT_DRAG_TIMEOUT_PERIOD_BASE +
-			   (nfingers_tapped *
-			    DEFAULT_DRAG_TIMEOUT_PERIOD_PERFINGER));
+			   time + tp->tap.adaptive.timer_period);
 }
 
 static void
@@ -193,6 +321,7 @@ tp_tap_idle_handle_event(struct tp_dispatch *tp,
 {
 	switch (event) {
 	case TAP_EVENT_TOUCH:
+		tp_tap_adaptive_check_split(tp, time);
 		tp->tap.state = TAP_STATE_TOUCH;
 		tp->tap.saved_press_time = time;
 		tp_tap_set_timer(tp, time);
@@ -328,6 +457,11 @@ tp_tap_tapped_handle_event(struct tp_dispatch *tp,
 			TAP_STATE_3FGTAP_DRAGGING_OR_DOUBLETAP,
 		};
 		assert(nfingers_tapped >= 1 && nfingers_tapped <= 3);
+		if (tp->tap.adaptive.timer_period != 0)
+			tp_tap_adaptive_add_interval(tp,
+						     tp->tap.saved_release_time,
+						     time,
+						     nfingers_tapped);
 		tp->tap.state = dest[nfingers_tapped - 1];
 		tp->tap.saved_press_time = time;
 		tp_tap_set_timer(tp, time);
@@ -335,6 +469,7 @@ tp_tap_tapped_handle_event(struct tp_dispatch *tp,
 	}
 	case TAP_EVENT_TIMEOUT:
 		tp->tap.state = TAP_STATE_IDLE;
+		tp_tap_adaptive_tap_committed(tp, nfingers_tapped);
 		tp_tap_notify(tp,
 			      tp->tap.saved_release_time,
 			      nfingers_tapped,
@@ -1550,6 +1685,58 @@ tp_tap_config_get_default_draglock_enabled(struct libinput_device *device)
 	return tp_drag_lock_default(evdev);
 }
 
+static enum libinput_config_status
+tp_tap_config_set_adaptive_timeout_enabled(struct libinput_device *device,
+					   enum libinput_config_tap_adaptive_timeout_state enabled)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	tp->tap.adaptive.enabled = enabled;
+	tp->tap.adaptive.split_pending = false;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_tap_adaptive_timeout_state
+tp_tap_config_get_adaptive_timeout_enabled(struct libinput_device *device)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+
+	return tp->tap.adaptive.enabled;
+}
+
+static enum libinput_config_tap_adaptive_timeout_state
+tp_tap_config_get_default_adaptive_timeout_enabled(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED;
+}
+
+static void
+tp_tap_config_get_timeout_stats(struct libinput_device *device,
+				uint64_t *timeout_usec,
+				uint64_t *ntaps,
+				uint64_t *saved_usec,
+				uint64_t *nsplit)
+{
+	struct evdev_dispatch *dispatch = evdev_device(device)->dispatch;
+	struct tp_dispatch *tp = tp_dispatch(dispatch);
+	uint64_t timeout = DEFAULT_DRAG_TIMEOUT_PERIOD_BASE;
+
+	if (tp->tap.adaptive.enabled)
+		timeout = tp->tap.adaptive.drag_timeout;
+
+	if (timeout_usec)
+		*timeout_usec = timeout + DEFAULT_DRAG_TIMEOUT_PERIOD_PERFINGER;
+	if (ntaps)
+		*ntaps = tp->tap.adaptive.ntaps;
+	if (saved_usec)
+		*saved_usec = tp->tap.adaptive.saved;
+	if (nsplit)
+		*nsplit = tp->tap.adaptive.nsplit;
+}
+
 void
 tp_init_tap(struct tp_dispatch *tp)
 {
@@ -1568,6 +1755,10 @@ tp_init_tap(struct tp_dispatch *tp)
 	tp->tap.config.set_draglock_enabled = tp_tap_config_set_draglock_enabled;
 	tp->tap.config.get_draglock_enabled = tp_tap_config_get_draglock_enabled;
 	tp->tap.config.get_default_draglock_enabled = tp_tap_config_get_default_draglock_enabled;
+	tp->tap.config.set_adaptive_timeout_enabled = tp_tap_config_set_adaptive_timeout_enabled;
+	tp->tap.config.get_adaptive_timeout_enabled = tp_tap_config_get_adaptive_timeout_enabled;
+	tp->tap.config.get_default_adaptive_timeout_enabled = tp_tap_config_get_default_adaptive_timeout_enabled;
+	tp->tap.config.get_timeout_stats = tp_tap_config_get_timeout_stats;
 	tp->device->base.config.tap = &tp->tap.config;
 
 	tp->tap.state = TAP_STATE_IDLE;
@@ -1576,6 +1767,8 @@ tp_init_tap(struct tp_dispatch *tp)
 	tp->tap.want_map = tp->tap.map;
 	tp->tap.drag_enabled = tp_drag_default(tp->device);
 	tp->tap.drag_lock_enabled = tp_drag_lock_default(tp->device);
+	tp->tap.adaptive.enabled = false;
+	tp->tap.adaptive.drag_timeout = DEFAULT_DRAG_TIMEOUT_PERIOD_BASE;
 
 	snprintf(timer_name,
 		 sizeof(timer_name),
@@ -1585,6 +1778,7 @@ tp_init_tap(struct tp_dispatch *tp)
 			    tp_libinput_context(tp),
 			    timer_name,
 			    tp_tap_handle_timeout, tp);
+	libinput_timer_set_device(&tp->tap.timer, &tp->device->base);
 }
 
 void
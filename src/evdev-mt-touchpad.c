@@ -39,6 +39,7 @@
 #define DEFAULT_TRACKPOINT_EVENT_TIMEOUT ms2us(40)
 #define DEFAULT_KEYBOARD_ACTIVITY_TIMEOUT_1 ms2us(200)
 #define DEFAULT_KEYBOARD_ACTIVITY_TIMEOUT_2 ms2us(500)
+#define DEFAULT_ACTIVITY_TIMER_SLACK ms2us(10)
 #define FAKE_FINGER_OVERFLOW (1 << 7)
 #define THUMB_IGNORE_SPEED_THRESHOLD 20 /* mm/s */
 
@@ -71,8 +72,7 @@ tp_filter_motion(struct tp_dispatch *tp,
 	/* Convert to device units with x/y in the same resolution */
 	raw = tp_scale_to_xaxis(tp, *unaccelerated);
 
-	return filter_dispatch(tp->device->pointer.filter,
-			       &raw, tp, time);
+	return evdev_filter_dispatch(tp->device, &raw, tp, time);
 }
 
 struct normalized_coords
@@ -1714,6 +1714,7 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 	bool want_motion_reset;
 	bool have_new_touch = false;
 	unsigned int speed_exceeded_count = 0;
+	struct evdev_stage_timer stage;
 
 	tp_position_fake_touches(tp);
 
@@ -1757,8 +1758,14 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 			tp_motion_history_reset(t);
 		}
 
+		stage = evdev_stage_begin(tp->device);
 		tp_thumb_update_touch(tp, t, time);
+		evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_THUMB, stage);
+
+		stage = evdev_stage_begin(tp->device);
 		tp_palm_detect(tp, t, time);
+		evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_PALM, stage);
+
 		tp_detect_wobbling(tp, t, time);
 		tp_motion_hysteresis(tp, t);
 		tp_motion_history_push(t, time);
@@ -1797,14 +1804,22 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 
 	if (tp->thumb.detect_thumbs &&
 	    have_new_touch &&
-	    tp->nfingers_down >= 2)
+	    tp->nfingers_down >= 2) {
+		stage = evdev_stage_begin(tp->device);
 		tp_thumb_update_multifinger(tp);
+		evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_THUMB, stage);
+	}
 
 	if (restart_filter)
 		filter_restart(tp->device->pointer.filter, tp, time);
 
+	stage = evdev_stage_begin(tp->device);
 	tp_button_handle_state(tp, time);
+	evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_BUTTONS, stage);
+
+	stage = evdev_stage_begin(tp->device);
 	tp_edge_scroll_handle_state(tp, time);
+	evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_EDGE_SCROLL, stage);
 
 	/*
 	 * We have a physical button down event on a clickpad. To avoid
@@ -1816,7 +1831,9 @@ tp_process_state(struct tp_dispatch *tp, uint64_t time)
 	    tp->buttons.is_clickpad)
 		tp_pin_fingers(tp);
 
+	stage = evdev_stage_begin(tp->device);
 	tp_gesture_handle_state(tp, time);
+	evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_GESTURE, stage);
 }
 
 static void
@@ -1856,6 +1873,7 @@ static void
 tp_post_events(struct tp_dispatch *tp, uint64_t time)
 {
 	bool ignore_motion = false;
+	struct evdev_stage_timer stage;
 
 	/* Only post (top) button events while suspended */
 	if (tp->device->is_suspended) {
@@ -1863,7 +1881,9 @@ tp_post_events(struct tp_dispatch *tp, uint64_t time)
 		return;
 	}
 
+	stage = evdev_stage_begin(tp->device);
 	ignore_motion |= tp_tap_handle_state(tp, time);
+	evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_TAP, stage);
 	ignore_motion |= tp_post_button_events(tp, time);
 
 	if (ignore_motion ||
@@ -1877,7 +1897,9 @@ tp_post_events(struct tp_dispatch *tp, uint64_t time)
 	if (tp_edge_scroll_post_events(tp, time) != 0)
 		return;
 
+	stage = evdev_stage_begin(tp->device);
 	tp_gesture_post_events(tp, time);
+	evdev_stage_end(tp->device, LIBINPUT_STAGE_TP_GESTURE, stage);
 }
 
 static void
@@ -1902,9 +1924,21 @@ static void
 tp_handle_state(struct tp_dispatch *tp,
 		uint64_t time)
 {
+	struct evdev_device *device = tp->device;
+	struct evdev_stage_timer stage;
+
+	stage = evdev_stage_begin(device);
 	tp_pre_process_state(tp, time);
+	evdev_stage_end(device, LIBINPUT_STAGE_TP_PRE_PROCESS_STATE, stage);
+
+	stage = evdev_stage_begin(device);
 	tp_process_state(tp, time);
+	evdev_stage_end(device, LIBINPUT_STAGE_TP_PROCESS_STATE, stage);
+
+	stage = evdev_stage_begin(device);
 	tp_post_events(tp, time);
+	evdev_stage_end(device, LIBINPUT_STAGE_TP_POST_EVENTS, stage);
+
 	tp_post_process_state(tp, time);
 
 	tp_clickpad_middlebutton_apply_config(tp->device);
@@ -2587,6 +2621,24 @@ tp_pair_tablet(struct evdev_device *touchpad,
 	}
 }
 
+static uint32_t
+tp_interface_pairs_with(struct evdev_device *device)
+{
+	struct tp_dispatch *tp = tp_dispatch(device->dispatch);
+	uint32_t classes = EVDEV_PAIR_KEYBOARD |
+			   EVDEV_PAIR_TRACKPOINT |
+			   EVDEV_PAIR_EXTERNAL_MOUSE;
+
+	if ((device->tags & EVDEV_TAG_EXTERNAL_TOUCHPAD) == 0)
+		classes |= EVDEV_PAIR_LID_SWITCH |
+			   EVDEV_PAIR_TABLET_MODE_SWITCH;
+
+	if (tp->left_handed.must_rotate)
+		classes |= EVDEV_PAIR_TABLET;
+
+	return classes;
+}
+
 static void
 tp_interface_device_added(struct evdev_device *device,
 			  struct evdev_device *added_device)
@@ -2649,18 +2701,9 @@ tp_interface_device_removed(struct evdev_device *device,
 
 	if (tp->sendevents.current_mode ==
 		    LIBINPUT_CONFIG_SEND_EVENTS_DISABLED_ON_EXTERNAL_MOUSE) {
-		struct libinput_device *dev;
-		bool found = false;
-
-		list_for_each(dev, &device->base.seat->devices_list, link) {
-			struct evdev_device *d = evdev_device(dev);
-			if (d != removed_device &&
-			    (d->tags & EVDEV_TAG_EXTERNAL_MOUSE)) {
-				found = true;
-				break;
-			}
-		}
-		if (!found)
+		if (!evdev_pair_class_find(device->base.seat,
+					   EVDEV_PAIR_EXTERNAL_MOUSE,
+					   removed_device))
 			tp_resume(tp, device, SUSPEND_EXTERNAL_MOUSE);
 	}
 
@@ -2832,6 +2875,7 @@ static struct evdev_dispatch_interface tp_interface = {
 	.suspend = tp_interface_suspend,
 	.remove = tp_interface_remove,
 	.destroy = tp_interface_destroy,
+	.pairs_with = tp_interface_pairs_with,
 	.device_added = tp_interface_device_added,
 	.device_removed = tp_interface_device_removed,
 	.device_suspended = tp_interface_device_removed, /* treat as remove */
@@ -3198,14 +3242,13 @@ tp_dwt_config_get_default(struct libinput_device *device)
 static inline bool
 tp_is_tpkb_combo_below(struct evdev_device *device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	char *prop;
 	enum tpkbcombo_layout layout = TPKBCOMBO_LAYOUT_UNKNOWN;
 	int rc = false;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q)
 		return false;
 
@@ -3283,11 +3326,10 @@ tp_read_palm_pressure_prop(struct tp_dispatch *tp,
 {
 	const int default_palm_threshold = 130;
 	uint32_t threshold = default_palm_threshold;
-	struct quirks_context *quirks;
 	struct quirks *q;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q)
 		return threshold;
 
@@ -3318,12 +3360,11 @@ static inline void
 tp_init_palmdetect_size(struct tp_dispatch *tp,
 			struct evdev_device *device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	uint32_t threshold;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q)
 		return;
 
@@ -3354,6 +3395,7 @@ tp_init_palmdetect_arbitration(struct tp_dispatch *tp,
 			    tp_libinput_context(tp),
 			    timer_name,
 			    tp_arbitration_timeout, tp);
+	libinput_timer_set_device(&tp->arbitration.arbitration_timer, &device->base);
 	tp->arbitration.state = ARBITRATION_NOT_ACTIVE;
 }
 
@@ -3401,6 +3443,9 @@ tp_init_sendevents(struct tp_dispatch *tp,
 			    tp_libinput_context(tp),
 			    timer_name,
 			    tp_trackpoint_timeout, tp);
+	libinput_timer_set_device(&tp->palm.trackpoint_timer, &device->base);
+	libinput_timer_set_slack(&tp->palm.trackpoint_timer,
+				 DEFAULT_ACTIVITY_TIMER_SLACK);
 
 	snprintf(timer_name,
 		 sizeof(timer_name),
@@ -3410,6 +3455,9 @@ tp_init_sendevents(struct tp_dispatch *tp,
 			    tp_libinput_context(tp),
 			    timer_name,
 			    tp_keyboard_timeout, tp);
+	libinput_timer_set_device(&tp->dwt.keyboard_timer, &device->base);
+	libinput_timer_set_slack(&tp->dwt.keyboard_timer,
+				 DEFAULT_ACTIVITY_TIMER_SLACK);
 }
 
 static bool
@@ -3502,7 +3550,6 @@ tp_init_pressure(struct tp_dispatch *tp,
 {
 	const struct input_absinfo *abs;
 	unsigned int code;
-	struct quirks_context *quirks;
 	struct quirks *q;
 	struct quirk_range r;
 	int hi, lo;
@@ -3516,8 +3563,8 @@ tp_init_pressure(struct tp_dispatch *tp,
 	abs = libevdev_get_abs_info(device->evdev, code);
 	assert(abs);
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (q && quirks_get_range(q, QUIRK_ATTR_PRESSURE_RANGE, &r)) {
 		hi = r.upper;
 		lo = r.lower;
@@ -3560,7 +3607,6 @@ static bool
 tp_init_touch_size(struct tp_dispatch *tp,
 		   struct evdev_device *device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	struct quirk_range r;
 	int lo, hi;
@@ -3572,8 +3618,8 @@ tp_init_touch_size(struct tp_dispatch *tp,
 		return false;
 	}
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (q && quirks_get_range(q, QUIRK_ATTR_TOUCH_SIZE_RANGE, &r)) {
 		hi = r.upper;
 		lo = r.lower;
@@ -3707,15 +3753,10 @@ static void
 tp_suspend_conditional(struct tp_dispatch *tp,
 		       struct evdev_device *device)
 {
-	struct libinput_device *dev;
-
-	list_for_each(dev, &device->base.seat->devices_list, link) {
-		struct evdev_device *d = evdev_device(dev);
-		if (d->tags & EVDEV_TAG_EXTERNAL_MOUSE) {
-			tp_suspend(tp, device, SUSPEND_EXTERNAL_MOUSE);
-			break;
-		}
-	}
+	if (evdev_pair_class_find(device->base.seat,
+				  EVDEV_PAIR_EXTERNAL_MOUSE,
+				  NULL))
+		tp_suspend(tp, device, SUSPEND_EXTERNAL_MOUSE);
 }
 
 static enum libinput_config_status
@@ -31,6 +31,7 @@
 
 #define TOUCHPAD_HISTORY_LENGTH 4
 #define TOUCHPAD_MIN_SAMPLES 4
+#define TOUCHPAD_TAP_INTERVALS 32
 
 /* Convert mm to a distance normalized to DEFAULT_MOUSE_DPI */
 #define TP_MM_TO_DPI_NORMALIZED(mm) (DEFAULT_MOUSE_DPI/25.4 * mm)
@@ -357,6 +358,14 @@ struct tp_dispatch {
 		double prev_scale;
 		double angle;
 		struct device_float_coords center;
+
+		/* see libinput_device_config_gesture_low_latency_set_enabled() */
+		struct {
+			struct libinput_device_config_gesture_low_latency config;
+			bool enabled;
+			/* average touch motion while in GESTURE_STATE_UNKNOWN */
+			struct device_float_coords held_back;
+		} low_latency;
 	} gesture;
 
 	struct {
@@ -429,6 +438,30 @@ struct tp_dispatch {
 		bool drag_lock_enabled;
 
 		unsigned int nfingers_down;	/* number of fingers down for tapping (excl. thumb/palm) */
+
+		/* see libinput_device_config_tap_set_adaptive_timeout_enabled() */
+		struct {
+			bool enabled;
+			/* tap-to-second-touch intervals, excl. the per-finger
+			 * part of the drag timeout */
+			uint64_t intervals[TOUCHPAD_TAP_INTERVALS];
+			unsigned int nintervals;
+			unsigned int index;
+			uint64_t drag_timeout;
+
+			/* the drag timer currently running */
+			uint64_t timer_period;
+			uint64_t timer_default_period;
+
+			/* last tap committed by the drag timeout */
+			bool split_pending;
+			uint64_t split_release_time;
+			int split_nfingers;
+
+			uint64_t ntaps;
+			uint64_t saved;
+			uint64_t nsplit;
+		} adaptive;
 	} tap;
 
 	struct {
@@ -535,6 +535,7 @@ static struct evdev_dispatch_interface pad_interface = {
 	.suspend = pad_suspend,
 	.remove = NULL,
 	.destroy = pad_destroy,
+	.pairs_with = NULL,
 	.device_added = NULL,
 	.device_removed = NULL,
 	.device_suspended = NULL,
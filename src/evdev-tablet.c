@@ -96,6 +96,7 @@ static inline void
 tablet_history_reset(struct tablet_dispatch *tablet)
 {
 	tablet->history.count = 0;
+	tablet->smoothing.initialized = false;
 }
 
 static inline void
@@ -492,7 +493,7 @@ tablet_update_xy(struct tablet_dispatch *tablet,
 static inline struct normalized_coords
 tablet_tool_process_delta(struct tablet_dispatch *tablet,
 			  struct libinput_tablet_tool *tool,
-			  const struct evdev_device *device,
+			  struct evdev_device *device,
 			  struct tablet_axes *axes,
 			  uint64_t time)
 {
@@ -525,10 +526,7 @@ tablet_tool_process_delta(struct tablet_dispatch *tablet,
 	if (device_float_is_zero(accel))
 		return zero;
 
-	return filter_dispatch(device->pointer.filter,
-			       &accel,
-			       tool,
-			       time);
+	return evdev_filter_dispatch(device, &accel, tool, time);
 }
 
 static inline void
@@ -669,8 +667,8 @@ tablet_update_wheel(struct tablet_dispatch *tablet,
 }
 
 static void
-tablet_smoothen_axes(const struct tablet_dispatch *tablet,
-		     struct tablet_axes *axes)
+tablet_smoothen_axes_average(const struct tablet_dispatch *tablet,
+			     struct tablet_axes *axes)
 {
 	size_t i;
 	size_t count = tablet_history_size(tablet);
@@ -693,6 +691,119 @@ tablet_smoothen_axes(const struct tablet_dispatch *tablet,
 	axes->tilt.y = smooth.tilt.y/count;
 }
 
+/* Cutoff frequency for the velocity estimate, in Hz */
+#define TABLET_SMOOTHING_VELOCITY_CUTOFF 1.0
+
+static inline double
+tablet_smoothing_alpha(double cutoff, double dt)
+{
+	double tau = 1.0/(2 * M_PI * cutoff);
+
+	return 1.0/(1.0 + tau/dt);
+}
+
+/**
+ * A low-pass filter whose cutoff frequency rises with the axis velocity
+ * (the "1€ filter", Casiez et al. 2012). scale converts the axis units
+ * into mm or degrees so the same parameters work on all tablets.
+ */
+static double
+tablet_smoothing_filter(struct tablet_smoothing_filter *filter,
+			double value,
+			double scale,
+			double dt,
+			double min_cutoff,
+			double beta)
+{
+	double velocity = (value - filter->value)/dt;
+	double cutoff;
+	double a;
+
+	a = tablet_smoothing_alpha(TABLET_SMOOTHING_VELOCITY_CUTOFF, dt);
+	filter->velocity = a * velocity + (1 - a) * filter->velocity;
+
+	cutoff = min_cutoff + beta * fabs(filter->velocity)/scale;
+	a = tablet_smoothing_alpha(cutoff, dt);
+	filter->value = a * value + (1 - a) * filter->value;
+
+	return filter->value;
+}
+
+static inline void
+tablet_smoothing_filter_init(struct tablet_smoothing_filter *filter,
+			     double value)
+{
+	filter->value = value;
+	filter->velocity = 0.0;
+}
+
+static void
+tablet_smoothen_axes_adaptive(struct tablet_dispatch *tablet,
+			      struct tablet_axes *axes,
+			      uint64_t time)
+{
+	const struct input_absinfo *x = tablet->device->abs.absinfo_x,
+				   *y = tablet->device->abs.absinfo_y;
+	double r = tablet->smoothing.responsiveness;
+	/* At 0 responsiveness a still tool is filtered at 0.5Hz and the
+	 * cutoff rises by 1Hz per 100mm/s, at 1 responsiveness a still tool
+	 * is filtered at 5Hz and the cutoff rises by 1Hz per 5mm/s.
+	 */
+	double min_cutoff = 0.5 + 4.5 * r;
+	double beta = 0.01 + 0.19 * r;
+	double dt;
+
+	if (!tablet->smoothing.initialized) {
+		tablet_smoothing_filter_init(&tablet->smoothing.x, axes->point.x);
+		tablet_smoothing_filter_init(&tablet->smoothing.y, axes->point.y);
+		tablet_smoothing_filter_init(&tablet->smoothing.tilt_x, axes->tilt.x);
+		tablet_smoothing_filter_init(&tablet->smoothing.tilt_y, axes->tilt.y);
+		tablet->smoothing.last_time = time;
+		tablet->smoothing.initialized = true;
+		return;
+	}
+
+	/* Events may arrive in bursts, clamp to a sensible event rate */
+	dt = (time - tablet->smoothing.last_time)/1000000.0;
+	dt = max(dt, 0.001);
+	dt = min(dt, 0.1);
+	tablet->smoothing.last_time = time;
+
+	axes->point.x = tablet_smoothing_filter(&tablet->smoothing.x,
+						axes->point.x,
+						x->resolution,
+						dt, min_cutoff, beta);
+	axes->point.y = tablet_smoothing_filter(&tablet->smoothing.y,
+						axes->point.y,
+						y->resolution,
+						dt, min_cutoff, beta);
+	axes->tilt.x = tablet_smoothing_filter(&tablet->smoothing.tilt_x,
+					       axes->tilt.x,
+					       1.0,
+					       dt, min_cutoff, beta);
+	axes->tilt.y = tablet_smoothing_filter(&tablet->smoothing.tilt_y,
+					       axes->tilt.y,
+					       1.0,
+					       dt, min_cutoff, beta);
+}
+
+static void
+tablet_smoothen_axes(struct tablet_dispatch *tablet,
+		     struct tablet_axes *axes,
+		     uint64_t time)
+{
+	switch (tablet->smoothing.method) {
+	case LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE:
+		break;
+	case LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE:
+		tablet_smoothen_axes_average(tablet, axes);
+		break;
+	case LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE:
+		tablet_smoothen_axes_adaptive(tablet, axes, time);
+		break;
+	}
+}
+
 static bool
 tablet_check_notify_axes(struct tablet_dispatch *tablet,
 			 struct evdev_device *device,
@@ -740,7 +851,7 @@ out:
 	}
 
 	tablet_history_push(tablet, &tablet->axes);
-	tablet_smoothen_axes(tablet, &axes);
+	tablet_smoothen_axes(tablet, &axes, time);
 
 	/* The delta relies on the last *smooth* point, so we do it last */
 	axes.delta = tablet_tool_process_delta(tablet, tool, device, &axes, time);
@@ -1076,7 +1187,6 @@ tool_set_pressure_thresholds(struct tablet_dispatch *tablet,
 {
 	struct evdev_device *device = tablet->device;
 	const struct input_absinfo *pressure;
-	struct quirks_context *quirks = NULL;
 	struct quirks *q = NULL;
 	struct quirk_range r;
 	int lo = 0, hi = 1;
@@ -1088,8 +1198,8 @@ tool_set_pressure_thresholds(struct tablet_dispatch *tablet,
 	if (!pressure)
 		goto out;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 
 	tool->pressure.offset = pressure->minimum;
 
@@ -1121,18 +1231,11 @@ tablet_get_tool(struct tablet_dispatch *tablet,
 {
 	struct libinput *libinput = tablet_libinput_context(tablet);
 	struct libinput_tablet_tool *tool = NULL, *t;
-	struct list *tool_list;
+	struct list *tool_list = NULL;
 
-	if (serial) {
-		tool_list = &libinput->tool_list;
-		/* Check if we already have the tool in our list of tools */
-		list_for_each(t, tool_list, link) {
-			if (type == t->type && serial == t->serial) {
-				tool = t;
-				break;
-			}
-		}
-	}
+	/* Check if we already have the tool in our list of tools */
+	if (serial)
+		tool = libinput_tablet_tool_find(libinput, type, serial);
 
 	/* If we get a tool with a delayed serial number, we already created
 	 * a 0-serial number tool for it earlier. Re-use that, even though
@@ -1154,10 +1257,10 @@ tablet_get_tool(struct tablet_dispatch *tablet,
 			}
 		}
 
-		/* Didn't find the tool but we have a serial. Switch
-		 * tool_list back so we create in the correct list */
+		/* Didn't find the tool but we have a serial, it goes
+		 * into the global list of tools */
 		if (!tool && serial)
-			tool_list = &libinput->tool_list;
+			tool_list = NULL;
 	}
 
 	/* If we didn't already have the new_tool in our list of tools,
@@ -1175,7 +1278,10 @@ tablet_get_tool(struct tablet_dispatch *tablet,
 		tool_set_pressure_thresholds(tablet, tool);
 		tool_set_bits(tablet, tool);
 
-		list_insert(tool_list, &tool->link);
+		if (tool_list)
+			list_insert(tool_list, &tool->link);
+		else
+			libinput_tablet_tool_add(libinput, tool);
 	}
 
 	return tool;
@@ -2060,12 +2166,16 @@ tablet_process(struct evdev_dispatch *dispatch,
 	case EV_MSC:
 		tablet_process_misc(tablet, device, e, time);
 		break;
-	case EV_SYN:
+	case EV_SYN: {
+		struct evdev_stage_timer t = evdev_stage_begin(device);
+
 		tablet_flush(tablet, device, time);
+		evdev_stage_end(device, LIBINPUT_STAGE_TABLET_FLUSH, t);
 		tablet_toggle_touch_device(tablet, device, time);
 		tablet_reset_state(tablet);
 		tablet->quirks.last_event_time = time;
 		break;
+	}
 	default:
 		evdev_log_error(device,
 				"Unexpected event type %s (%#x)\n",
@@ -2113,6 +2223,12 @@ tablet_destroy(struct evdev_dispatch *dispatch)
 	free(tablet);
 }
 
+static uint32_t
+tablet_pairs_with(struct evdev_device *device)
+{
+	return EVDEV_PAIR_TOUCH | EVDEV_PAIR_EXTERNAL_TOUCHPAD;
+}
+
 static void
 tablet_device_added(struct evdev_device *device,
 		    struct evdev_device *added_device)
@@ -2242,6 +2358,7 @@ static struct evdev_dispatch_interface tablet_interface = {
 	.suspend = tablet_suspend,
 	.remove = NULL,
 	.destroy = tablet_destroy,
+	.pairs_with = tablet_pairs_with,
 	.device_added = tablet_device_added,
 	.device_removed = tablet_device_removed,
 	.device_suspended = NULL,
@@ -2344,11 +2461,83 @@ tablet_init_left_handed(struct evdev_device *device)
 				       tablet_change_to_left_handed);
 }
 
+#define TABLET_SMOOTHING_DEFAULT_RESPONSIVENESS 0.5
+
+static uint32_t
+tablet_smoothing_config_get_methods(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE |
+	       LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE |
+	       LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE;
+}
+
+static enum libinput_config_status
+tablet_smoothing_config_set_method(struct libinput_device *libinput_device,
+				   enum libinput_config_tablet_smoothing_method method)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	if (tablet->smoothing.method == method)
+		return LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	tablet->smoothing.method = method;
+	tablet_history_reset(tablet);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_tablet_smoothing_method
+tablet_smoothing_config_get_method(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	return tablet->smoothing.method;
+}
+
+static enum libinput_config_tablet_smoothing_method
+tablet_smoothing_config_get_default_method(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	return tablet->smoothing.default_method;
+}
+
+static enum libinput_config_status
+tablet_smoothing_config_set_responsiveness(struct libinput_device *libinput_device,
+					   double responsiveness)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	tablet->smoothing.responsiveness = responsiveness;
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static double
+tablet_smoothing_config_get_responsiveness(struct libinput_device *libinput_device)
+{
+	struct evdev_device *device = evdev_device(libinput_device);
+	struct tablet_dispatch *tablet = tablet_dispatch(device->dispatch);
+
+	return tablet->smoothing.responsiveness;
+}
+
+static double
+tablet_smoothing_config_get_default_responsiveness(struct libinput_device *device)
+{
+	return TABLET_SMOOTHING_DEFAULT_RESPONSIVENESS;
+}
+
 static void
 tablet_init_smoothing(struct evdev_device *device,
 		      struct tablet_dispatch *tablet)
 {
-	size_t history_size = ARRAY_LENGTH(tablet->history.samples);
+	enum libinput_config_tablet_smoothing_method method =
+		LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE;
 #if HAVE_LIBWACOM
 	const char *devnode;
 	WacomDeviceDatabase *db;
@@ -2385,12 +2574,24 @@ tablet_init_smoothing(struct evdev_device *device,
 	}
 
 	if (is_aes)
-		history_size = 1;
+		method = LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE;
 
 	libwacom_destroy(libwacom_device);
 out:
 #endif
-	tablet->history.size = history_size;
+	tablet->history.size = ARRAY_LENGTH(tablet->history.samples);
+
+	tablet->smoothing.method = method;
+	tablet->smoothing.default_method = method;
+	tablet->smoothing.responsiveness = TABLET_SMOOTHING_DEFAULT_RESPONSIVENESS;
+	tablet->smoothing.config.get_methods = tablet_smoothing_config_get_methods;
+	tablet->smoothing.config.set_method = tablet_smoothing_config_set_method;
+	tablet->smoothing.config.get_method = tablet_smoothing_config_get_method;
+	tablet->smoothing.config.get_default_method = tablet_smoothing_config_get_default_method;
+	tablet->smoothing.config.set_responsiveness = tablet_smoothing_config_set_responsiveness;
+	tablet->smoothing.config.get_responsiveness = tablet_smoothing_config_get_responsiveness;
+	tablet->smoothing.config.get_default_responsiveness = tablet_smoothing_config_get_default_responsiveness;
+	device->base.config.tablet_smoothing = &tablet->smoothing.config;
 }
 
 static bool
@@ -2477,6 +2678,7 @@ tablet_init(struct tablet_dispatch *tablet,
 			    "proxout",
 			    tablet_proximity_out_quirk_timer_func,
 			    tablet);
+	libinput_timer_set_device(&tablet->quirks.prox_out_timer, &tablet->device->base);
 
 	return 0;
 }
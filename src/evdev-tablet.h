@@ -53,6 +53,12 @@ struct button_state {
 	unsigned char bits[NCHARS(KEY_CNT)];
 };
 
+/* State of the speed-adaptive low-pass filter for one axis */
+struct tablet_smoothing_filter {
+	double value;
+	double velocity; /* axis units per second */
+};
+
 struct tablet_dispatch {
 	struct evdev_dispatch base;
 	struct evdev_device *device;
@@ -67,6 +73,19 @@ struct tablet_dispatch {
 		size_t size;
 	} history;
 
+	struct {
+		struct libinput_device_config_tablet_smoothing config;
+		enum libinput_config_tablet_smoothing_method method;
+		enum libinput_config_tablet_smoothing_method default_method;
+		double responsiveness;
+
+		/* adaptive filter state, reset with the history */
+		bool initialized;
+		uint64_t last_time;
+		struct tablet_smoothing_filter x, y;
+		struct tablet_smoothing_filter tilt_x, tilt_y;
+	} smoothing;
+
 	unsigned char axis_caps[NCHARS(LIBINPUT_TABLET_TOOL_AXIS_MAX + 1)];
 	int current_value[LIBINPUT_TABLET_TOOL_AXIS_MAX + 1];
 	int prev_value[LIBINPUT_TABLET_TOOL_AXIS_MAX + 1];
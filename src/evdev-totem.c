@@ -319,7 +319,7 @@ totem_slot_fetch_axes(struct totem_dispatch *totem,
 
 	delta.x = slot->axes.point.x - slot->last_point.x;
 	delta.y = slot->axes.point.y - slot->last_point.y;
-	axes.delta = filter_dispatch(device->pointer.filter, &delta, tool, time);
+	axes.delta = evdev_filter_dispatch(device, &delta, tool, time);
 
 	rc = true;
 out:
@@ -610,6 +610,12 @@ totem_interface_destroy(struct evdev_dispatch *dispatch)
 	free(totem);
 }
 
+static uint32_t
+totem_interface_pairs_with(struct evdev_device *device)
+{
+	return EVDEV_PAIR_TOUCH;
+}
+
 static void
 totem_interface_device_added(struct evdev_device *device,
 			     struct evdev_device *added_device)
@@ -703,6 +709,7 @@ struct evdev_dispatch_interface totem_interface = {
 	.suspend = totem_interface_suspend,
 	.remove = NULL,
 	.destroy = totem_interface_destroy,
+	.pairs_with = totem_interface_pairs_with,
 	.device_added = totem_interface_device_added,
 	.device_removed = totem_interface_device_removed,
 	.device_suspended = totem_interface_device_removed, /* treat as remove */
@@ -0,0 +1,614 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * io_uring based reader for the evdev device fds.
+ *
+ * Every device has a POLLIN poll request posted on the ring, the ring fd
+ * is the only libinput source for these devices. Once the ring fd is
+ * readable we reap all poll completions and submit one read per ready
+ * device in a single io_uring_enter() call that also waits for those
+ * reads. The evdev driver has no read_iter, so the kernel cannot issue
+ * the reads inline and hands them to its io-wq worker threads instead.
+ * The events are then processed and the poll requests re-posted with a
+ * second io_uring_enter() call. A dispatch thus costs the same two
+ * syscalls no matter how many devices had data.
+ *
+ * The device fds remain O_NONBLOCK: io_uring does not retry reads on
+ * non-blocking fds that are not ready, so posting reads up front would
+ * only return -EAGAIN.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include "evdev.h"
+
+#define EVDEV_URING_ENTRIES 64
+#define EVDEV_URING_MAX_EVENTS 64
+
+/* user_data of a request is the reader, tagged with the request type */
+enum evdev_uring_op {
+	EVDEV_URING_OP_POLL = 0,
+	EVDEV_URING_OP_READ = 1,
+	EVDEV_URING_OP_MASK = 1,
+};
+
+struct evdev_uring_reader {
+	/* NULL once the device no longer reads through the ring. The
+	 * reader is freed when its last request completes */
+	struct evdev_device *device;
+	int fd;
+	unsigned int inflight;
+	bool polling;
+
+	/* in evdev_uring.cancel_list if the poll could not be cancelled
+	 * when the device was removed */
+	bool cancel_pending;
+	struct list cancel_link;
+
+	struct input_event events[EVDEV_URING_MAX_EVENTS];
+};
+
+struct evdev_uring {
+	struct libinput *libinput;
+	struct libinput_source *source;
+	int fd;
+
+	struct {
+		unsigned int *head;
+		unsigned int *tail;
+		unsigned int mask;
+		unsigned int entries;
+		unsigned int *array;
+		struct io_uring_sqe *sqes;
+		unsigned int pending; /* queued, not yet submitted */
+	} sq;
+
+	struct {
+		unsigned int *head;
+		unsigned int *tail;
+		unsigned int mask;
+		struct io_uring_cqe *cqes;
+	} cq;
+
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;
+	size_t cq_ring_size;
+	size_t sqes_size;
+
+	unsigned int inflight;
+	struct list cancel_list;
+};
+
+static inline int
+io_uring_setup(unsigned int entries, struct io_uring_params *params)
+{
+	return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static inline int
+io_uring_enter(int fd,
+	       unsigned int to_submit,
+	       unsigned int min_complete,
+	       unsigned int flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+static inline int
+io_uring_register(int fd, unsigned int opcode, void *arg, unsigned int nargs)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, nargs);
+}
+
+static inline uint64_t
+evdev_uring_tag(struct evdev_uring_reader *reader, enum evdev_uring_op op)
+{
+	return (uint64_t)(uintptr_t)reader | op;
+}
+
+static int
+evdev_uring_submit(struct evdev_uring *uring, unsigned int min_complete)
+{
+	unsigned int flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+	int rc;
+
+	if (uring->sq.pending == 0 && min_complete == 0)
+		return 0;
+
+	do {
+		rc = io_uring_enter(uring->fd,
+				    uring->sq.pending,
+				    min_complete,
+				    flags);
+	} while (rc == -1 && errno == EINTR);
+
+	if (rc < 0) {
+		log_error(uring->libinput,
+			  "io_uring: failed to submit requests (%s)\n",
+			  strerror(errno));
+		return -errno;
+	}
+
+	uring->sq.pending -= min((unsigned int)rc, uring->sq.pending);
+
+	return 0;
+}
+
+static struct io_uring_sqe *
+evdev_uring_get_sqe(struct evdev_uring *uring)
+{
+	struct io_uring_sqe *sqe;
+	unsigned int tail = *uring->sq.tail;
+	unsigned int index;
+
+	if (tail - __atomic_load_n(uring->sq.head, __ATOMIC_ACQUIRE) ==
+	    uring->sq.entries) {
+		evdev_uring_submit(uring, 0);
+		if (tail - __atomic_load_n(uring->sq.head, __ATOMIC_ACQUIRE) ==
+		    uring->sq.entries)
+			return NULL;
+	}
+
+	index = tail & uring->sq.mask;
+	sqe = &uring->sq.sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	uring->sq.array[index] = index;
+
+	return sqe;
+}
+
+static inline void
+evdev_uring_queue_sqe(struct evdev_uring *uring)
+{
+	__atomic_store_n(uring->sq.tail, *uring->sq.tail + 1, __ATOMIC_RELEASE);
+	uring->sq.pending++;
+}
+
+static bool
+evdev_uring_queue_poll(struct evdev_uring *uring,
+		       struct evdev_uring_reader *reader)
+{
+	struct io_uring_sqe *sqe = evdev_uring_get_sqe(uring);
+
+	if (!sqe)
+		return false;
+
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = reader->fd;
+	sqe->poll_events = POLLIN;
+	sqe->user_data = evdev_uring_tag(reader, EVDEV_URING_OP_POLL);
+	evdev_uring_queue_sqe(uring);
+
+	reader->polling = true;
+	reader->inflight++;
+	uring->inflight++;
+
+	return true;
+}
+
+static bool
+evdev_uring_queue_read(struct evdev_uring *uring,
+		       struct evdev_uring_reader *reader)
+{
+	struct io_uring_sqe *sqe = evdev_uring_get_sqe(uring);
+
+	if (!sqe)
+		return false;
+
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = reader->fd;
+	sqe->off = (uint64_t)-1;
+	sqe->addr = (uint64_t)(uintptr_t)reader->events;
+	sqe->len = sizeof(reader->events);
+	sqe->user_data = evdev_uring_tag(reader, EVDEV_URING_OP_READ);
+	evdev_uring_queue_sqe(uring);
+
+	reader->inflight++;
+	uring->inflight++;
+
+	return true;
+}
+
+static bool
+evdev_uring_queue_cancel(struct evdev_uring *uring,
+			 struct evdev_uring_reader *reader)
+{
+	struct io_uring_sqe *sqe = evdev_uring_get_sqe(uring);
+
+	if (!sqe)
+		return false;
+
+	/* The cancel request itself completes with user_data 0, the
+	 * cancelled poll completes with -ECANCELED */
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = evdev_uring_tag(reader, EVDEV_URING_OP_POLL);
+	sqe->user_data = 0;
+	evdev_uring_queue_sqe(uring);
+
+	return true;
+}
+
+static void
+evdev_uring_queue_pending_cancels(struct evdev_uring *uring)
+{
+	struct evdev_uring_reader *reader;
+
+	if (list_empty(&uring->cancel_list))
+		return;
+
+	list_for_each_safe(reader, &uring->cancel_list, cancel_link) {
+		if (!evdev_uring_queue_cancel(uring, reader))
+			break;
+		reader->cancel_pending = false;
+		list_remove(&reader->cancel_link);
+	}
+
+	/* Submit before the next reap, the poll may complete and free
+	 * the reader otherwise */
+	evdev_uring_submit(uring, 0);
+}
+
+static void
+evdev_uring_release(struct evdev_uring *uring,
+		    struct evdev_uring_reader *reader)
+{
+	if (reader->device || reader->inflight > 0)
+		return;
+
+	if (reader->cancel_pending)
+		list_remove(&reader->cancel_link);
+	free(reader);
+}
+
+static void
+evdev_uring_detach(struct evdev_uring *uring,
+		   struct evdev_uring_reader *reader)
+{
+	reader->device->uring_reader = NULL;
+	reader->device = NULL;
+
+	evdev_uring_release(uring, reader);
+}
+
+static void
+evdev_uring_handle_poll(struct evdev_uring *uring,
+			struct evdev_uring_reader *reader,
+			int res,
+			unsigned int *nreads)
+{
+	reader->polling = false;
+
+	if (res == -ECANCELED)
+		return;
+
+	/* Errors and hangups are picked up by the read */
+	if (evdev_uring_queue_read(uring, reader))
+		(*nreads)++;
+	else
+		evdev_uring_queue_poll(uring, reader);
+}
+
+static void
+evdev_uring_handle_read(struct evdev_uring *uring,
+			struct evdev_uring_reader *reader,
+			int res)
+{
+	struct evdev_device *device = reader->device;
+	int rc;
+
+	if (res > 0) {
+		rc = evdev_device_dispatch_events(device,
+						  reader->events,
+						  res / sizeof(reader->events[0]));
+		/* A handler may have removed the device, the completion
+		 * still holds the reader, see evdev_uring_reap() */
+		if (!reader->device)
+			return;
+
+		/* The resync failed, see evdev_device_dispatch() */
+		if (rc != 0 && rc != -EINTR) {
+			evdev_uring_detach(uring, reader);
+			return;
+		}
+	} else if (res != -EAGAIN && res != -EINTR) {
+		/* Same as a read error on the fd, the device is gone and
+		 * will be removed by the backend */
+		evdev_uring_detach(uring, reader);
+		return;
+	}
+
+	evdev_uring_queue_poll(uring, reader);
+}
+
+static void
+evdev_uring_reap(struct evdev_uring *uring, unsigned int *nreads)
+{
+	unsigned int head = *uring->cq.head;
+	unsigned int tail = __atomic_load_n(uring->cq.tail, __ATOMIC_ACQUIRE);
+
+	while (head != tail) {
+		struct io_uring_cqe *cqe = &uring->cq.cqes[head & uring->cq.mask];
+		uint64_t user_data = cqe->user_data;
+		int res = cqe->res;
+		struct evdev_uring_reader *reader;
+
+		/* Release the slot first, processing may queue more
+		 * requests */
+		head++;
+		__atomic_store_n(uring->cq.head, head, __ATOMIC_RELEASE);
+
+		if (user_data == 0)
+			goto next;
+
+		reader = (struct evdev_uring_reader *)(uintptr_t)(user_data & ~(uint64_t)EVDEV_URING_OP_MASK);
+		uring->inflight--;
+
+		if (!reader->device) {
+			if ((user_data & EVDEV_URING_OP_MASK) == EVDEV_URING_OP_POLL)
+				reader->polling = false;
+		} else {
+			switch (user_data & EVDEV_URING_OP_MASK) {
+			case EVDEV_URING_OP_POLL:
+				evdev_uring_handle_poll(uring, reader, res, nreads);
+				break;
+			case EVDEV_URING_OP_READ:
+				evdev_uring_handle_read(uring, reader, res);
+				break;
+			}
+		}
+
+		/* Only drop the completion's reference now, processing the
+		 * events may remove the device and detach the reader */
+		reader->inflight--;
+		evdev_uring_release(uring, reader);
+next:
+		tail = __atomic_load_n(uring->cq.tail, __ATOMIC_ACQUIRE);
+	}
+}
+
+static void
+evdev_uring_dispatch(void *data)
+{
+	struct evdev_uring *uring = data;
+	unsigned int nreads = 0;
+
+	evdev_uring_queue_pending_cancels(uring);
+	evdev_uring_reap(uring, &nreads);
+
+	/* Wait for the reads, they run on the kernel's io-wq workers */
+	if (nreads > 0) {
+		evdev_uring_submit(uring, nreads);
+		evdev_uring_reap(uring, &nreads);
+	}
+
+	evdev_uring_submit(uring, 0);
+}
+
+int
+evdev_uring_add_device(struct evdev_uring *uring,
+		       struct evdev_device *device,
+		       int fd)
+{
+	struct evdev_uring_reader *reader;
+
+	reader = zalloc(sizeof(*reader));
+	reader->device = device;
+	reader->fd = fd;
+
+	if (!evdev_uring_queue_poll(uring, reader) ||
+	    evdev_uring_submit(uring, 0) != 0) {
+		/* Anything queued is still submitted with the next
+		 * request, the reader must stay around until then */
+		if (reader->inflight == 0)
+			free(reader);
+		else
+			reader->device = NULL;
+		return -1;
+	}
+
+	device->uring_reader = reader;
+
+	return 0;
+}
+
+void
+evdev_uring_remove_device(struct evdev_device *device)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+	struct evdev_uring *uring = libinput->uring;
+	struct evdev_uring_reader *reader = device->uring_reader;
+
+	/* Submit now, the caller closes the fd next. The poll holds its
+	 * own reference to the file, closing the fd does not end it. If
+	 * the ring has no room for the cancel, retry on the next
+	 * dispatch */
+	if (reader->polling) {
+		if (!evdev_uring_queue_cancel(uring, reader)) {
+			log_error(libinput,
+				  "io_uring: no room to cancel the poll, deferring\n");
+			reader->cancel_pending = true;
+			list_append(&uring->cancel_list, &reader->cancel_link);
+		}
+		evdev_uring_submit(uring, 0);
+	}
+
+	evdev_uring_detach(uring, reader);
+}
+
+static bool
+evdev_uring_probe(int fd)
+{
+	struct io_uring_probe *probe;
+	const size_t nops = 256;
+	bool supported = false;
+
+	probe = zalloc(sizeof(*probe) + nops * sizeof(probe->ops[0]));
+	if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, nops) == 0 &&
+	    probe->last_op >= IORING_OP_READ &&
+	    (probe->ops[IORING_OP_POLL_ADD].flags & IO_URING_OP_SUPPORTED) &&
+	    (probe->ops[IORING_OP_ASYNC_CANCEL].flags & IO_URING_OP_SUPPORTED) &&
+	    (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+		supported = true;
+	free(probe);
+
+	return supported;
+}
+
+struct evdev_uring *
+evdev_uring_new(struct libinput *libinput)
+{
+	struct evdev_uring *uring;
+	struct io_uring_params params;
+	void *ptr;
+
+	uring = zalloc(sizeof(*uring));
+	uring->libinput = libinput;
+	list_init(&uring->cancel_list);
+	uring->sq_ring = MAP_FAILED;
+	uring->cq_ring = MAP_FAILED;
+
+	memset(&params, 0, sizeof(params));
+	uring->fd = io_uring_setup(EVDEV_URING_ENTRIES, &params);
+	if (uring->fd < 0) {
+		log_info(libinput,
+			 "io_uring: not available (%s), using read()\n",
+			 strerror(errno));
+		free(uring);
+		return NULL;
+	}
+
+	/* NODROP so we never lose the completion that frees a reader */
+	if (!(params.features & IORING_FEAT_NODROP) ||
+	    !(params.features & IORING_FEAT_RW_CUR_POS) ||
+	    !evdev_uring_probe(uring->fd)) {
+		log_info(libinput,
+			 "io_uring: kernel too old, using read()\n");
+		goto error;
+	}
+
+	uring->sq_ring_size = params.sq_off.array +
+			      params.sq_entries * sizeof(unsigned int);
+	uring->cq_ring_size = params.cq_off.cqes +
+			      params.cq_entries * sizeof(struct io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		uring->sq_ring_size = max(uring->sq_ring_size,
+					  uring->cq_ring_size);
+		uring->cq_ring_size = uring->sq_ring_size;
+	}
+
+	uring->sq_ring = mmap(NULL, uring->sq_ring_size,
+			      PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+			      uring->fd, IORING_OFF_SQ_RING);
+	if (uring->sq_ring == MAP_FAILED)
+		goto error;
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		uring->cq_ring = uring->sq_ring;
+	} else {
+		uring->cq_ring = mmap(NULL, uring->cq_ring_size,
+				      PROT_READ|PROT_WRITE,
+				      MAP_SHARED|MAP_POPULATE,
+				      uring->fd, IORING_OFF_CQ_RING);
+		if (uring->cq_ring == MAP_FAILED)
+			goto error;
+	}
+
+	uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ptr = mmap(NULL, uring->sqes_size,
+		   PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+		   uring->fd, IORING_OFF_SQES);
+	if (ptr == MAP_FAILED)
+		goto error;
+	uring->sq.sqes = ptr;
+
+	ptr = uring->sq_ring;
+	uring->sq.head = (unsigned int *)((char *)ptr + params.sq_off.head);
+	uring->sq.tail = (unsigned int *)((char *)ptr + params.sq_off.tail);
+	uring->sq.mask = *(unsigned int *)((char *)ptr + params.sq_off.ring_mask);
+	uring->sq.entries = *(unsigned int *)((char *)ptr + params.sq_off.ring_entries);
+	uring->sq.array = (unsigned int *)((char *)ptr + params.sq_off.array);
+
+	ptr = uring->cq_ring;
+	uring->cq.head = (unsigned int *)((char *)ptr + params.cq_off.head);
+	uring->cq.tail = (unsigned int *)((char *)ptr + params.cq_off.tail);
+	uring->cq.mask = *(unsigned int *)((char *)ptr + params.cq_off.ring_mask);
+	uring->cq.cqes = (struct io_uring_cqe *)((char *)ptr + params.cq_off.cqes);
+
+	uring->source = libinput_add_fd(libinput,
+					uring->fd,
+					evdev_uring_dispatch,
+					uring);
+	if (!uring->source) {
+		munmap(uring->sq.sqes, uring->sqes_size);
+		goto error;
+	}
+
+	return uring;
+
+error:
+	if (uring->cq_ring != MAP_FAILED && uring->cq_ring != uring->sq_ring)
+		munmap(uring->cq_ring, uring->cq_ring_size);
+	if (uring->sq_ring != MAP_FAILED)
+		munmap(uring->sq_ring, uring->sq_ring_size);
+	close(uring->fd);
+	free(uring);
+	return NULL;
+}
+
+void
+evdev_uring_destroy(struct evdev_uring *uring)
+{
+	unsigned int nreads = 0;
+
+	if (!uring)
+		return;
+
+	/* All devices are removed, wait for the cancelled polls so the
+	 * kernel no longer references any reader */
+	while (uring->inflight > 0) {
+		evdev_uring_queue_pending_cancels(uring);
+		if (evdev_uring_submit(uring, 1) != 0)
+			break;
+		evdev_uring_reap(uring, &nreads);
+	}
+
+	libinput_remove_source(uring->libinput, uring->source);
+	munmap(uring->sq.sqes, uring->sqes_size);
+	if (uring->cq_ring != uring->sq_ring)
+		munmap(uring->cq_ring, uring->cq_ring_size);
+	munmap(uring->sq_ring, uring->sq_ring_size);
+	close(uring->fd);
+	free(uring);
+}
@@ -44,6 +44,7 @@
 #include "libinput-private.h"
 #include "quirks.h"
 #include "util-input-event.h"
+#include "util-trace.h"
 
 #if HAVE_LIBWACOM
 #include <libwacom/libwacom.h>
@@ -420,7 +421,6 @@ static void
 evdev_tag_trackpoint(struct evdev_device *device,
 		     struct udev_device *udev_device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	char *prop;
 
@@ -431,8 +431,8 @@ evdev_tag_trackpoint(struct evdev_device *device,
 
 	device->tags |= EVDEV_TAG_TRACKPOINT;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (q && quirks_get_string(q, QUIRK_ATTR_TRACKPOINT_INTEGRATION, &prop)) {
 		if (streq(prop, "internal")) {
 			/* noop, this is the default anyway */
@@ -468,7 +468,6 @@ static void
 evdev_tag_keyboard(struct evdev_device *device,
 		   struct udev_device *udev_device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	char *prop;
 	int code;
@@ -483,8 +482,8 @@ evdev_tag_keyboard(struct evdev_device *device,
 			return;
 	}
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (q && quirks_get_string(q, QUIRK_ATTR_KEYBOARD_INTEGRATION, &prop)) {
 		if (streq(prop, "internal")) {
 			evdev_tag_keyboard_internal(device);
@@ -798,6 +797,7 @@ evdev_init_button_scroll(struct evdev_device *device,
 			    evdev_libinput_context(device),
 			    timer_name,
 			    evdev_button_scroll_timeout, device);
+	libinput_timer_set_device(&device->scroll.timer, &device->base);
 	device->scroll.config.get_methods = evdev_scroll_get_methods;
 	device->scroll.config.set_method = evdev_scroll_set_method;
 	device->scroll.config.get_method = evdev_scroll_get_method;
@@ -911,12 +911,11 @@ enum switch_reliability
 evdev_read_switch_reliability_prop(struct evdev_device *device)
 {
 	enum switch_reliability r;
-	struct quirks_context *quirks;
 	struct quirks *q;
 	char *prop;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q || !quirks_get_string(q, QUIRK_ATTR_LID_SWITCH_RELIABILITY, &prop)) {
 		r = RELIABILITY_UNKNOWN;
 	} else if (!parse_switch_reliability_property(prop, &r)) {
@@ -980,7 +979,17 @@ evdev_process_event(struct evdev_device *device, struct input_event *e)
 
 	libinput_timer_flush(evdev_libinput_context(device), time);
 
+	if (e->type == EV_SYN && e->code == SYN_REPORT)
+		trace_probe(evdev_frame, device, device->devname, time);
+
+	trace_probe(dispatch_enter,
+		    device,
+		    dispatch->dispatch_type,
+		    e->type,
+		    e->code,
+		    time);
 	dispatch->interface->process(dispatch, device, e, time);
+	trace_probe(dispatch_exit, device, dispatch->dispatch_type, time);
 }
 
 static inline void
@@ -1001,6 +1010,21 @@ evdev_device_dispatch_one(struct evdev_device *device,
 	}
 }
 
+static inline void
+evdev_apply_clock_offset(struct evdev_device *device,
+			 struct input_event *ev)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+
+	/* Kernel timestamps are CLOCK_MONOTONIC, shift them onto our
+	 * clock if it was advanced with libinput_clock_advance() */
+	if (libinput->clock.offset == 0)
+		return;
+
+	input_event_set_time(ev,
+			     input_event_time(ev) + libinput->clock.offset);
+}
+
 static int
 evdev_sync_device(struct evdev_device *device)
 {
@@ -1012,6 +1036,7 @@ evdev_sync_device(struct evdev_device *device)
 					 LIBEVDEV_READ_FLAG_SYNC, &ev);
 		if (rc < 0)
 			break;
+		evdev_apply_clock_offset(device, &ev);
 		evdev_device_dispatch_one(device, &ev);
 	} while (rc == LIBEVDEV_READ_STATUS_SYNC);
 
@@ -1051,6 +1076,7 @@ evdev_device_dispatch(void *data)
 	struct evdev_device *device = data;
 	struct libinput *libinput = evdev_libinput_context(device);
 	struct input_event ev;
+	struct evdev_stage_timer t;
 	int rc;
 	bool once = false;
 
@@ -1058,8 +1084,13 @@ evdev_device_dispatch(void *data)
 	 * per frame and we have to process all the events available on the
 	 * fd, otherwise there will be input lag. */
 	do {
+		t = evdev_stage_begin(device);
 		rc = libevdev_next_event(device->evdev,
 					 LIBEVDEV_READ_FLAG_NORMAL, &ev);
+		evdev_stage_end(device, LIBINPUT_STAGE_READ, t);
+		if (rc >= 0)
+			evdev_apply_clock_offset(device, &ev);
+
 		if (rc == LIBEVDEV_READ_STATUS_SYNC) {
 			evdev_log_info_ratelimit(device,
 						 &device->syn_drop_limit,
@@ -1089,6 +1120,265 @@ evdev_device_dispatch(void *data)
 	}
 }
 
+static int
+evdev_device_add_source(struct evdev_device *device, int fd)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+
+	if (libinput->io_uring_enabled &&
+	    evdev_uring_add_device(libinput->uring, device, fd) == 0)
+		return 0;
+
+	device->source =
+		libinput_add_fd(libinput, fd, evdev_device_dispatch, device);
+
+	return device->source ? 0 : -ENOMEM;
+}
+
+static void
+evdev_device_remove_source(struct evdev_device *device)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+
+	if (device->uring_reader)
+		evdev_uring_remove_device(device);
+
+	if (device->source) {
+		libinput_remove_source(libinput, device->source);
+		device->source = NULL;
+	}
+}
+
+/* Mirror the filtering and state tracking libevdev_next_event() does for
+ * events we read from the fd ourselves */
+static bool
+evdev_update_libevdev_state(struct libevdev *evdev, struct input_event *ev)
+{
+	int nslots;
+
+	switch (ev->type) {
+	case EV_SYN:
+		return true;
+	case EV_ABS:
+	case EV_KEY:
+	case EV_LED:
+	case EV_SW:
+		break;
+	default:
+		return libevdev_has_event_code(evdev, ev->type, ev->code);
+	}
+
+	if (!libevdev_has_event_code(evdev, ev->type, ev->code))
+		return false;
+
+	if (ev->type == EV_ABS && ev->code == ABS_MT_SLOT) {
+		nslots = libevdev_get_num_slots(evdev);
+		if (nslots > 0 && (ev->value < 0 || ev->value >= nslots))
+			ev->value = nslots - 1;
+	}
+
+	libevdev_set_event_value(evdev, ev->type, ev->code, ev->value);
+
+	return true;
+}
+
+int
+evdev_device_dispatch_events(struct evdev_device *device,
+			     struct input_event *events,
+			     size_t nevents)
+{
+	struct input_event ev;
+	struct evdev_stage_timer t;
+	bool once = false;
+	bool is_known;
+	int rc;
+
+	for (size_t i = 0; i < nevents; i++) {
+		struct input_event *e = &events[i];
+
+		evdev_apply_clock_offset(device, e);
+
+		if (libevdev_event_is_code(e, EV_SYN, SYN_DROPPED)) {
+			evdev_log_info_ratelimit(device,
+						 &device->syn_drop_limit,
+						 "SYN_DROPPED event - some input events have been lost.\n");
+
+			/* see evdev_device_dispatch() */
+			ev = *e;
+			ev.code = SYN_REPORT;
+			evdev_device_dispatch_one(device, &ev);
+
+			/* libevdev never saw the SYN_DROPPED, make it
+			 * re-sync from the kernel state. The rest of
+			 * this batch predates that state */
+			t = evdev_stage_begin(device);
+			rc = libevdev_next_event(device->evdev,
+						 LIBEVDEV_READ_FLAG_FORCE_SYNC,
+						 &ev);
+			evdev_stage_end(device, LIBINPUT_STAGE_READ, t);
+			if (rc == LIBEVDEV_READ_STATUS_SYNC)
+				rc = evdev_sync_device(device);
+			return rc == -EAGAIN ? 0 : rc;
+		}
+
+		/* The kernel did the read, the libevdev bookkeeping is
+		 * what is left of libevdev_next_event() */
+		t = evdev_stage_begin(device);
+		is_known = evdev_update_libevdev_state(device->evdev, e);
+		evdev_stage_end(device, LIBINPUT_STAGE_READ, t);
+		if (!is_known)
+			continue;
+
+		if (!once) {
+			evdev_note_time_delay(device, e);
+			once = true;
+		}
+		evdev_device_dispatch_one(device, e);
+	}
+
+	return 0;
+}
+
+static void
+evdev_inject_one(struct evdev_device *device,
+		 uint64_t time,
+		 unsigned int type,
+		 unsigned int code,
+		 int value)
+{
+	struct input_event ev = {
+		.type = type,
+		.code = code,
+		.value = value,
+	};
+
+	input_event_set_time(&ev, time);
+
+	switch (type) {
+	case EV_SYN:
+		device->inject.nevents = 0;
+		break;
+	case EV_ABS:
+	case EV_KEY:
+	case EV_LED:
+	case EV_SW:
+		libevdev_set_event_value(device->evdev, type, code, value);
+		/* fallthrough */
+	default:
+		device->inject.nevents++;
+		break;
+	}
+
+	evdev_device_dispatch_one(device, &ev);
+}
+
+int
+evdev_device_inject_event(struct evdev_device *device,
+			  unsigned int type,
+			  unsigned int code,
+			  int value)
+{
+	struct libevdev *evdev = device->evdev;
+	uint64_t time;
+	int slot = device->inject.slot;
+
+	if (!device->source && !device->uring_reader)
+		return -ENODEV;
+
+	if (type == EV_SYN) {
+		if (code != SYN_REPORT)
+			return -EINVAL;
+	} else if (!libevdev_has_event_code(evdev, type, code)) {
+		return -EINVAL;
+	}
+
+	time = libinput_now(evdev_libinput_context(device));
+
+	/* Filter the way the kernel's input core does, our dispatch
+	 * implementations rely on not seeing unchanged values */
+	switch (type) {
+	case EV_SYN:
+		if (device->inject.nevents == 0)
+			return 0;
+		break;
+	case EV_ABS:
+		if (code < ABS_MT_SLOT) {
+			if (libevdev_get_event_value(evdev, type, code) == value)
+				return 0;
+			break;
+		}
+
+		/* protocol A multitouch is passed through as-is */
+		if (libevdev_get_num_slots(evdev) <= 0)
+			break;
+
+		if (code == ABS_MT_SLOT) {
+			if (value < 0 || value >= libevdev_get_num_slots(evdev))
+				return -EINVAL;
+			device->inject.slot = value;
+			return 0;
+		}
+
+		if (libevdev_get_slot_value(evdev, slot, code) == value)
+			return 0;
+
+		/* ABS_MT_SLOT is only sent when the slot changes */
+		if (slot != libevdev_get_current_slot(evdev))
+			evdev_inject_one(device, time, EV_ABS, ABS_MT_SLOT, slot);
+		break;
+	case EV_KEY:
+		/* key repeat is passed through as-is */
+		if (value != 2 &&
+		    libevdev_get_event_value(evdev, type, code) == !!value)
+			return 0;
+		break;
+	case EV_LED:
+	case EV_SW:
+		if (libevdev_get_event_value(evdev, type, code) == !!value)
+			return 0;
+		break;
+	case EV_REL:
+		if (value == 0)
+			return 0;
+		break;
+	default:
+		break;
+	}
+
+	evdev_inject_one(device, time, type, code, value);
+
+	return 0;
+}
+
+int
+evdev_device_get_stage_counters(struct evdev_device *device,
+				enum libinput_stage stage,
+				uint64_t *count,
+				uint64_t *nsec,
+				uint64_t *cycles)
+{
+	const struct evdev_stage_counter *counter;
+
+	if ((unsigned int)stage >= EVDEV_NUM_STAGES)
+		return -1;
+
+	counter = &device->stage_counters[stage];
+	if (count)
+		*count = counter->count;
+	if (nsec)
+		*nsec = counter->nsec;
+	if (cycles)
+		*cycles = counter->cycles;
+
+	return 0;
+}
+
+void
+evdev_device_reset_stage_counters(struct evdev_device *device)
+{
+	memset(device->stage_counters, 0, sizeof(device->stage_counters));
+}
+
 static inline bool
 evdev_init_accel(struct evdev_device *device,
 		 enum libinput_config_accel_profile which)
@@ -1311,15 +1601,14 @@ evdev_read_wheel_click_props(struct evdev_device *device)
 static inline double
 evdev_get_trackpoint_multiplier(struct evdev_device *device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	double multiplier = 1.0;
 
 	if (!(device->tags & EVDEV_TAG_TRACKPOINT))
 		return 1.0;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (q) {
 		quirks_get_double(q, QUIRK_ATTR_TRACKPOINT_MULTIPLIER, &multiplier);
 		quirks_unref(q);
@@ -1343,12 +1632,11 @@ evdev_get_trackpoint_multiplier(struct evdev_device *device)
 static inline bool
 evdev_need_velocity_averaging(struct evdev_device *device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	bool use_velocity_averaging = false; /* default off unless we have quirk */
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (q) {
 		quirks_get_bool(q,
 				QUIRK_ATTR_USE_VELOCITY_AVERAGING,
@@ -1412,11 +1700,10 @@ evdev_read_model_flags(struct evdev_device *device)
 	const struct model_map *m = model_map;
 	uint32_t model_flags = 0;
 	uint32_t all_model_flags = 0;
-	struct quirks_context *quirks;
 	struct quirks *q;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 
 	while (q && m->quirk) {
 		bool is_set;
@@ -1477,13 +1764,12 @@ evdev_read_attr_res_prop(struct evdev_device *device,
 			 size_t *xres,
 			 size_t *yres)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	struct quirk_dimensions dim;
 	bool rc = false;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q)
 		return false;
 
@@ -1503,13 +1789,12 @@ evdev_read_attr_size_prop(struct evdev_device *device,
 			  size_t *size_x,
 			  size_t *size_y)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	struct quirk_dimensions dim;
 	bool rc = false;
 
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q)
 		return false;
 
@@ -1959,29 +2244,226 @@ evdev_configure_device(struct evdev_device *device)
 	return fallback_dispatch_create(&device->base);
 }
 
+static uint32_t
+evdev_device_get_pair_classes(struct evdev_device *device)
+{
+	uint32_t classes = 0;
+
+	if (device->tags & EVDEV_TAG_KEYBOARD)
+		classes |= EVDEV_PAIR_KEYBOARD;
+	if (device->tags & EVDEV_TAG_TRACKPOINT)
+		classes |= EVDEV_PAIR_TRACKPOINT;
+	if (device->tags & EVDEV_TAG_EXTERNAL_MOUSE)
+		classes |= EVDEV_PAIR_EXTERNAL_MOUSE;
+	if ((device->tags & EVDEV_TAG_EXTERNAL_TOUCHPAD) &&
+	    (device->seat_caps & EVDEV_DEVICE_POINTER))
+		classes |= EVDEV_PAIR_EXTERNAL_TOUCHPAD;
+	if (device->tags & EVDEV_TAG_LID_SWITCH)
+		classes |= EVDEV_PAIR_LID_SWITCH;
+	if (device->tags & EVDEV_TAG_TABLET_MODE_SWITCH)
+		classes |= EVDEV_PAIR_TABLET_MODE_SWITCH;
+	if (device->seat_caps & EVDEV_DEVICE_TABLET)
+		classes |= EVDEV_PAIR_TABLET;
+	if (device->seat_caps & EVDEV_DEVICE_TOUCH)
+		classes |= EVDEV_PAIR_TOUCH;
+
+	return classes;
+}
+
 static void
-evdev_notify_added_device(struct evdev_device *device)
+evdev_pair_index_add(struct evdev_device *device)
 {
-	struct libinput_device *dev;
+	struct libinput_seat *seat = device->base.seat;
+	struct evdev_dispatch_interface *interface = device->dispatch->interface;
+
+	device->pairing.classes = evdev_device_get_pair_classes(device);
+	if (interface->pairs_with)
+		device->pairing.peers = interface->pairs_with(device);
 
-	list_for_each(dev, &device->base.seat->devices_list, link) {
-		struct evdev_device *d = evdev_device(dev);
-		if (dev == &device->base)
+	for (size_t i = 0; i < SEAT_PAIR_CLASS_COUNT; i++) {
+		struct evdev_pair_node *node;
+
+		if (device->pairing.classes & bit(i)) {
+			node = &device->pairing.class_nodes[i];
+			node->device = device;
+			list_insert(seat->pair_class_index[i].prev, &node->link);
+		}
+
+		if (device->pairing.peers & bit(i)) {
+			node = &device->pairing.peer_nodes[i];
+			node->device = device;
+			list_insert(seat->pair_peer_index[i].prev, &node->link);
+		}
+	}
+}
+
+static void
+evdev_pair_index_remove(struct evdev_device *device)
+{
+	for (size_t i = 0; i < SEAT_PAIR_CLASS_COUNT; i++) {
+		if (device->pairing.classes & bit(i))
+			list_remove(&device->pairing.class_nodes[i].link);
+		if (device->pairing.peers & bit(i))
+			list_remove(&device->pairing.peer_nodes[i].link);
+	}
+
+	device->pairing.classes = 0;
+	device->pairing.peers = 0;
+}
+
+typedef void (*evdev_pair_func)(struct evdev_device *device,
+				struct evdev_device *other);
+
+/* Call func(d, device) once for every device d that pairs with one of
+ * the classes of device */
+static void
+evdev_pair_notify_peers(struct evdev_device *device, evdev_pair_func func)
+{
+	struct libinput_seat *seat = device->base.seat;
+	uint32_t classes = device->pairing.classes;
+
+	for (size_t i = 0; i < SEAT_PAIR_CLASS_COUNT; i++) {
+		struct evdev_pair_node *node;
+
+		if ((classes & bit(i)) == 0)
 			continue;
 
-		/* Notify existing device d about addition of device */
-		if (d->dispatch->interface->device_added)
-			d->dispatch->interface->device_added(d, device);
+		list_for_each(node, &seat->pair_peer_index[i], link) {
+			struct evdev_device *d = node->device;
 
-		/* Notify new device about existing device d */
-		if (device->dispatch->interface->device_added)
-			device->dispatch->interface->device_added(device, d);
+			/* skip d if a lower class already matched */
+			if (d == device ||
+			    (d->pairing.peers & classes & (bit(i) - 1)))
+				continue;
 
-		/* Notify new device if existing device d is suspended */
-		if (d->is_suspended &&
-		    device->dispatch->interface->device_suspended)
-			device->dispatch->interface->device_suspended(device, d);
+			func(d, device);
+		}
 	}
+}
+
+/* Call func(device, d) once for every device d of one of the classes
+ * device pairs with */
+static void
+evdev_pair_notify_self(struct evdev_device *device, evdev_pair_func func)
+{
+	struct libinput_seat *seat = device->base.seat;
+	uint32_t peers = device->pairing.peers;
+
+	for (size_t i = 0; i < SEAT_PAIR_CLASS_COUNT; i++) {
+		struct evdev_pair_node *node;
+
+		if ((peers & bit(i)) == 0)
+			continue;
+
+		list_for_each(node, &seat->pair_class_index[i], link) {
+			struct evdev_device *d = node->device;
+
+			/* skip d if a lower class already matched */
+			if (d == device ||
+			    (d->pairing.classes & peers & (bit(i) - 1)))
+				continue;
+
+			func(device, d);
+		}
+	}
+}
+
+struct evdev_device *
+evdev_device_find_by_syspath(struct libinput *libinput,
+			     const char *syspath,
+			     struct libinput_seat *seat)
+{
+	struct evdev_device *device;
+
+	hash_table_for_each_match(device,
+				  &libinput->device_syspath_index,
+				  hash_string(syspath),
+				  syspath_node) {
+		if ((!seat || device->base.seat == seat) &&
+		    streq(udev_device_get_syspath(device->udev_device),
+			  syspath))
+			return device;
+	}
+
+	return NULL;
+}
+
+struct evdev_device *
+evdev_pair_class_find(struct libinput_seat *seat,
+		      enum evdev_pair_class class,
+		      struct evdev_device *except)
+{
+	struct evdev_pair_node *node;
+	unsigned int i = ffs(class) - 1;
+
+	assert(i < SEAT_PAIR_CLASS_COUNT);
+
+	list_for_each(node, &seat->pair_class_index[i], link) {
+		if (node->device != except)
+			return node->device;
+	}
+
+	return NULL;
+}
+
+static void
+evdev_pair_device_added(struct evdev_device *device,
+			struct evdev_device *added_device)
+{
+	if (device->dispatch->interface->device_added)
+		device->dispatch->interface->device_added(device,
+							  added_device);
+}
+
+static void
+evdev_pair_device_existing(struct evdev_device *device,
+			   struct evdev_device *d)
+{
+	evdev_pair_device_added(device, d);
+
+	/* Notify new device if existing device d is suspended */
+	if (d->is_suspended &&
+	    device->dispatch->interface->device_suspended)
+		device->dispatch->interface->device_suspended(device, d);
+}
+
+static void
+evdev_pair_device_removed(struct evdev_device *device,
+			  struct evdev_device *removed_device)
+{
+	if (device->dispatch->interface->device_removed)
+		device->dispatch->interface->device_removed(device,
+							    removed_device);
+}
+
+static void
+evdev_pair_device_suspended(struct evdev_device *device,
+			    struct evdev_device *suspended_device)
+{
+	if (device->dispatch->interface->device_suspended)
+		device->dispatch->interface->device_suspended(device,
+							      suspended_device);
+}
+
+static void
+evdev_pair_device_resumed(struct evdev_device *device,
+			  struct evdev_device *resumed_device)
+{
+	if (device->dispatch->interface->device_resumed)
+		device->dispatch->interface->device_resumed(device,
+							    resumed_device);
+}
+
+void
+evdev_notify_added_device(struct evdev_device *device)
+{
+	evdev_pair_index_add(device);
+
+	/* Notify existing devices about addition of device */
+	evdev_pair_notify_peers(device, evdev_pair_device_added);
+
+	/* Notify new device about existing devices */
+	evdev_pair_notify_self(device, evdev_pair_device_existing);
 
 	notify_added_device(&device->base);
 
@@ -2053,7 +2535,6 @@ evdev_drain_fd(int fd)
 static inline void
 evdev_pre_configure_model_quirks(struct evdev_device *device)
 {
-	struct quirks_context *quirks;
 	struct quirks *q;
 	const struct quirk_tuples *t;
 	const uint32_t *props = NULL;
@@ -2068,8 +2549,8 @@ evdev_pre_configure_model_quirks(struct evdev_device *device)
 	/* Generally we don't care about MSC_TIMESTAMP and it can cause
 	 * unnecessary wakeups but on some devices we need to watch it for
 	 * pointer jumps */
-	quirks = evdev_libinput_context(device)->quirks;
-	q = quirks_fetch_for_device(quirks, device->udev_device);
+	q = libinput_fetch_quirks(evdev_libinput_context(device),
+				  device->udev_device);
 	if (!q ||
 	    !quirks_get_string(q, QUIRK_ATTR_MSC_TIMESTAMP, &prop) ||
 	    !streq(prop, "watch")) {
@@ -2188,7 +2669,16 @@ libevdev_log_func(const struct libevdev *evdev,
 
 	snprintf(fmt, sizeof(fmt), "%s%s", prefix, format);
 
-	log_msg_va(libinput, pri, fmt, args);
+	/* fmt is on our stack, the log ring needs its own copy */
+	if (log_ring_is_enabled(&libinput->log_ring)) {
+		va_list copy;
+
+		va_copy(copy, args);
+		log_msg_record(libinput, pri, NULL, fmt, true, copy);
+		va_end(copy);
+	}
+
+	log_msg_va_unrecorded(libinput, pri, fmt, args);
 }
 
 static bool
@@ -2203,8 +2693,8 @@ udev_device_should_be_ignored(struct udev_device *udev_device)
 }
 
 struct evdev_device *
-evdev_device_create(struct libinput_seat *seat,
-		    struct udev_device *udev_device)
+evdev_device_probe(struct libinput_seat *seat,
+		   struct udev_device *udev_device)
 {
 	struct libinput *libinput = seat->libinput;
 	struct evdev_device *device = NULL;
@@ -2261,6 +2751,7 @@ evdev_device_create(struct libinput_seat *seat,
 	device->is_mt = 0;
 	device->mtdev = NULL;
 	device->udev_device = udev_device_ref(udev_device);
+	device->inject.slot = libevdev_get_current_slot(device->evdev);
 	device->dispatch = NULL;
 	device->fd = fd;
 	device->devname = libevdev_get_name(device->evdev);
@@ -2289,17 +2780,16 @@ evdev_device_create(struct libinput_seat *seat,
 	if (device->dispatch == NULL || device->seat_caps == 0)
 		goto err;
 
-	device->source =
-		libinput_add_fd(libinput, fd, evdev_device_dispatch, device);
-	if (!device->source)
+	if (evdev_device_add_source(device, fd) != 0)
 		goto err;
 
 	if (!evdev_set_device_group(device, udev_device))
 		goto err;
 
 	list_insert(seat->devices_list.prev, &device->base.link);
-
-	evdev_notify_added_device(device);
+	hash_table_insert(&libinput->device_syspath_index,
+			  &device->syspath_node,
+			  hash_string(udev_device_get_syspath(udev_device)));
 
 	return device;
 
@@ -2313,6 +2803,19 @@ err:
 	return unhandled_device ? EVDEV_UNHANDLED_DEVICE :  NULL;
 }
 
+struct evdev_device *
+evdev_device_create(struct libinput_seat *seat,
+		    struct udev_device *udev_device)
+{
+	struct evdev_device *device;
+
+	device = evdev_device_probe(seat, udev_device);
+	if (device && device != EVDEV_UNHANDLED_DEVICE)
+		evdev_notify_added_device(device);
+
+	return device;
+}
+
 const char *
 evdev_device_get_output(struct evdev_device *device)
 {
@@ -2724,19 +3227,10 @@ evdev_stop_scroll(struct evdev_device *device,
 void
 evdev_notify_suspended_device(struct evdev_device *device)
 {
-	struct libinput_device *it;
-
 	if (device->is_suspended)
 		return;
 
-	list_for_each(it, &device->base.seat->devices_list, link) {
-		struct evdev_device *d = evdev_device(it);
-		if (it == &device->base)
-			continue;
-
-		if (d->dispatch->interface->device_suspended)
-			d->dispatch->interface->device_suspended(d, device);
-	}
+	evdev_pair_notify_peers(device, evdev_pair_device_suspended);
 
 	device->is_suspended = true;
 }
@@ -2744,19 +3238,10 @@ evdev_notify_suspended_device(struct evdev_device *device)
 void
 evdev_notify_resumed_device(struct evdev_device *device)
 {
-	struct libinput_device *it;
-
 	if (!device->is_suspended)
 		return;
 
-	list_for_each(it, &device->base.seat->devices_list, link) {
-		struct evdev_device *d = evdev_device(it);
-		if (it == &device->base)
-			continue;
-
-		if (d->dispatch->interface->device_resumed)
-			d->dispatch->interface->device_resumed(d, device);
-	}
+	evdev_pair_notify_peers(device, evdev_pair_device_resumed);
 
 	device->is_suspended = false;
 }
@@ -2772,10 +3257,7 @@ evdev_device_suspend(struct evdev_device *device)
 		device->dispatch->interface->suspend(device->dispatch,
 						     device);
 
-	if (device->source) {
-		libinput_remove_source(libinput, device->source);
-		device->source = NULL;
-	}
+	evdev_device_remove_source(device);
 
 	if (device->mtdev) {
 		mtdev_close_delete(device->mtdev);
@@ -2842,9 +3324,7 @@ evdev_device_resume(struct evdev_device *device)
 					     &ev);
 	} while (status == LIBEVDEV_READ_STATUS_SYNC);
 
-	device->source =
-		libinput_add_fd(libinput, fd, evdev_device_dispatch, device);
-	if (!device->source) {
+	if (evdev_device_add_source(device, fd) != 0) {
 		mtdev_close_delete(device->mtdev);
 		return -ENOMEM;
 	}
@@ -2857,21 +3337,12 @@ evdev_device_resume(struct evdev_device *device)
 void
 evdev_device_remove(struct evdev_device *device)
 {
-	struct libinput_device *dev;
-
 	evdev_log_info(device, "device removed\n");
 
 	libinput_timer_cancel(&device->scroll.timer);
 	libinput_timer_cancel(&device->middlebutton.timer);
 
-	list_for_each(dev, &device->base.seat->devices_list, link) {
-		struct evdev_device *d = evdev_device(dev);
-		if (dev == &device->base)
-			continue;
-
-		if (d->dispatch->interface->device_removed)
-			d->dispatch->interface->device_removed(d, device);
-	}
+	evdev_pair_notify_peers(device, evdev_pair_device_removed);
 
 	evdev_device_suspend(device);
 
@@ -2882,6 +3353,8 @@ evdev_device_remove(struct evdev_device *device)
 	 * skip re-opening a different device with the same node */
 	device->was_removed = true;
 
+	evdev_pair_index_remove(device);
+	hash_node_remove(&device->syspath_node);
 	list_remove(&device->base.link);
 
 	notify_removed_device(&device->base);
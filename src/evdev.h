@@ -76,6 +76,24 @@ enum evdev_device_tags {
 	EVDEV_TAG_TABLET_TOUCHPAD	= bit(9),
 };
 
+/* Classes a device may be paired on, see
+ * evdev_dispatch_interface.pairs_with */
+enum evdev_pair_class {
+	EVDEV_PAIR_KEYBOARD		= bit(0),
+	EVDEV_PAIR_TRACKPOINT		= bit(1),
+	EVDEV_PAIR_EXTERNAL_MOUSE	= bit(2),
+	EVDEV_PAIR_EXTERNAL_TOUCHPAD	= bit(3),
+	EVDEV_PAIR_LID_SWITCH		= bit(4),
+	EVDEV_PAIR_TABLET_MODE_SWITCH	= bit(5),
+	EVDEV_PAIR_TABLET		= bit(6),
+	EVDEV_PAIR_TOUCH		= bit(7),
+};
+
+struct evdev_pair_node {
+	struct list link;
+	struct evdev_device *device;
+};
+
 enum evdev_middlebutton_state {
 	MIDDLEBUTTON_IDLE,
 	MIDDLEBUTTON_LEFT_DOWN,
@@ -159,20 +177,35 @@ enum evdev_arbitration_state {
 	ARBITRATION_IGNORE_RECT,
 };
 
+#define EVDEV_NUM_STAGES (LIBINPUT_STAGE_FILTER_DISPATCH + 1)
+
+struct evdev_uring_reader;
+
 struct evdev_device {
 	struct libinput_device base;
 
 	struct libinput_source *source;
+	/* set instead of source if the fd is read through io_uring */
+	struct evdev_uring_reader *uring_reader;
 
 	struct evdev_dispatch *dispatch;
 	struct libevdev *evdev;
 	struct udev_device *udev_device;
+	struct hash_node syspath_node; /* libinput.device_syspath_index */
 	char *output_name;
 	const char *devname;
 	bool was_removed;
+	bool warm_suspended; /* fd closed by a warm libinput_suspend() */
 	int fd;
 	enum evdev_device_seat_capability seat_caps;
 	enum evdev_device_tags tags;
+
+	struct {
+		uint32_t classes; /* enum evdev_pair_class */
+		uint32_t peers; /* enum evdev_pair_class */
+		struct evdev_pair_node class_nodes[SEAT_PAIR_CLASS_COUNT];
+		struct evdev_pair_node peer_nodes[SEAT_PAIR_CLASS_COUNT];
+	} pairing;
 	bool is_mt;
 	bool is_suspended;
 	int dpi; /* HW resolution */
@@ -184,6 +217,19 @@ struct evdev_device {
 	uint32_t model_flags;
 	struct mtdev *mtdev;
 
+	/* kernel-like filter state for evdev_device_inject_event() */
+	struct {
+		int slot; /* last ABS_MT_SLOT value injected */
+		unsigned int nevents; /* events injected since SYN_REPORT */
+	} inject;
+
+	/* see libinput_enable_stage_counters() */
+	struct evdev_stage_counter {
+		uint64_t count;
+		uint64_t nsec;
+		uint64_t cycles;
+	} stage_counters[EVDEV_NUM_STAGES];
+
 	struct {
 		const struct input_absinfo *absinfo_x, *absinfo_y;
 		bool is_fake_resolution;
@@ -298,6 +344,11 @@ struct evdev_dispatch_interface {
 	/* Destroy an event dispatch handler and free all its resources. */
 	void (*destroy)(struct evdev_dispatch *dispatch);
 
+	/* Return the mask of enum evdev_pair_class this device pairs
+	 * with. device_added, device_removed, device_suspended and
+	 * device_resumed are only called for devices of those classes. */
+	uint32_t (*pairs_with)(struct evdev_device *device);
+
 	/* A new device was added */
 	void (*device_added)(struct evdev_device *device,
 			     struct evdev_device *added_device);
@@ -377,12 +428,104 @@ struct evdev_device *
 evdev_device_create(struct libinput_seat *seat,
 		    struct udev_device *device);
 
+/* Like evdev_device_create() but the device is not paired with other
+ * devices and no LIBINPUT_EVENT_DEVICE_ADDED is sent until the caller
+ * calls evdev_notify_added_device() */
+struct evdev_device *
+evdev_device_probe(struct libinput_seat *seat,
+		   struct udev_device *device);
+
+void
+evdev_notify_added_device(struct evdev_device *device);
+
 static inline struct libinput *
 evdev_libinput_context(const struct evdev_device *device)
 {
 	return device->base.seat->libinput;
 }
 
+/* Start timestamp of a stage, see evdev_stage_begin() */
+struct evdev_stage_timer {
+	bool active;
+	uint64_t nsec;
+	uint64_t cycles;
+};
+
+static inline uint64_t
+evdev_stage_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static inline uint64_t
+evdev_stage_nsec(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+		return 0;
+
+	return s2us(ts.tv_sec) * 1000 + ts.tv_nsec;
+}
+
+/**
+ * Start measuring a processing stage. This is a noop unless the stage
+ * counters are enabled, the matching evdev_stage_end() adds the elapsed
+ * time to the device's counter for the given stage.
+ */
+static inline struct evdev_stage_timer
+evdev_stage_begin(struct evdev_device *device)
+{
+	struct evdev_stage_timer timer = { .active = false };
+
+	if (!evdev_libinput_context(device)->stage_counters_enabled)
+		return timer;
+
+	timer.active = true;
+	timer.cycles = evdev_stage_cycles();
+	timer.nsec = evdev_stage_nsec();
+
+	return timer;
+}
+
+static inline void
+evdev_stage_end(struct evdev_device *device,
+		enum libinput_stage stage,
+		struct evdev_stage_timer timer)
+{
+	struct evdev_stage_counter *counter;
+
+	if (!timer.active)
+		return;
+
+	counter = &device->stage_counters[stage];
+	counter->nsec += evdev_stage_nsec() - timer.nsec;
+	counter->cycles += evdev_stage_cycles() - timer.cycles;
+	counter->count++;
+}
+
+static inline struct normalized_coords
+evdev_filter_dispatch(struct evdev_device *device,
+		      const struct device_float_coords *unaccelerated,
+		      void *data,
+		      uint64_t time)
+{
+	struct evdev_stage_timer t = evdev_stage_begin(device);
+	struct normalized_coords accel;
+
+	accel = filter_dispatch(device->pointer.filter,
+				unaccelerated,
+				data,
+				time);
+	evdev_stage_end(device, LIBINPUT_STAGE_FILTER_DISPATCH, t);
+
+	return accel;
+}
+
 static inline bool
 evdev_device_has_model_quirk(struct evdev_device *device,
 			     enum quirk model_quirk)
@@ -460,6 +603,51 @@ evdev_need_mtdev(struct evdev_device *device);
 void
 evdev_device_led_update(struct evdev_device *device, enum libinput_led leds);
 
+int
+evdev_device_inject_event(struct evdev_device *device,
+			  unsigned int type,
+			  unsigned int code,
+			  int value);
+
+/* Process events read from the device fd by someone other than libevdev,
+ * see evdev-uring.c. Returns 0 or a negative errno if the device can no
+ * longer be read */
+int
+evdev_device_dispatch_events(struct evdev_device *device,
+			     struct input_event *events,
+			     size_t nevents);
+
+#if HAVE_IO_URING
+int
+evdev_uring_add_device(struct evdev_uring *uring,
+		       struct evdev_device *device,
+		       int fd);
+
+void
+evdev_uring_remove_device(struct evdev_device *device);
+#else
+static inline int
+evdev_uring_add_device(struct evdev_uring *uring,
+		       struct evdev_device *device,
+		       int fd)
+{
+	return -1;
+}
+
+static inline void
+evdev_uring_remove_device(struct evdev_device *device) {}
+#endif
+
+int
+evdev_device_get_stage_counters(struct evdev_device *device,
+				enum libinput_stage stage,
+				uint64_t *count,
+				uint64_t *nsec,
+				uint64_t *cycles);
+
+void
+evdev_device_reset_stage_counters(struct evdev_device *device);
+
 int
 evdev_device_get_keys(struct evdev_device *device, char *keys, size_t size);
 
@@ -552,6 +740,16 @@ evdev_device_resume(struct evdev_device *device);
 void
 evdev_notify_suspended_device(struct evdev_device *device);
 
+struct evdev_device *
+evdev_device_find_by_syspath(struct libinput *libinput,
+			     const char *syspath,
+			     struct libinput_seat *seat);
+
+struct evdev_device *
+evdev_pair_class_find(struct libinput_seat *seat,
+		      enum evdev_pair_class class,
+		      struct evdev_device *except);
+
 void
 evdev_notify_resumed_device(struct evdev_device *device);
 
@@ -759,10 +957,22 @@ evdev_log_msg(struct evdev_device *device,
 	      const char *format,
 	      ...)
 {
+	struct libinput *libinput = evdev_libinput_context(device);
 	va_list args;
 	char buf[1024];
 
-	if (!is_logged(evdev_libinput_context(device), priority))
+	if (log_ring_is_enabled(&libinput->log_ring)) {
+		va_start(args, format);
+		log_msg_record(libinput,
+			       priority,
+			       evdev_device_get_sysname(device),
+			       format,
+			       false,
+			       args);
+		va_end(args);
+	}
+
+	if (!is_logged(libinput, priority))
 		return;
 
 	/* Anything info and above is user-visible, use the device name */
@@ -775,7 +985,7 @@ evdev_log_msg(struct evdev_device *device,
 		 format);
 
 	va_start(args, format);
-	log_msg_va(evdev_libinput_context(device), priority, buf, args);
+	log_msg_va_unrecorded(libinput, priority, buf, args);
 	va_end(args);
 
 }
@@ -788,30 +998,46 @@ evdev_log_msg_ratelimit(struct evdev_device *device,
 			const char *format,
 			...)
 {
+	struct libinput *libinput = evdev_libinput_context(device);
 	va_list args;
 	char buf[1024];
 
 	enum ratelimit_state state;
 
-	if (!is_logged(evdev_libinput_context(device), priority))
+	if (!is_logged(libinput, priority) &&
+	    !log_ring_is_enabled(&libinput->log_ring))
 		return;
 
 	state = ratelimit_test(ratelimit);
 	if (state == RATELIMIT_EXCEEDED)
 		return;
 
-	/* Anything info and above is user-visible, use the device name */
-	snprintf(buf,
-		 sizeof(buf),
-		 "%-7s - %s%s%s",
-		 evdev_device_get_sysname(device),
-		 (priority > LIBINPUT_LOG_PRIORITY_DEBUG) ?  device->devname : "",
-		 (priority > LIBINPUT_LOG_PRIORITY_DEBUG) ?  ": " : "",
-		 format);
+	if (log_ring_is_enabled(&libinput->log_ring)) {
+		va_start(args, format);
+		log_msg_record(libinput,
+			       priority,
+			       evdev_device_get_sysname(device),
+			       format,
+			       false,
+			       args);
+		va_end(args);
+	}
 
-	va_start(args, format);
-	log_msg_va(evdev_libinput_context(device), priority, buf, args);
-	va_end(args);
+	if (is_logged(libinput, priority)) {
+		/* Anything info and above is user-visible, use the device
+		 * name */
+		snprintf(buf,
+			 sizeof(buf),
+			 "%-7s - %s%s%s",
+			 evdev_device_get_sysname(device),
+			 (priority > LIBINPUT_LOG_PRIORITY_DEBUG) ?  device->devname : "",
+			 (priority > LIBINPUT_LOG_PRIORITY_DEBUG) ?  ": " : "",
+			 format);
+
+		va_start(args, format);
+		log_msg_va_unrecorded(libinput, priority, buf, args);
+		va_end(args);
+	}
 
 	if (state == RATELIMIT_THRESHOLD) {
 		struct human_time ht = to_human_time(ratelimit->interval);
@@ -33,6 +33,7 @@
 
 #include "filter.h"
 #include "libinput-util.h"
+#include "util-trace.h"
 #include "filter-private.h"
 
 #define MOTION_TIMEOUT		ms2us(1000)
@@ -42,6 +43,8 @@ filter_dispatch(struct motion_filter *filter,
 		const struct device_float_coords *unaccelerated,
 		void *data, uint64_t time)
 {
+	trace_probe(filter_dispatch, filter, filter->interface->type, time);
+
 	return filter->interface->filter(filter, unaccelerated, data, time);
 }
 
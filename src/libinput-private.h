@@ -42,6 +42,9 @@
 #include "libinput-version.h"
 
 struct libinput_source;
+struct quirks;
+struct evdev_uring;
+struct event_export_ring;
 
 /* A coordinate pair in device coordinates */
 struct device_coords {
@@ -119,9 +122,35 @@ struct libinput_interface_backend {
 				  const char *seat_name);
 };
 
-struct libinput {
+#define EVENT_MASK_BITS 1000
+#define SEAT_PAIR_CLASS_COUNT 8
+
+/* An epoll set and timerfd shared by several contexts, see
+ * libinput_attach_loop() */
+struct libinput_loop {
+	int refcount;
 	int epoll_fd;
+	struct list contexts; /* struct libinput.loop_link */
+
+	struct {
+		struct libinput_source *source;
+		int fd;
+		/* CLOCK_MONOTONIC expiry the timerfd is armed for,
+		 * UINT64_MAX if disarmed */
+		uint64_t armed_expiry;
+		bool dispatching;
+	} timer;
+};
+
+struct libinput {
+	int epoll_fd; /* owned by the loop if attached to one */
+	struct list source_list;
 	struct list source_destroy_list;
+	size_t nsources;
+	libinput_source_handler source_handler;
+
+	struct libinput_loop *loop;
+	struct list loop_link;
 
 	struct list seat_list;
 
@@ -129,9 +158,18 @@ struct libinput {
 		struct list list;
 		struct libinput_source *source;
 		int fd;
+		/* lower bound of the earliest timer expiry */
 		uint64_t next_expiry;
+		/* expiry the timerfd is armed for, UINT64_MAX if disarmed */
+		uint64_t armed_expiry;
+		bool dispatching;
 	} timer;
 
+	struct {
+		/* in us, added to CLOCK_MONOTONIC, see libinput_clock_advance() */
+		uint64_t offset;
+	} clock;
+
 	struct libinput_event **events;
 	size_t events_count;
 	size_t events_len;
@@ -145,16 +183,38 @@ struct libinput {
 
 	libinput_log_handler log_handler;
 	enum libinput_log_priority log_priority;
+	struct log_ring log_ring;
+	bool stage_counters_enabled;
+	bool tablet_tool_history_enabled;
+	bool touch_frame_aggregation_enabled;
+	bool motion_prediction_enabled;
+	bool warm_suspend_enabled;
+	bool io_uring_enabled;
+	struct evdev_uring *uring; /* see libinput_enable_io_uring() */
+	struct event_export_ring *export_ring; /* see libinput_enable_event_export() */
+	uint32_t last_device_export_id;
+
+	/* indexed by enum libinput_event_type, see libinput_set_event_mask() */
+	unsigned long event_mask[NLONGS(EVENT_MASK_BITS)];
 	void *user_data;
 	int refcount;
 
 	struct list device_group_list;
 
+	/* Lookup indices, maintained alongside the lists above.
+	 * device_syspath_index holds struct evdev_device by syspath,
+	 * device_group_index the groups by identifier and tool_index the
+	 * tools of tool_list by type and serial */
+	struct hash_table device_syspath_index;
+	struct hash_table device_group_index;
+	struct hash_table tool_index;
+
 	uint64_t last_event_time;
 	uint64_t dispatch_time;
 
 	bool quirks_initialized;
 	struct quirks_context *quirks;
+	struct libinput_shared_data *shared_data;
 
 #if HAVE_LIBWACOM
 	struct {
@@ -180,6 +240,13 @@ struct libinput_seat {
 	uint32_t slot_map;
 
 	uint32_t button_count[KEY_CNT];
+
+	/* Devices by pairing class, indexed by the bit number of
+	 * enum evdev_pair_class. pair_class_index holds the devices that
+	 * are of that class, pair_peer_index the devices that pair
+	 * with that class. */
+	struct list pair_class_index[SEAT_PAIR_CLASS_COUNT];
+	struct list pair_peer_index[SEAT_PAIR_CLASS_COUNT];
 };
 
 struct libinput_device_config_tap {
@@ -203,6 +270,16 @@ struct libinput_device_config_tap {
 							    enum libinput_config_drag_lock_state);
 	enum libinput_config_drag_lock_state (*get_draglock_enabled)(struct libinput_device *device);
 	enum libinput_config_drag_lock_state (*get_default_draglock_enabled)(struct libinput_device *device);
+
+	enum libinput_config_status (*set_adaptive_timeout_enabled)(struct libinput_device *device,
+								    enum libinput_config_tap_adaptive_timeout_state);
+	enum libinput_config_tap_adaptive_timeout_state (*get_adaptive_timeout_enabled)(struct libinput_device *device);
+	enum libinput_config_tap_adaptive_timeout_state (*get_default_adaptive_timeout_enabled)(struct libinput_device *device);
+	void (*get_timeout_stats)(struct libinput_device *device,
+				  uint64_t *timeout_usec,
+				  uint64_t *ntaps,
+				  uint64_t *saved_usec,
+				  uint64_t *nsplit);
 };
 
 struct libinput_device_config_calibration {
@@ -307,6 +384,40 @@ struct libinput_device_config_rotation {
 	unsigned int (*get_default_angle)(struct libinput_device *device);
 };
 
+struct libinput_device_config_passthrough {
+	int (*is_available)(struct libinput_device *device);
+	enum libinput_config_status (*set_enabled)(
+			 struct libinput_device *device,
+			 enum libinput_config_passthrough_state enable);
+	enum libinput_config_passthrough_state (*get_enabled)(
+			 struct libinput_device *device);
+	enum libinput_config_passthrough_state (*get_default_enabled)(
+			 struct libinput_device *device);
+};
+
+struct libinput_device_config_gesture_low_latency {
+	int (*is_available)(struct libinput_device *device);
+	enum libinput_config_status (*set_enabled)(
+			 struct libinput_device *device,
+			 enum libinput_config_gesture_low_latency_state enable);
+	enum libinput_config_gesture_low_latency_state (*get_enabled)(
+			 struct libinput_device *device);
+	enum libinput_config_gesture_low_latency_state (*get_default_enabled)(
+			 struct libinput_device *device);
+};
+
+struct libinput_device_config_tablet_smoothing {
+	uint32_t (*get_methods)(struct libinput_device *device);
+	enum libinput_config_status (*set_method)(struct libinput_device *device,
+						  enum libinput_config_tablet_smoothing_method method);
+	enum libinput_config_tablet_smoothing_method (*get_method)(struct libinput_device *device);
+	enum libinput_config_tablet_smoothing_method (*get_default_method)(struct libinput_device *device);
+	enum libinput_config_status (*set_responsiveness)(struct libinput_device *device,
+							  double responsiveness);
+	double (*get_responsiveness)(struct libinput_device *device);
+	double (*get_default_responsiveness)(struct libinput_device *device);
+};
+
 struct libinput_device_config {
 	struct libinput_device_config_tap *tap;
 	struct libinput_device_config_calibration *calibration;
@@ -319,6 +430,9 @@ struct libinput_device_config {
 	struct libinput_device_config_middle_emulation *middle_emulation;
 	struct libinput_device_config_dwt *dwt;
 	struct libinput_device_config_rotation *rotation;
+	struct libinput_device_config_passthrough *passthrough;
+	struct libinput_device_config_tablet_smoothing *tablet_smoothing;
+	struct libinput_device_config_gesture_low_latency *gesture_low_latency;
 };
 
 struct libinput_device_group {
@@ -327,6 +441,14 @@ struct libinput_device_group {
 	char *identifier; /* unique identifier or NULL for singletons */
 
 	struct list link;
+	struct hash_node index_node;
+};
+
+struct touch_frame_slot {
+	enum libinput_event_type type;
+	int32_t slot;
+	int32_t seat_slot;
+	struct device_coords point;
 };
 
 struct libinput_device {
@@ -336,7 +458,22 @@ struct libinput_device {
 	struct list event_listeners;
 	void *user_data;
 	int refcount;
+	uint32_t export_id; /* see libinput_event_export_record */
 	struct libinput_device_config config;
+
+	/* slots changed in the current touch frame, see
+	 * libinput_enable_touch_frame_aggregation() */
+	struct {
+		struct touch_frame_slot *slots;
+		size_t count;
+		size_t size;
+	} touch_frame;
+
+	/* indexed by slot, see libinput_enable_motion_prediction() */
+	struct {
+		struct predictor *predictors;
+		size_t npredictors;
+	} prediction;
 };
 
 enum libinput_tablet_tool_axis {
@@ -370,6 +507,7 @@ struct tablet_axes {
 
 struct libinput_tablet_tool {
 	struct list link;
+	struct hash_node index_node; /* only for tools in libinput.tool_list */
 	uint32_t serial;
 	uint32_t tool_id;
 	enum libinput_tablet_tool_type type;
@@ -462,6 +600,27 @@ log_msg_va(struct libinput *libinput,
 	   va_list args)
 	LIBINPUT_ATTRIBUTE_PRINTF(3, 0);
 
+/* Records a message in the log ring (if enabled) without passing it to
+ * the log handler, prefix may be NULL. Formats that do not outlive the
+ * ring, e.g. built on the stack, must set copy_format */
+void
+log_msg_record(struct libinput *libinput,
+	       enum libinput_log_priority priority,
+	       const char *prefix,
+	       const char *format,
+	       bool copy_format,
+	       va_list args)
+	LIBINPUT_ATTRIBUTE_PRINTF(4, 0);
+
+/* Passes a message to the log handler without recording it in the log
+ * ring */
+void
+log_msg_va_unrecorded(struct libinput *libinput,
+		      enum libinput_log_priority priority,
+		      const char *format,
+		      va_list args)
+	LIBINPUT_ATTRIBUTE_PRINTF(3, 0);
+
 int
 libinput_init(struct libinput *libinput,
 	      const struct libinput_interface *interface,
@@ -471,6 +630,12 @@ libinput_init(struct libinput *libinput,
 void
 libinput_init_quirks(struct libinput *libinput);
 
+/* Use this instead of quirks_fetch_for_device(), a shared quirks context
+ * must log through the context fetching the quirks */
+struct quirks *
+libinput_fetch_quirks(struct libinput *libinput,
+		      struct udev_device *udev_device);
+
 struct libinput_source *
 libinput_add_fd(struct libinput *libinput,
 		int fd,
@@ -481,6 +646,16 @@ void
 libinput_remove_source(struct libinput *libinput,
 		       struct libinput_source *source);
 
+struct libinput_source *
+libinput_loop_add_fd(struct libinput_loop *loop,
+		     int fd,
+		     libinput_source_dispatch_t dispatch,
+		     void *data);
+
+void
+libinput_loop_remove_source(struct libinput_loop *loop,
+			    struct libinput_source *source);
+
 int
 open_restricted(struct libinput *libinput,
 		const char *path, int flags);
@@ -510,6 +685,15 @@ struct libinput_device_group *
 libinput_device_group_find_group(struct libinput *libinput,
 				 const char *identifier);
 
+struct libinput_tablet_tool *
+libinput_tablet_tool_find(struct libinput *libinput,
+			  enum libinput_tablet_tool_type type,
+			  uint32_t serial);
+
+void
+libinput_tablet_tool_add(struct libinput *libinput,
+			 struct libinput_tablet_tool *tool);
+
 void
 libinput_device_set_device_group(struct libinput_device *device,
 				 struct libinput_device_group *group);
@@ -701,7 +885,7 @@ libinput_now(struct libinput *libinput)
 		return 0;
 	}
 
-	return s2us(ts.tv_sec) + ns2us(ts.tv_nsec);
+	return s2us(ts.tv_sec) + ns2us(ts.tv_nsec) + libinput->clock.offset;
 }
 
 static inline struct device_float_coords
@@ -859,6 +1043,16 @@ point_in_rect(const struct device_coords *point,
 		point->y < rect->y + rect->h);
 }
 
+#if HAVE_IO_URING
+struct evdev_uring *
+evdev_uring_new(struct libinput *libinput);
+void
+evdev_uring_destroy(struct evdev_uring *uring);
+#else
+static inline struct evdev_uring *evdev_uring_new(struct libinput *libinput) { return NULL; }
+static inline void evdev_uring_destroy(struct evdev_uring *uring) {}
+#endif
+
 #if HAVE_LIBWACOM
 WacomDeviceDatabase *
 libinput_libwacom_ref(struct libinput *li);
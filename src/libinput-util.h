@@ -35,9 +35,12 @@
 #include "libinput.h"
 
 #include "util-bits.h"
+#include "util-hash.h"
 #include "util-macros.h"
 #include "util-list.h"
+#include "util-log-ring.h"
 #include "util-matrix.h"
+#include "util-prediction.h"
 #include "util-strings.h"
 #include "util-ratelimit.h"
 #include "util-prop-parsers.h"
@@ -31,14 +31,19 @@
 #include <stdarg.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <assert.h>
 
 #include "libinput.h"
 #include "libinput-private.h"
+#include "libinput-test-hooks.h"
 #include "evdev.h"
 #include "timer.h"
 #include "quirks.h"
+#include "util-trace.h"
 
 #define require_event_type(li_, type_, retval_, ...)	\
 	if (type_ == LIBINPUT_EVENT_NONE) abort(); \
@@ -69,12 +74,16 @@ ASSERT_INT_SIZE(enum libinput_config_tap_state);
 ASSERT_INT_SIZE(enum libinput_config_tap_button_map);
 ASSERT_INT_SIZE(enum libinput_config_drag_state);
 ASSERT_INT_SIZE(enum libinput_config_drag_lock_state);
+ASSERT_INT_SIZE(enum libinput_config_tap_adaptive_timeout_state);
 ASSERT_INT_SIZE(enum libinput_config_send_events_mode);
 ASSERT_INT_SIZE(enum libinput_config_accel_profile);
 ASSERT_INT_SIZE(enum libinput_config_click_method);
 ASSERT_INT_SIZE(enum libinput_config_middle_emulation_state);
 ASSERT_INT_SIZE(enum libinput_config_scroll_method);
 ASSERT_INT_SIZE(enum libinput_config_dwt_state);
+ASSERT_INT_SIZE(enum libinput_config_passthrough_state);
+ASSERT_INT_SIZE(enum libinput_config_tablet_smoothing_method);
+ASSERT_INT_SIZE(enum libinput_config_gesture_low_latency_state);
 
 static inline const char *
 event_type_to_str(enum libinput_event_type type)
@@ -186,6 +195,11 @@ struct libinput_event_touch {
 	int32_t slot;
 	int32_t seat_slot;
 	struct device_coords point;
+	struct prediction prediction;
+
+	/* TOUCH_FRAME only, see libinput_enable_touch_frame_aggregation() */
+	unsigned int nframe_slots;
+	struct touch_frame_slot frame_slots[];
 };
 
 struct libinput_event_gesture {
@@ -199,6 +213,17 @@ struct libinput_event_gesture {
 	double angle;
 };
 
+/* Upper limit of historical samples per axis event, once reached a new
+ * event is queued */
+#define TABLET_TOOL_HISTORY_MAX 32
+
+struct tablet_tool_sample {
+	uint64_t time;
+	struct device_coords point;
+	double pressure;
+	struct tilt_degrees tilt;
+};
+
 struct libinput_event_tablet_tool {
 	struct libinput_event base;
 	uint32_t button;
@@ -210,6 +235,11 @@ struct libinput_event_tablet_tool {
 	struct libinput_tablet_tool *tool;
 	enum libinput_tablet_tool_proximity_state proximity_state;
 	enum libinput_tablet_tool_tip_state tip_state;
+	struct prediction prediction;
+
+	/* see libinput_enable_tablet_tool_history() */
+	struct tablet_tool_sample *history;
+	unsigned int history_size;
 };
 
 struct libinput_event_tablet_pad {
@@ -244,6 +274,336 @@ struct libinput_event_switch {
 	enum libinput_switch_state state;
 };
 
+/* The event's timestamp in µs, or 0 for device notify events */
+static uint64_t
+event_get_time(struct libinput_event *event)
+{
+	switch (event->type) {
+	case LIBINPUT_EVENT_NONE:
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		return 0;
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		return ((struct libinput_event_keyboard *)event)->time;
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+		return ((struct libinput_event_pointer *)event)->time;
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		return ((struct libinput_event_touch *)event)->time;
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		return ((struct libinput_event_tablet_tool *)event)->time;
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+	case LIBINPUT_EVENT_TABLET_PAD_KEY:
+		return ((struct libinput_event_tablet_pad *)event)->time;
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+		return ((struct libinput_event_gesture *)event)->time;
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		return ((struct libinput_event_switch *)event)->time;
+	}
+
+	return 0;
+}
+
+/* Shared memory layout of the event export ring, see
+ * libinput_enable_event_export(). Only libinput reads and writes this
+ * layout, observers use the libinput_event_export_reader API */
+#define EVENT_EXPORT_MAGIC 0x78456c4c /* "LlEx" */
+#define EVENT_EXPORT_VERSION 1
+
+struct event_export_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slot_size;
+	uint32_t nslots; /* power of two */
+	/* sequence number of the next record, published by libinput */
+	uint64_t write_seq;
+	uint64_t padding[5]; /* one cache line */
+};
+
+struct event_export_slot {
+	/* sequence number + 1 of the record in this slot, 0 while the
+	 * slot is being written */
+	uint64_t seq;
+	struct libinput_event_export_record record;
+};
+
+/* nslots and write_seq are only published in the header, the writer
+ * never trusts the shared memory for them */
+struct event_export_ring {
+	int fd; /* read-only, handed to observers */
+	size_t size;
+	uint32_t nslots;
+	uint64_t write_seq;
+	struct event_export_header *header;
+	struct event_export_slot *slots;
+};
+
+struct libinput_event_export_reader {
+	size_t size;
+	uint32_t nslots; /* validated in libinput_event_export_reader_new() */
+	const struct event_export_header *header;
+	const struct event_export_slot *slots;
+	uint64_t next_seq;
+	uint64_t overflow_count;
+};
+
+static inline size_t
+event_export_ring_size(uint32_t nslots)
+{
+	return sizeof(struct event_export_header) +
+		nslots * sizeof(struct event_export_slot);
+}
+
+static void
+event_export_ring_destroy(struct event_export_ring *ring)
+{
+	if (!ring)
+		return;
+
+	munmap(ring->header, ring->size);
+	close(ring->fd);
+	free(ring);
+}
+
+static struct event_export_ring *
+event_export_ring_new(uint32_t nslots)
+{
+	struct event_export_ring *ring;
+	char path[64];
+	void *ptr = MAP_FAILED;
+	int fd;
+
+	ring = zalloc(sizeof(*ring));
+	ring->size = event_export_ring_size(nslots);
+	ring->nslots = nslots;
+	fd = memfd_create("libinput-events", MFD_CLOEXEC|MFD_ALLOW_SEALING);
+	if (fd < 0)
+		goto error;
+
+	/* Observers map the whole ring, it must never shrink under them */
+	if (ftruncate(fd, ring->size) < 0 ||
+	    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK|F_SEAL_GROW) < 0)
+		goto error;
+
+	ptr = mmap(NULL, ring->size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED)
+		goto error;
+
+	/* Our mapping stays writable, nobody else may write. An O_RDONLY
+	 * fd alone can be reopened read-write through /proc, the future
+	 * write seal prevents that where the kernel supports it */
+#ifdef F_SEAL_FUTURE_WRITE
+	if (fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE) < 0 && errno != EINVAL)
+		goto error;
+#endif
+	if (fcntl(fd, F_ADD_SEALS, F_SEAL_SEAL) < 0)
+		goto error;
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+	ring->fd = open(path, O_RDONLY|O_CLOEXEC);
+	if (ring->fd < 0)
+		goto error;
+	close(fd);
+
+	ring->header = ptr;
+	ring->slots = (struct event_export_slot *)(ring->header + 1);
+	ring->header->magic = EVENT_EXPORT_MAGIC;
+	ring->header->version = EVENT_EXPORT_VERSION;
+	ring->header->slot_size = sizeof(struct event_export_slot);
+	ring->header->nslots = nslots;
+
+	return ring;
+
+error:
+	if (ptr != MAP_FAILED)
+		munmap(ptr, ring->size);
+	if (fd >= 0)
+		close(fd);
+	free(ring);
+	return NULL;
+}
+
+static void
+event_export_fill_record(struct libinput *libinput,
+			 struct libinput_event *event,
+			 struct libinput_event_export_record *record)
+{
+	struct evdev_device *device = evdev_device(event->device);
+
+	record->type = event->type;
+	record->device_id = event->device->export_id;
+	record->time_usec = event_get_time(event);
+
+	switch (event->type) {
+	case LIBINPUT_EVENT_NONE:
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		record->time_usec = libinput_now(libinput);
+		break;
+	case LIBINPUT_EVENT_KEYBOARD_KEY: {
+		struct libinput_event_keyboard *e =
+			(struct libinput_event_keyboard *)event;
+		record->code = e->key;
+		record->state = e->state;
+		break;
+	}
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS: {
+		struct libinput_event_pointer *e =
+			(struct libinput_event_pointer *)event;
+		if (event->type == LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE) {
+			record->x = evdev_convert_to_mm(device->abs.absinfo_x,
+							e->absolute.x);
+			record->y = evdev_convert_to_mm(device->abs.absinfo_y,
+							e->absolute.y);
+		} else if (event->type == LIBINPUT_EVENT_POINTER_BUTTON) {
+			record->code = e->button;
+			record->state = e->state;
+		} else {
+			record->code = e->source;
+			record->x = e->delta.x;
+			record->y = e->delta.y;
+		}
+		break;
+	}
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME: {
+		struct libinput_event_touch *e =
+			(struct libinput_event_touch *)event;
+		record->code = e->seat_slot;
+		if (event->type == LIBINPUT_EVENT_TOUCH_DOWN ||
+		    event->type == LIBINPUT_EVENT_TOUCH_MOTION) {
+			record->x = evdev_convert_to_mm(device->abs.absinfo_x,
+							e->point.x);
+			record->y = evdev_convert_to_mm(device->abs.absinfo_y,
+							e->point.y);
+		}
+		break;
+	}
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON: {
+		struct libinput_event_tablet_tool *e =
+			(struct libinput_event_tablet_tool *)event;
+		record->x = evdev_convert_to_mm(device->abs.absinfo_x,
+						e->axes.point.x);
+		record->y = evdev_convert_to_mm(device->abs.absinfo_y,
+						e->axes.point.y);
+		if (event->type == LIBINPUT_EVENT_TABLET_TOOL_BUTTON) {
+			record->code = e->button;
+			record->state = e->state;
+		} else if (event->type == LIBINPUT_EVENT_TABLET_TOOL_TIP) {
+			record->state = e->tip_state;
+		} else if (event->type == LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY) {
+			record->state = e->proximity_state;
+		}
+		break;
+	}
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+	case LIBINPUT_EVENT_TABLET_PAD_KEY: {
+		struct libinput_event_tablet_pad *e =
+			(struct libinput_event_tablet_pad *)event;
+		if (event->type == LIBINPUT_EVENT_TABLET_PAD_BUTTON) {
+			record->code = e->button.number;
+			record->state = e->button.state;
+		} else if (event->type == LIBINPUT_EVENT_TABLET_PAD_KEY) {
+			record->code = e->key.code;
+			record->state = e->key.state;
+		} else if (event->type == LIBINPUT_EVENT_TABLET_PAD_RING) {
+			record->code = e->ring.number;
+			record->x = e->ring.position;
+		} else {
+			record->code = e->strip.number;
+			record->x = e->strip.position;
+		}
+		break;
+	}
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END: {
+		struct libinput_event_gesture *e =
+			(struct libinput_event_gesture *)event;
+		record->code = e->finger_count;
+		record->state = e->cancelled;
+		record->x = e->delta.x;
+		record->y = e->delta.y;
+		break;
+	}
+	case LIBINPUT_EVENT_SWITCH_TOGGLE: {
+		struct libinput_event_switch *e =
+			(struct libinput_event_switch *)event;
+		record->code = e->sw;
+		record->state = e->state;
+		break;
+	}
+	}
+}
+
+static void
+event_export_ring_write(struct libinput *libinput,
+			struct libinput_event *event)
+{
+	struct event_export_ring *ring = libinput->export_ring;
+	uint64_t seq = ring->write_seq++;
+	struct event_export_slot *slot = &ring->slots[seq & (ring->nslots - 1)];
+	struct libinput_event_export_record record = {0};
+
+	event_export_fill_record(libinput, event, &record);
+
+	/* A seqlock per slot: readers discard a record if the slot's
+	 * sequence number changed while they copied it */
+	__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->record = record;
+	__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&ring->header->write_seq, ring->write_seq,
+			 __ATOMIC_RELEASE);
+}
+
+/* Called for every event queued for the caller and every sample merged
+ * into a queued event, see tablet_tool_coalesce_axis() */
+static void
+libinput_event_posted(struct libinput *libinput,
+		      struct libinput_event *event)
+{
+	trace_probe(post_event,
+		    libinput,
+		    event->device,
+		    event->type,
+		    event_get_time(event),
+		    libinput->events_count);
+
+	if (libinput->export_ring)
+		event_export_ring_write(libinput, event);
+}
+
 LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
 static void
 libinput_default_log_func(struct libinput *libinput,
@@ -263,14 +623,58 @@ libinput_default_log_func(struct libinput *libinput,
 	vfprintf(stderr, format, args);
 }
 
+void
+log_msg_record(struct libinput *libinput,
+	       enum libinput_log_priority priority,
+	       const char *prefix,
+	       const char *format,
+	       bool copy_format,
+	       va_list args)
+{
+	struct timespec ts = { 0, 0 };
+	uint64_t time;
+
+	if (!log_ring_is_enabled(&libinput->log_ring))
+		return;
+
+	/* Not libinput_now(), that one logs on failure */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	time = s2us(ts.tv_sec) + ns2us(ts.tv_nsec) + libinput->clock.offset;
+
+	log_ring_record(&libinput->log_ring,
+			time,
+			priority,
+			prefix,
+			format,
+			copy_format,
+			args);
+}
+
+void
+log_msg_va_unrecorded(struct libinput *libinput,
+		      enum libinput_log_priority priority,
+		      const char *format,
+		      va_list args)
+{
+	if (is_logged(libinput, priority))
+		libinput->log_handler(libinput, priority, format, args);
+}
+
 void
 log_msg_va(struct libinput *libinput,
 	   enum libinput_log_priority priority,
 	   const char *format,
 	   va_list args)
 {
-	if (is_logged(libinput, priority))
-		libinput->log_handler(libinput, priority, format, args);
+	if (log_ring_is_enabled(&libinput->log_ring)) {
+		va_list copy;
+
+		va_copy(copy, args);
+		log_msg_record(libinput, priority, NULL, format, false, copy);
+		va_end(copy);
+	}
+
+	log_msg_va_unrecorded(libinput, priority, format, args);
 }
 
 void
@@ -330,6 +734,18 @@ libinput_log_set_handler(struct libinput *libinput,
 	libinput->log_handler = log_handler;
 }
 
+LIBINPUT_EXPORT void
+libinput_log_set_ring_size(struct libinput *libinput, unsigned int size)
+{
+	log_ring_init(&libinput->log_ring, size);
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_log_dump_ring(struct libinput *libinput, int fd)
+{
+	return log_ring_dump(&libinput->log_ring, fd);
+}
+
 static void
 libinput_device_group_destroy(struct libinput_device_group *group);
 
@@ -881,6 +1297,185 @@ libinput_event_touch_get_y(struct libinput_event_touch *event)
 	return evdev_convert_to_mm(device->abs.absinfo_y, event->point.y);
 }
 
+LIBINPUT_EXPORT void
+libinput_enable_touch_frame_aggregation(struct libinput *libinput,
+					int enable)
+{
+	libinput->touch_frame_aggregation_enabled = !!enable;
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_event_touch_get_frame_size(struct libinput_event_touch *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_FRAME);
+
+	return event->nframe_slots;
+}
+
+static const struct touch_frame_slot *
+touch_get_frame_slot(struct libinput_event_touch *event,
+		     unsigned int index)
+{
+	/* only frame events ever have slots */
+	if (index >= event->nframe_slots) {
+		log_bug_client(libinput_event_get_context(&event->base),
+			       "frame slot %u requested, event has %u\n",
+			       index,
+			       event->nframe_slots);
+		return NULL;
+	}
+
+	return &event->frame_slots[index];
+}
+
+static inline bool
+touch_frame_slot_has_point(const struct touch_frame_slot *fs)
+{
+	return fs &&
+	       (fs->type == LIBINPUT_EVENT_TOUCH_DOWN ||
+		fs->type == LIBINPUT_EVENT_TOUCH_MOTION);
+}
+
+LIBINPUT_EXPORT enum libinput_event_type
+libinput_event_touch_get_frame_type(struct libinput_event_touch *event,
+				    unsigned int index)
+{
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	return fs ? fs->type : LIBINPUT_EVENT_NONE;
+}
+
+LIBINPUT_EXPORT int32_t
+libinput_event_touch_get_frame_slot(struct libinput_event_touch *event,
+				    unsigned int index)
+{
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	return fs ? fs->slot : -1;
+}
+
+LIBINPUT_EXPORT int32_t
+libinput_event_touch_get_frame_seat_slot(struct libinput_event_touch *event,
+					 unsigned int index)
+{
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	return fs ? fs->seat_slot : -1;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_x(struct libinput_event_touch *event,
+				 unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	if (!touch_frame_slot_has_point(fs))
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_x, fs->point.x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_y(struct libinput_event_touch *event,
+				 unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	if (!touch_frame_slot_has_point(fs))
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_y, fs->point.y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_x_transformed(struct libinput_event_touch *event,
+					     unsigned int index,
+					     uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	if (!touch_frame_slot_has_point(fs))
+		return 0;
+
+	return evdev_device_transform_x(device, fs->point.x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_frame_y_transformed(struct libinput_event_touch *event,
+					     unsigned int index,
+					     uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct touch_frame_slot *fs = touch_get_frame_slot(event, index);
+
+	if (!touch_frame_slot_has_point(fs))
+		return 0;
+
+	return evdev_device_transform_y(device, fs->point.y, height);
+}
+
+LIBINPUT_EXPORT void
+libinput_enable_motion_prediction(struct libinput *libinput, int enable)
+{
+	libinput->motion_prediction_enabled = !!enable;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_predicted_x_transformed(struct libinput_event_touch *event,
+						 uint64_t time,
+						 uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double x, y;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	prediction_at(&event->prediction, time, &x, &y);
+
+	return evdev_device_transform_x(device, x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_predicted_y_transformed(struct libinput_event_touch *event,
+						 uint64_t time,
+						 uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double x, y;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	prediction_at(&event->prediction, time, &x, &y);
+
+	return evdev_device_transform_y(device, y, height);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_touch_get_prediction_confidence(struct libinput_event_touch *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TOUCH_DOWN,
+			   LIBINPUT_EVENT_TOUCH_MOTION);
+
+	return event->prediction.confidence;
+}
+
 LIBINPUT_EXPORT uint32_t
 libinput_event_gesture_get_time(struct libinput_event_gesture *event)
 {
@@ -1520,38 +2115,231 @@ libinput_event_tablet_tool_get_time_usec(struct libinput_event_tablet_tool *even
 	return event->time;
 }
 
-LIBINPUT_EXPORT uint32_t
-libinput_event_tablet_tool_get_button(struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT void
+libinput_enable_tablet_tool_history(struct libinput *libinput, int enable)
 {
-	require_event_type(libinput_event_get_context(&event->base),
-			   event->base.type,
-			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
-
-	return event->button;
+	libinput->tablet_tool_history_enabled = !!enable;
 }
 
-LIBINPUT_EXPORT enum libinput_button_state
-libinput_event_tablet_tool_get_button_state(struct libinput_event_tablet_tool *event)
+LIBINPUT_EXPORT unsigned int
+libinput_event_tablet_tool_get_history_size(struct libinput_event_tablet_tool *event)
 {
 	require_event_type(libinput_event_get_context(&event->base),
 			   event->base.type,
 			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
 
-	return event->state;
+	return event->history_size;
 }
 
-LIBINPUT_EXPORT uint32_t
-libinput_event_tablet_tool_get_seat_button_count(struct libinput_event_tablet_tool *event)
+static const struct tablet_tool_sample *
+tablet_tool_get_sample(struct libinput_event_tablet_tool *event,
+		       unsigned int index)
 {
-	require_event_type(libinput_event_get_context(&event->base),
-			   event->base.type,
-			   0,
-			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
-
-	return event->seat_button_count;
-}
+	struct libinput *libinput = libinput_event_get_context(&event->base);
+
+	/* only axis events ever have a history */
+	if (index >= event->history_size) {
+		log_bug_client(libinput,
+			       "historical sample %u requested, event has %u\n",
+			       index,
+			       event->history_size);
+		return NULL;
+	}
+
+	return &event->history[index];
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_x(struct libinput_event_tablet_tool *event,
+					    unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_x, sample->point.x);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_y(struct libinput_event_tablet_tool *event,
+					    unsigned int index)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_convert_to_mm(device->abs.absinfo_y, sample->point.y);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_x_transformed(struct libinput_event_tablet_tool *event,
+							unsigned int index,
+							uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_device_transform_x(device, sample->point.x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_y_transformed(struct libinput_event_tablet_tool *event,
+							unsigned int index,
+							uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+	if (!sample)
+		return 0;
+
+	return evdev_device_transform_y(device, sample->point.y, height);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_pressure(struct libinput_event_tablet_tool *event,
+						   unsigned int index)
+{
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+
+	return sample ? sample->pressure : 0;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_tilt_x(struct libinput_event_tablet_tool *event,
+						 unsigned int index)
+{
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+
+	return sample ? sample->tilt.x : 0;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_historical_tilt_y(struct libinput_event_tablet_tool *event,
+						 unsigned int index)
+{
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+
+	return sample ? sample->tilt.y : 0;
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_event_tablet_tool_get_historical_time_usec(struct libinput_event_tablet_tool *event,
+						    unsigned int index)
+{
+	const struct tablet_tool_sample *sample;
+
+	sample = tablet_tool_get_sample(event, index);
+
+	return sample ? sample->time : 0;
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_predicted_x_transformed(struct libinput_event_tablet_tool *event,
+						       uint64_t time,
+						       uint32_t width)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double x, y;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	prediction_at(&event->prediction, time, &x, &y);
+
+	return evdev_device_transform_x(device, x, width);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_predicted_y_transformed(struct libinput_event_tablet_tool *event,
+						       uint64_t time,
+						       uint32_t height)
+{
+	struct evdev_device *device = evdev_device(event->base.device);
+	double x, y;
+
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	prediction_at(&event->prediction, time, &x, &y);
+
+	return evdev_device_transform_y(device, y, height);
+}
+
+LIBINPUT_EXPORT double
+libinput_event_tablet_tool_get_prediction_confidence(struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+			   LIBINPUT_EVENT_TABLET_TOOL_TIP,
+			   LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+
+	return event->prediction.confidence;
+}
+
+LIBINPUT_EXPORT uint32_t
+libinput_event_tablet_tool_get_button(struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+
+	return event->button;
+}
+
+LIBINPUT_EXPORT enum libinput_button_state
+libinput_event_tablet_tool_get_button_state(struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+
+	return event->state;
+}
+
+LIBINPUT_EXPORT uint32_t
+libinput_event_tablet_tool_get_seat_button_count(struct libinput_event_tablet_tool *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_TABLET_TOOL_BUTTON);
+
+	return event->seat_button_count;
+}
 
 LIBINPUT_EXPORT enum libinput_tablet_tool_type
 libinput_tablet_tool_get_type(struct libinput_tablet_tool *tool)
@@ -1666,10 +2454,43 @@ libinput_tablet_tool_unref(struct libinput_tablet_tool *tool)
 		return tool;
 
 	list_remove(&tool->link);
+	hash_node_remove(&tool->index_node);
 	free(tool);
 	return NULL;
 }
 
+static inline uint64_t
+tool_index_hash(enum libinput_tablet_tool_type type, uint32_t serial)
+{
+	return hash_u64((uint64_t)type << 32 | serial);
+}
+
+struct libinput_tablet_tool *
+libinput_tablet_tool_find(struct libinput *libinput,
+			  enum libinput_tablet_tool_type type,
+			  uint32_t serial)
+{
+	struct libinput_tablet_tool *tool;
+	uint64_t hash = tool_index_hash(type, serial);
+
+	hash_table_for_each_match(tool, &libinput->tool_index, hash, index_node) {
+		if (tool->type == type && tool->serial == serial)
+			return tool;
+	}
+
+	return NULL;
+}
+
+void
+libinput_tablet_tool_add(struct libinput *libinput,
+			 struct libinput_tablet_tool *tool)
+{
+	list_insert(&libinput->tool_list, &tool->link);
+	hash_table_insert(&libinput->tool_index,
+			  &tool->index_node,
+			  tool_index_hash(tool->type, tool->serial));
+}
+
 LIBINPUT_EXPORT struct libinput_event *
 libinput_event_switch_get_base_event(struct libinput_event_switch *event)
 {
@@ -1725,11 +2546,11 @@ libinput_event_switch_get_time_usec(struct libinput_event_switch *event)
 	return event->time;
 }
 
-struct libinput_source *
-libinput_add_fd(struct libinput *libinput,
-		int fd,
-		libinput_source_dispatch_t dispatch,
-		void *user_data)
+static struct libinput_source *
+source_add(int epoll_fd,
+	   int fd,
+	   libinput_source_dispatch_t dispatch,
+	   void *user_data)
 {
 	struct libinput_source *source;
 	struct epoll_event ep;
@@ -1743,7 +2564,7 @@ libinput_add_fd(struct libinput *libinput,
 	ep.events = EPOLLIN;
 	ep.data.ptr = source;
 
-	if (epoll_ctl(libinput->epoll_fd, EPOLL_CTL_ADD, fd, &ep) < 0) {
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ep) < 0) {
 		free(source);
 		return NULL;
 	}
@@ -1751,13 +2572,59 @@ libinput_add_fd(struct libinput *libinput,
 	return source;
 }
 
+struct libinput_source *
+libinput_add_fd(struct libinput *libinput,
+		int fd,
+		libinput_source_dispatch_t dispatch,
+		void *user_data)
+{
+	struct libinput_source *source;
+
+	source = source_add(libinput->epoll_fd, fd, dispatch, user_data);
+	if (!source)
+		return NULL;
+
+	list_append(&libinput->source_list, &source->link);
+	libinput->nsources++;
+
+	if (libinput->source_handler)
+		libinput->source_handler(libinput, fd, LIBINPUT_SOURCE_ADDED);
+
+	return source;
+}
+
 void
 libinput_remove_source(struct libinput *libinput,
 		       struct libinput_source *source)
 {
+	/* Notify while the fd is still valid */
+	if (libinput->source_handler)
+		libinput->source_handler(libinput,
+					 source->fd,
+					 LIBINPUT_SOURCE_REMOVED);
+
 	epoll_ctl(libinput->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
 	source->fd = -1;
+	list_remove(&source->link);
 	list_insert(&libinput->source_destroy_list, &source->link);
+	libinput->nsources--;
+}
+
+struct libinput_source *
+libinput_loop_add_fd(struct libinput_loop *loop,
+		     int fd,
+		     libinput_source_dispatch_t dispatch,
+		     void *user_data)
+{
+	return source_add(loop->epoll_fd, fd, dispatch, user_data);
+}
+
+void
+libinput_loop_remove_source(struct libinput_loop *loop,
+			    struct libinput_source *source)
+{
+	epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
+	free(source);
 }
 
 int
@@ -1781,7 +2648,9 @@ libinput_init(struct libinput *libinput,
 	libinput->interface_backend = interface_backend;
 	libinput->user_data = user_data;
 	libinput->refcount = 1;
+	list_init(&libinput->source_list);
 	list_init(&libinput->source_destroy_list);
+	list_init(&libinput->loop_link);
 	list_init(&libinput->seat_list);
 	list_init(&libinput->device_group_list);
 	list_init(&libinput->tool_list);
@@ -1792,6 +2661,100 @@ libinput_init(struct libinput *libinput,
 		return -1;
 	}
 
+	hash_table_init(&libinput->device_syspath_index);
+	hash_table_init(&libinput->device_group_index);
+	hash_table_init(&libinput->tool_index);
+
+	return 0;
+}
+
+struct libinput_shared_data {
+	int refcount;
+
+	/* loaded by the first context that needs them */
+	bool quirks_initialized;
+	struct quirks_context *quirks;
+
+#if HAVE_LIBWACOM
+	WacomDeviceDatabase *libwacom_db;
+#endif
+};
+
+static void
+quirks_get_data_path(const char **data_path, const char **override_file)
+{
+	*data_path = getenv("LIBINPUT_QUIRKS_DIR");
+	*override_file = NULL;
+	if (!*data_path) {
+		*data_path = LIBINPUT_QUIRKS_DIR;
+		*override_file = LIBINPUT_QUIRKS_OVERRIDE_FILE;
+	}
+}
+
+LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
+static void
+shared_quirks_log_handler(struct libinput *libinput,
+			  enum libinput_log_priority priority,
+			  const char *format,
+			  va_list args)
+{
+	/* The log target is the context that last used the shared
+	 * quirks, NULL once that context is destroyed */
+	if (libinput)
+		log_msg_va(libinput, priority, format, args);
+}
+
+LIBINPUT_EXPORT struct libinput_shared_data *
+libinput_shared_data_new(void)
+{
+	struct libinput_shared_data *data;
+
+	data = zalloc(sizeof *data);
+	data->refcount = 1;
+
+	return data;
+}
+
+LIBINPUT_EXPORT struct libinput_shared_data *
+libinput_shared_data_ref(struct libinput_shared_data *data)
+{
+	assert(data->refcount > 0);
+	data->refcount++;
+	return data;
+}
+
+LIBINPUT_EXPORT struct libinput_shared_data *
+libinput_shared_data_unref(struct libinput_shared_data *data)
+{
+	if (!data)
+		return NULL;
+
+	assert(data->refcount > 0);
+	if (--data->refcount > 0)
+		return data;
+
+	quirks_context_unref(data->quirks);
+#if HAVE_LIBWACOM
+	if (data->libwacom_db)
+		libwacom_database_destroy(data->libwacom_db);
+#endif
+	free(data);
+
+	return NULL;
+}
+
+LIBINPUT_EXPORT int
+libinput_attach_shared_data(struct libinput *libinput,
+			    struct libinput_shared_data *data)
+{
+	if (!data || libinput->shared_data || libinput->quirks_initialized) {
+		log_bug_client(libinput,
+			       "Shared data must be attached once, before any device is added.\n");
+		return -1;
+	}
+
+	libinput->shared_data = libinput_shared_data_ref(data);
+
 	return 0;
 }
 
@@ -1799,7 +2762,7 @@ void
 libinput_init_quirks(struct libinput *libinput)
 {
 	const char *data_path,
-	           *override_file = NULL;
+	           *override_file;
 	struct quirks_context *quirks;
 
 	if (libinput->quirks_initialized)
@@ -1808,17 +2771,31 @@ libinput_init_quirks(struct libinput *libinput)
 	/* If we fail, we'll fail next time too */
 	libinput->quirks_initialized = true;
 
-	data_path = getenv("LIBINPUT_QUIRKS_DIR");
-	if (!data_path) {
-		data_path = LIBINPUT_QUIRKS_DIR;
-		override_file = LIBINPUT_QUIRKS_OVERRIDE_FILE;
-	}
+	quirks_get_data_path(&data_path, &override_file);
+
+	if (libinput->shared_data) {
+		struct libinput_shared_data *data = libinput->shared_data;
 
-	quirks = quirks_init_subsystem(data_path,
-				       override_file,
-				       log_msg_va,
-				       libinput,
-				       QLOG_LIBINPUT_LOGGING);
+		/* Parser messages are logged through the context that
+		 * loads the quirks */
+		if (!data->quirks_initialized) {
+			data->quirks_initialized = true;
+			data->quirks = quirks_init_subsystem(data_path,
+							     override_file,
+							     shared_quirks_log_handler,
+							     libinput,
+							     QLOG_LIBINPUT_LOGGING);
+		}
+		quirks = data->quirks;
+		if (quirks)
+			quirks = quirks_context_ref(quirks);
+	} else {
+		quirks = quirks_init_subsystem(data_path,
+					       override_file,
+					       log_msg_va,
+					       libinput,
+					       QLOG_LIBINPUT_LOGGING);
+	}
 	if (!quirks) {
 		log_error(libinput,
 			  "Failed to load the device quirks from %s%s%s. "
@@ -1835,6 +2812,16 @@ libinput_init_quirks(struct libinput *libinput)
 	libinput->quirks = quirks;
 }
 
+struct quirks *
+libinput_fetch_quirks(struct libinput *libinput,
+		      struct udev_device *udev_device)
+{
+	if (libinput->shared_data && libinput->quirks)
+		quirks_context_set_log_target(libinput->quirks, libinput);
+
+	return quirks_fetch_for_device(libinput->quirks, udev_device);
+}
+
 static void
 libinput_device_destroy(struct libinput_device *device);
 
@@ -1903,10 +2890,28 @@ libinput_unref(struct libinput *libinput)
 		libinput_tablet_tool_unref(tool);
 	}
 
+	evdev_uring_destroy(libinput->uring);
+	event_export_ring_destroy(libinput->export_ring);
+
+	hash_table_destroy(&libinput->device_syspath_index);
+	hash_table_destroy(&libinput->device_group_index);
+	hash_table_destroy(&libinput->tool_index);
+
 	libinput_timer_subsys_destroy(libinput);
 	libinput_drop_destroyed_sources(libinput);
+	/* Never leave the shared quirks logging through a freed context,
+	 * the next fetch sets the log target again */
+	if (libinput->shared_data && libinput->quirks)
+		quirks_context_set_log_target(libinput->quirks, NULL);
 	quirks_context_unref(libinput->quirks);
-	close(libinput->epoll_fd);
+	libinput_shared_data_unref(libinput->shared_data);
+	if (libinput->loop) {
+		list_remove(&libinput->loop_link);
+		libinput_loop_unref(libinput->loop);
+	} else {
+		close(libinput->epoll_fd);
+	}
+	log_ring_destroy(&libinput->log_ring);
 	free(libinput);
 
 	return NULL;
@@ -1916,6 +2921,7 @@ static void
 libinput_event_tablet_tool_destroy(struct libinput_event_tablet_tool *event)
 {
 	libinput_tablet_tool_unref(event->tool);
+	free(event->history);
 }
 
 static void
@@ -1994,6 +3000,10 @@ libinput_seat_init(struct libinput_seat *seat,
 	seat->logical_name = safe_strdup(logical_name);
 	seat->destroy = destroy;
 	list_init(&seat->devices_list);
+	for (size_t i = 0; i < SEAT_PAIR_CLASS_COUNT; i++) {
+		list_init(&seat->pair_class_index[i]);
+		list_init(&seat->pair_peer_index[i]);
+	}
 	list_insert(&libinput->seat_list, &seat->link);
 }
 
@@ -2062,6 +3072,7 @@ libinput_device_init(struct libinput_device *device,
 {
 	device->seat = seat;
 	device->refcount = 1;
+	device->export_id = ++seat->libinput->last_device_export_id;
 	list_init(&device->event_listeners);
 }
 
@@ -2076,6 +3087,8 @@ static void
 libinput_device_destroy(struct libinput_device *device)
 {
 	assert(list_empty(&device->event_listeners));
+	free(device->touch_frame.slots);
+	free(device->prediction.predictors);
 	evdev_device_destroy(evdev_device(device));
 }
 
@@ -2098,13 +3111,10 @@ libinput_get_fd(struct libinput *libinput)
 	return libinput->epoll_fd;
 }
 
-LIBINPUT_EXPORT int
-libinput_dispatch(struct libinput *libinput)
+static void
+libinput_dispatch_prepare(struct libinput *libinput)
 {
 	static uint8_t take_time_snapshot;
-	struct libinput_source *source;
-	struct epoll_event ep[32];
-	int i, count;
 
 	/* Every 10 calls to libinput_dispatch() we take the current time so
 	 * we can check the delay between our current time and the event
@@ -2114,7 +3124,20 @@ libinput_dispatch(struct libinput *libinput)
 	else if (libinput->dispatch_time)
 		libinput->dispatch_time = 0;
 
-	count = epoll_wait(libinput->epoll_fd, ep, ARRAY_LENGTH(ep), 0);
+	/* If the clock was advanced, timers may have expired in the
+	 * skipped time without the timerfd triggering yet */
+	if (libinput->clock.offset)
+		libinput_timer_flush(libinput, libinput_now(libinput));
+}
+
+static int
+dispatch_sources(int epoll_fd)
+{
+	struct libinput_source *source;
+	struct epoll_event ep[32];
+	int i, count;
+
+	count = epoll_wait(epoll_fd, ep, ARRAY_LENGTH(ep), 0);
 	if (count < 0)
 		return -errno;
 
@@ -2126,11 +3149,190 @@ libinput_dispatch(struct libinput *libinput)
 		source->dispatch(source->user_data);
 	}
 
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_dispatch(struct libinput *libinput)
+{
+	int rc;
+
+	if (libinput->loop)
+		return libinput_loop_dispatch(libinput->loop);
+
+	libinput_dispatch_prepare(libinput);
+
+	rc = dispatch_sources(libinput->epoll_fd);
+	if (rc < 0)
+		return rc;
+
+	libinput_drop_destroyed_sources(libinput);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_dispatch_source(struct libinput *libinput, int fd)
+{
+	struct libinput_source *source;
+
+	if (libinput->loop) {
+		log_bug_client(libinput,
+			       "Sources of a context attached to a loop cannot be dispatched individually.\n");
+		return -EINVAL;
+	}
+
+	list_for_each(source, &libinput->source_list, link) {
+		if (source->fd != fd)
+			continue;
+
+		libinput_dispatch_prepare(libinput);
+		source->dispatch(source->user_data);
+		libinput_drop_destroyed_sources(libinput);
+
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_source_fds(struct libinput *libinput,
+			int *fds,
+			size_t nfds)
+{
+	struct libinput_source *source;
+	int count = 0;
+
+	if (libinput->loop) {
+		log_bug_client(libinput,
+			       "Sources of a context attached to a loop cannot be enumerated.\n");
+		return -1;
+	}
+
+	list_for_each(source, &libinput->source_list, link) {
+		if ((size_t)count < nfds)
+			fds[count] = source->fd;
+		count++;
+	}
+
+	return count;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_source_handler(struct libinput *libinput,
+			    libinput_source_handler handler)
+{
+	libinput->source_handler = handler;
+}
+
+LIBINPUT_EXPORT struct libinput_loop *
+libinput_loop_new(void)
+{
+	struct libinput_loop *loop;
+
+	loop = zalloc(sizeof *loop);
+	loop->refcount = 1;
+	list_init(&loop->contexts);
+
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll_fd < 0)
+		goto error;
+
+	if (libinput_loop_timer_init(loop) != 0) {
+		close(loop->epoll_fd);
+		goto error;
+	}
+
+	return loop;
+
+error:
+	free(loop);
+	return NULL;
+}
+
+LIBINPUT_EXPORT struct libinput_loop *
+libinput_loop_ref(struct libinput_loop *loop)
+{
+	assert(loop->refcount > 0);
+	loop->refcount++;
+	return loop;
+}
+
+LIBINPUT_EXPORT struct libinput_loop *
+libinput_loop_unref(struct libinput_loop *loop)
+{
+	if (!loop)
+		return NULL;
+
+	assert(loop->refcount > 0);
+	if (--loop->refcount > 0)
+		return loop;
+
+	/* Every attached context holds a reference */
+	assert(list_empty(&loop->contexts));
+
+	libinput_loop_timer_destroy(loop);
+	close(loop->epoll_fd);
+	free(loop);
+
+	return NULL;
+}
+
+LIBINPUT_EXPORT int
+libinput_loop_get_fd(struct libinput_loop *loop)
+{
+	return loop->epoll_fd;
+}
+
+LIBINPUT_EXPORT int
+libinput_loop_dispatch(struct libinput_loop *loop)
+{
+	struct libinput *libinput;
+	int rc;
+
+	list_for_each(libinput, &loop->contexts, loop_link)
+		libinput_dispatch_prepare(libinput);
+
+	rc = dispatch_sources(loop->epoll_fd);
+
+	/* A source may be removed by another source's dispatch within the
+	 * same epoll_wait() batch, so the sources can only be freed now */
+	list_for_each(libinput, &loop->contexts, loop_link)
+		libinput_drop_destroyed_sources(libinput);
+
+	return rc;
+}
+
+LIBINPUT_EXPORT int
+libinput_attach_loop(struct libinput *libinput,
+		     struct libinput_loop *loop)
+{
+	/* Only the timer source may exist at this point */
+	if (!loop || libinput->loop || libinput->nsources > 1) {
+		log_bug_client(libinput,
+			       "A loop must be attached once, before any device is added.\n");
+		return -1;
+	}
+
+	libinput->loop = libinput_loop_ref(loop);
+	list_append(&loop->contexts, &libinput->loop_link);
+
+	libinput_timer_subsys_attach_loop(libinput);
 	libinput_drop_destroyed_sources(libinput);
+	close(libinput->epoll_fd);
+	libinput->epoll_fd = loop->epoll_fd;
 
 	return 0;
 }
 
+LIBINPUT_EXPORT void
+libinput_clock_advance(struct libinput *libinput, uint64_t usec)
+{
+	libinput->clock.offset += usec;
+	libinput_timer_clock_advanced(libinput);
+}
+
 void
 libinput_device_init_event_listener(struct libinput_event_listener *listener)
 {
@@ -2218,6 +3420,22 @@ post_base_event(struct libinput_device *device,
 	libinput_post_event(libinput, event);
 }
 
+static inline bool
+event_type_is_masked(struct libinput *libinput,
+		     enum libinput_event_type type)
+{
+	return long_bit_is_set(libinput->event_mask, type);
+}
+
+/* Masked events are only built if an internal listener needs them */
+static inline bool
+skip_device_event(struct libinput_device *device,
+		  enum libinput_event_type type)
+{
+	return event_type_is_masked(device->seat->libinput, type) &&
+		list_empty(&device->event_listeners);
+}
+
 static void
 post_device_event(struct libinput_device *device,
 		  uint64_t time,
@@ -2239,9 +3457,19 @@ post_device_event(struct libinput_device *device,
 
 	init_event_base(event, device, type);
 
+	trace_probe(post_device_event, device, type, time);
+
 	list_for_each_safe(listener, &device->event_listeners, link)
 		listener->notify_func(time, event, listener->notify_func_data);
 
+	if (event_type_is_masked(device->seat->libinput, type)) {
+		/* The device is only ref'd once the event is queued but
+		 * libinput_event_destroy() needs it and drops a ref */
+		libinput_device_ref(device);
+		libinput_event_destroy(event);
+		return;
+	}
+
 	libinput_post_event(device->seat->libinput, event);
 }
 
@@ -2334,10 +3562,13 @@ keyboard_notify_key(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_KEYBOARD))
 		return;
 
-	key_event = zalloc(sizeof *key_event);
-
 	seat_key_count = update_seat_key_count(device->seat, key, state);
 
+	if (skip_device_event(device, LIBINPUT_EVENT_KEYBOARD_KEY))
+		return;
+
+	key_event = zalloc(sizeof *key_event);
+
 	*key_event = (struct libinput_event_keyboard) {
 		.time = time,
 		.key = key,
@@ -2361,6 +3592,9 @@ pointer_notify_motion(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_POINTER_MOTION))
+		return;
+
 	motion_event = zalloc(sizeof *motion_event);
 
 	*motion_event = (struct libinput_event_pointer) {
@@ -2384,6 +3618,9 @@ pointer_notify_motion_absolute(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE))
+		return;
+
 	motion_absolute_event = zalloc(sizeof *motion_absolute_event);
 
 	*motion_absolute_event = (struct libinput_event_pointer) {
@@ -2408,12 +3645,15 @@ pointer_notify_button(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	button_event = zalloc(sizeof *button_event);
-
 	seat_button_count = update_seat_button_count(device->seat,
 						     button,
 						     state);
 
+	if (skip_device_event(device, LIBINPUT_EVENT_POINTER_BUTTON))
+		return;
+
+	button_event = zalloc(sizeof *button_event);
+
 	*button_event = (struct libinput_event_pointer) {
 		.time = time,
 		.button = button,
@@ -2439,6 +3679,9 @@ pointer_notify_axis(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_POINTER_AXIS))
+		return;
+
 	axis_event = zalloc(sizeof *axis_event);
 
 	*axis_event = (struct libinput_event_pointer) {
@@ -2454,6 +3697,86 @@ pointer_notify_axis(struct libinput_device *device,
 			  &axis_event->base);
 }
 
+/* Update the slot's motion predictor with the new position. If motion
+ * prediction is disabled, the prediction is the position itself with a
+ * confidence of 0. */
+static void
+device_predict_motion(struct libinput_device *device,
+		      int32_t slot,
+		      bool reset,
+		      uint64_t time,
+		      const struct device_coords *point,
+		      struct prediction *prediction)
+{
+	struct predictor *predictor;
+	size_t idx = max(slot, 0);
+
+	if (!device->seat->libinput->motion_prediction_enabled) {
+		*prediction = (struct prediction) {
+			.time = time,
+			.x = point->x,
+			.y = point->y,
+		};
+		return;
+	}
+
+	if (idx >= device->prediction.npredictors) {
+		size_t n = max(idx + 1, 10);
+		struct predictor *predictors;
+
+		predictors = realloc(device->prediction.predictors,
+				     n * sizeof(*predictors));
+		if (!predictors)
+			abort();
+		memset(predictors + device->prediction.npredictors,
+		       0,
+		       (n - device->prediction.npredictors) * sizeof(*predictors));
+		device->prediction.predictors = predictors;
+		device->prediction.npredictors = n;
+	}
+
+	predictor = &device->prediction.predictors[idx];
+	if (reset)
+		predictor_reset(predictor);
+	predictor_add_sample(predictor, time, point->x, point->y, prediction);
+}
+
+/* Returns true if the per-slot event was added to the pending touch
+ * frame instead of being queued */
+static bool
+touch_frame_aggregate(struct libinput_device *device,
+		      enum libinput_event_type type,
+		      int32_t slot,
+		      int32_t seat_slot,
+		      const struct device_coords *point)
+{
+	struct touch_frame_slot *fs;
+
+	if (!device->seat->libinput->touch_frame_aggregation_enabled)
+		return false;
+
+	if (device->touch_frame.count == device->touch_frame.size) {
+		size_t size = max(device->touch_frame.size * 2, 10);
+
+		device->touch_frame.slots = realloc(device->touch_frame.slots,
+						    size * sizeof(*fs));
+		if (!device->touch_frame.slots)
+			abort();
+		device->touch_frame.size = size;
+	}
+
+	fs = &device->touch_frame.slots[device->touch_frame.count++];
+	*fs = (struct touch_frame_slot) {
+		.type = type,
+		.slot = slot,
+		.seat_slot = seat_slot,
+	};
+	if (point)
+		fs->point = *point;
+
+	return true;
+}
+
 void
 touch_notify_touch_down(struct libinput_device *device,
 			uint64_t time,
@@ -2462,10 +3785,23 @@ touch_notify_touch_down(struct libinput_device *device,
 			const struct device_coords *point)
 {
 	struct libinput_event_touch *touch_event;
+	struct prediction prediction;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TOUCH_DOWN))
+		return;
+
+	device_predict_motion(device, slot, true, time, point, &prediction);
+
+	if (touch_frame_aggregate(device,
+				  LIBINPUT_EVENT_TOUCH_DOWN,
+				  slot,
+				  seat_slot,
+				  point))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch) {
@@ -2473,6 +3809,7 @@ touch_notify_touch_down(struct libinput_device *device,
 		.slot = slot,
 		.seat_slot = seat_slot,
 		.point = *point,
+		.prediction = prediction,
 	};
 
 	post_device_event(device, time,
@@ -2488,10 +3825,23 @@ touch_notify_touch_motion(struct libinput_device *device,
 			  const struct device_coords *point)
 {
 	struct libinput_event_touch *touch_event;
+	struct prediction prediction;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TOUCH_MOTION))
+		return;
+
+	device_predict_motion(device, slot, false, time, point, &prediction);
+
+	if (touch_frame_aggregate(device,
+				  LIBINPUT_EVENT_TOUCH_MOTION,
+				  slot,
+				  seat_slot,
+				  point))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch) {
@@ -2499,6 +3849,7 @@ touch_notify_touch_motion(struct libinput_device *device,
 		.slot = slot,
 		.seat_slot = seat_slot,
 		.point = *point,
+		.prediction = prediction,
 	};
 
 	post_device_event(device, time,
@@ -2517,6 +3868,16 @@ touch_notify_touch_up(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TOUCH_UP))
+		return;
+
+	if (touch_frame_aggregate(device,
+				  LIBINPUT_EVENT_TOUCH_UP,
+				  slot,
+				  seat_slot,
+				  NULL))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch) {
@@ -2541,6 +3902,16 @@ touch_notify_touch_cancel(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TOUCH_CANCEL))
+		return;
+
+	if (touch_frame_aggregate(device,
+				  LIBINPUT_EVENT_TOUCH_CANCEL,
+				  slot,
+				  seat_slot,
+				  NULL))
+		return;
+
 	touch_event = zalloc(sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch) {
@@ -2559,21 +3930,117 @@ touch_notify_frame(struct libinput_device *device,
 		   uint64_t time)
 {
 	struct libinput_event_touch *touch_event;
+	unsigned int nslots;
 
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
+	if (skip_device_event(device, LIBINPUT_EVENT_TOUCH_FRAME)) {
+		device->touch_frame.count = 0;
+		return;
+	}
+
+	nslots = device->touch_frame.count;
+	touch_event = zalloc(sizeof *touch_event +
+			     nslots * sizeof(touch_event->frame_slots[0]));
 
 	*touch_event = (struct libinput_event_touch) {
 		.time = time,
+		.nframe_slots = nslots,
 	};
+	if (nslots > 0) {
+		memcpy(touch_event->frame_slots,
+		       device->touch_frame.slots,
+		       nslots * sizeof(touch_event->frame_slots[0]));
+		device->touch_frame.count = 0;
+	}
 
 	post_device_event(device, time,
 			  LIBINPUT_EVENT_TOUCH_FRAME,
 			  &touch_event->base);
 }
 
+static inline struct libinput_event *
+libinput_last_queued_event(struct libinput *libinput)
+{
+	size_t last;
+
+	if (libinput->events_count == 0)
+		return NULL;
+
+	last = (libinput->events_in + libinput->events_len - 1) %
+		libinput->events_len;
+
+	return libinput->events[last];
+}
+
+/* Merge the axis state into the last queued event if it is an axis event
+ * for the same tool, keeping its current state as historical sample */
+static bool
+tablet_tool_coalesce_axis(struct libinput_device *device,
+			  uint64_t time,
+			  struct libinput_tablet_tool *tool,
+			  enum libinput_tablet_tool_tip_state tip_state,
+			  unsigned char *changed_axes,
+			  const struct tablet_axes *axes,
+			  const struct prediction *prediction)
+{
+	struct libinput *libinput = device->seat->libinput;
+	struct libinput_event *last;
+	struct libinput_event_tablet_tool *event;
+	struct tablet_tool_sample *sample;
+
+	if (!libinput->tablet_tool_history_enabled ||
+	    !list_empty(&device->event_listeners))
+		return false;
+
+	last = libinput_last_queued_event(libinput);
+	if (!last ||
+	    last->type != LIBINPUT_EVENT_TABLET_TOOL_AXIS ||
+	    last->device != device)
+		return false;
+
+	event = libinput_event_get_tablet_tool_event(last);
+	if (event->tool != tool ||
+	    event->tip_state != tip_state ||
+	    event->history_size >= TABLET_TOOL_HISTORY_MAX ||
+	    bit_is_set(changed_axes, LIBINPUT_TABLET_TOOL_AXIS_REL_WHEEL) ||
+	    bit_is_set(event->changed_axes, LIBINPUT_TABLET_TOOL_AXIS_REL_WHEEL))
+		return false;
+
+	if (!event->history) {
+		event->history = zalloc(TABLET_TOOL_HISTORY_MAX *
+					sizeof(*event->history));
+	}
+
+	sample = &event->history[event->history_size++];
+	sample->time = event->time;
+	sample->point = event->axes.point;
+	sample->pressure = event->axes.pressure;
+	sample->tilt = event->axes.tilt;
+
+	event->time = time;
+	event->axes.point = axes->point;
+	event->axes.delta.x += axes->delta.x;
+	event->axes.delta.y += axes->delta.y;
+	event->axes.distance = axes->distance;
+	event->axes.pressure = axes->pressure;
+	event->axes.tilt = axes->tilt;
+	event->axes.rotation = axes->rotation;
+	event->axes.slider = axes->slider;
+	event->axes.size = axes->size;
+	event->prediction = *prediction;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(event->changed_axes); i++)
+		event->changed_axes[i] |= changed_axes[i];
+
+	/* The caller only sees the merged event, observers see each
+	 * sample */
+	libinput_event_posted(libinput, last);
+
+	return true;
+}
+
 void
 tablet_notify_axis(struct libinput_device *device,
 		   uint64_t time,
@@ -2583,6 +4050,21 @@ tablet_notify_axis(struct libinput_device *device,
 		   const struct tablet_axes *axes)
 {
 	struct libinput_event_tablet_tool *axis_event;
+	struct prediction prediction;
+
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_TOOL_AXIS))
+		return;
+
+	device_predict_motion(device, 0, false, time, &axes->point, &prediction);
+
+	if (tablet_tool_coalesce_axis(device,
+				      time,
+				      tool,
+				      tip_state,
+				      changed_axes,
+				      axes,
+				      &prediction))
+		return;
 
 	axis_event = zalloc(sizeof *axis_event);
 
@@ -2592,6 +4074,7 @@ tablet_notify_axis(struct libinput_device *device,
 		.proximity_state = LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN,
 		.tip_state = tip_state,
 		.axes = *axes,
+		.prediction = prediction,
 	};
 
 	memcpy(axis_event->changed_axes,
@@ -2613,6 +4096,13 @@ tablet_notify_proximity(struct libinput_device *device,
 			const struct tablet_axes *axes)
 {
 	struct libinput_event_tablet_tool *proximity_event;
+	struct prediction prediction;
+
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY))
+		return;
+
+	/* one tool at a time, a new tool restarts the prediction */
+	device_predict_motion(device, 0, true, time, &axes->point, &prediction);
 
 	proximity_event = zalloc(sizeof *proximity_event);
 
@@ -2622,6 +4112,7 @@ tablet_notify_proximity(struct libinput_device *device,
 		.tip_state = LIBINPUT_TABLET_TOOL_TIP_UP,
 		.proximity_state = proximity_state,
 		.axes = *axes,
+		.prediction = prediction,
 	};
 	memcpy(proximity_event->changed_axes,
 	       changed_axes,
@@ -2642,6 +4133,12 @@ tablet_notify_tip(struct libinput_device *device,
 		  const struct tablet_axes *axes)
 {
 	struct libinput_event_tablet_tool *tip_event;
+	struct prediction prediction;
+
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_TOOL_TIP))
+		return;
+
+	device_predict_motion(device, 0, false, time, &axes->point, &prediction);
 
 	tip_event = zalloc(sizeof *tip_event);
 
@@ -2651,6 +4148,7 @@ tablet_notify_tip(struct libinput_device *device,
 		.tip_state = tip_state,
 		.proximity_state = LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN,
 		.axes = *axes,
+		.prediction = prediction,
 	};
 	memcpy(tip_event->changed_axes,
 	       changed_axes,
@@ -2674,12 +4172,15 @@ tablet_notify_button(struct libinput_device *device,
 	struct libinput_event_tablet_tool *button_event;
 	int32_t seat_button_count;
 
-	button_event = zalloc(sizeof *button_event);
-
 	seat_button_count = update_seat_button_count(device->seat,
 						     button,
 						     state);
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_TOOL_BUTTON))
+		return;
+
+	button_event = zalloc(sizeof *button_event);
+
 	*button_event = (struct libinput_event_tablet_tool) {
 		.time = time,
 		.tool = libinput_tablet_tool_ref(tool),
@@ -2707,6 +4208,9 @@ tablet_pad_notify_button(struct libinput_device *device,
 	struct libinput_event_tablet_pad *button_event;
 	unsigned int mode;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_PAD_BUTTON))
+		return;
+
 	button_event = zalloc(sizeof *button_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
@@ -2736,6 +4240,9 @@ tablet_pad_notify_ring(struct libinput_device *device,
 	struct libinput_event_tablet_pad *ring_event;
 	unsigned int mode;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_PAD_RING))
+		return;
+
 	ring_event = zalloc(sizeof *ring_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
@@ -2766,6 +4273,9 @@ tablet_pad_notify_strip(struct libinput_device *device,
 	struct libinput_event_tablet_pad *strip_event;
 	unsigned int mode;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_PAD_STRIP))
+		return;
+
 	strip_event = zalloc(sizeof *strip_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
@@ -2793,6 +4303,9 @@ tablet_pad_notify_key(struct libinput_device *device,
 {
 	struct libinput_event_tablet_pad *key_event;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_TABLET_PAD_KEY))
+		return;
+
 	key_event = zalloc(sizeof *key_event);
 
 	*key_event = (struct libinput_event_tablet_pad) {
@@ -2823,6 +4336,9 @@ gesture_notify(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_GESTURE))
 		return;
 
+	if (skip_device_event(device, type))
+		return;
+
 	gesture_event = zalloc(sizeof *gesture_event);
 
 	*gesture_event = (struct libinput_event_gesture) {
@@ -2901,6 +4417,9 @@ switch_notify_toggle(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_SWITCH))
 		return;
 
+	if (skip_device_event(device, LIBINPUT_EVENT_SWITCH_TOGGLE))
+		return;
+
 	switch_event = zalloc(sizeof *switch_event);
 
 	*switch_event = (struct libinput_event_switch) {
@@ -2971,6 +4490,8 @@ libinput_post_event(struct libinput *libinput,
 	libinput->events_count = events_count;
 	events[libinput->events_in] = event;
 	libinput->events_in = (libinput->events_in + 1) % libinput->events_len;
+
+	libinput_event_posted(libinput, event);
 }
 
 LIBINPUT_EXPORT struct libinput_event *
@@ -2986,6 +4507,13 @@ libinput_get_event(struct libinput *libinput)
 		(libinput->events_out + 1) % libinput->events_len;
 	libinput->events_count--;
 
+	trace_probe(get_event,
+		    libinput,
+		    event->device,
+		    event->type,
+		    event_get_time(event),
+		    libinput->events_count);
+
 	return event;
 }
 
@@ -3026,6 +4554,157 @@ libinput_suspend(struct libinput *libinput)
 	libinput->interface_backend->suspend(libinput);
 }
 
+LIBINPUT_EXPORT void
+libinput_enable_warm_suspend(struct libinput *libinput, int enable)
+{
+	libinput->warm_suspend_enabled = !!enable;
+}
+
+LIBINPUT_EXPORT int
+libinput_enable_event_export(struct libinput *libinput, unsigned int size)
+{
+	struct event_export_ring *ring = NULL;
+	uint32_t nslots = 1;
+
+	if (size > 0) {
+		if (size > (1 << 20)) {
+			log_bug_client(libinput,
+				       "Event export ring size %u is too large.\n",
+				       size);
+			return -1;
+		}
+
+		while (nslots < size)
+			nslots <<= 1;
+
+		ring = event_export_ring_new(nslots);
+		if (!ring) {
+			log_error(libinput,
+				  "Failed to create the event export ring (%s)\n",
+				  strerror(errno));
+			return -1;
+		}
+	}
+
+	event_export_ring_destroy(libinput->export_ring);
+	libinput->export_ring = ring;
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_event_export_fd(struct libinput *libinput)
+{
+	return libinput->export_ring ? libinput->export_ring->fd : -1;
+}
+
+LIBINPUT_EXPORT struct libinput_event_export_reader *
+libinput_event_export_reader_new(int fd)
+{
+	struct libinput_event_export_reader *reader;
+	const struct event_export_header *header;
+	struct stat st;
+	void *ptr;
+
+	if (fstat(fd, &st) < 0 ||
+	    (size_t)st.st_size < sizeof(struct event_export_header))
+		return NULL;
+
+	ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
+
+	header = ptr;
+	if (header->magic != EVENT_EXPORT_MAGIC ||
+	    header->version != EVENT_EXPORT_VERSION ||
+	    header->slot_size != sizeof(struct event_export_slot) ||
+	    header->nslots == 0 ||
+	    (header->nslots & (header->nslots - 1)) != 0 ||
+	    (size_t)st.st_size < event_export_ring_size(header->nslots)) {
+		munmap(ptr, st.st_size);
+		return NULL;
+	}
+
+	reader = zalloc(sizeof(*reader));
+	reader->size = st.st_size;
+	reader->nslots = header->nslots;
+	reader->header = header;
+	reader->slots = (const struct event_export_slot *)(header + 1);
+	reader->next_seq = __atomic_load_n(&header->write_seq,
+					   __ATOMIC_ACQUIRE);
+
+	return reader;
+}
+
+LIBINPUT_EXPORT void
+libinput_event_export_reader_destroy(struct libinput_event_export_reader *reader)
+{
+	if (!reader)
+		return;
+
+	munmap((void *)reader->header, reader->size);
+	free(reader);
+}
+
+LIBINPUT_EXPORT int
+libinput_event_export_reader_read(struct libinput_event_export_reader *reader,
+				  struct libinput_event_export_record *record)
+{
+	const struct event_export_header *header = reader->header;
+	uint32_t nslots = reader->nslots;
+
+	while (true) {
+		uint64_t write_seq = __atomic_load_n(&header->write_seq,
+						     __ATOMIC_ACQUIRE);
+		const struct event_export_slot *slot;
+		uint64_t seq;
+
+		if (reader->next_seq == write_seq)
+			return 0;
+
+		/* The writer lapped us, skip to the oldest record left */
+		if (write_seq - reader->next_seq > nslots) {
+			reader->overflow_count += write_seq - reader->next_seq - nslots;
+			reader->next_seq = write_seq - nslots;
+		}
+
+		slot = &reader->slots[reader->next_seq & (nslots - 1)];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		if (seq == reader->next_seq + 1) {
+			*record = slot->record;
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+				reader->next_seq++;
+				return 1;
+			}
+		}
+
+		/* Overwritten before or while we copied it */
+		reader->overflow_count++;
+		reader->next_seq++;
+	}
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_event_export_reader_get_overflow_count(struct libinput_event_export_reader *reader)
+{
+	return reader->overflow_count;
+}
+
+LIBINPUT_EXPORT int
+libinput_enable_io_uring(struct libinput *libinput, int enable)
+{
+	if (enable && !libinput->uring) {
+		libinput->uring = evdev_uring_new(libinput);
+		if (!libinput->uring)
+			return -1;
+	}
+
+	libinput->io_uring_enabled = !!enable;
+
+	return 0;
+}
+
 LIBINPUT_EXPORT void
 libinput_device_set_user_data(struct libinput_device *device, void *user_data)
 {
@@ -3112,6 +4791,75 @@ libinput_device_led_update(struct libinput_device *device,
 	evdev_device_led_update((struct evdev_device *) device, leds);
 }
 
+LIBINPUT_EXPORT int
+libinput_device_inject_event(struct libinput_device *device,
+			     unsigned int type,
+			     unsigned int code,
+			     int value)
+{
+	return evdev_device_inject_event((struct evdev_device *) device,
+					 type,
+					 code,
+					 value);
+}
+
+LIBINPUT_EXPORT int
+libinput_set_event_mask(struct libinput *libinput,
+			enum libinput_event_type type,
+			int masked)
+{
+	switch (type) {
+	case LIBINPUT_EVENT_NONE:
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		return -1;
+	default:
+		if (event_type_to_str(type) == NULL)
+			return -1;
+		break;
+	}
+
+	long_set_bit_state(libinput->event_mask, type, !!masked);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_event_mask(struct libinput *libinput,
+			enum libinput_event_type type)
+{
+	if ((unsigned int)type >= EVENT_MASK_BITS)
+		return 0;
+
+	return event_type_is_masked(libinput, type);
+}
+
+LIBINPUT_EXPORT void
+libinput_enable_stage_counters(struct libinput *libinput, int enable)
+{
+	libinput->stage_counters_enabled = !!enable;
+}
+
+LIBINPUT_EXPORT int
+libinput_device_get_stage_counters(struct libinput_device *device,
+				   enum libinput_stage stage,
+				   uint64_t *count,
+				   uint64_t *nsec,
+				   uint64_t *cycles)
+{
+	return evdev_device_get_stage_counters((struct evdev_device *)device,
+					       stage,
+					       count,
+					       nsec,
+					       cycles);
+}
+
+LIBINPUT_EXPORT void
+libinput_device_reset_stage_counters(struct libinput_device *device)
+{
+	evdev_device_reset_stage_counters((struct evdev_device *)device);
+}
+
 LIBINPUT_EXPORT int
 libinput_device_has_capability(struct libinput_device *device,
 			       enum libinput_device_capability capability)
@@ -3575,6 +5323,12 @@ libinput_device_group_create(struct libinput *libinput,
 	list_init(&group->link);
 	list_insert(&libinput->device_group_list, &group->link);
 
+	/* singletons are never looked up */
+	if (identifier)
+		hash_table_insert(&libinput->device_group_index,
+				  &group->index_node,
+				  hash_string(identifier));
+
 	return group;
 }
 
@@ -3582,13 +5336,17 @@ struct libinput_device_group *
 libinput_device_group_find_group(struct libinput *libinput,
 				 const char *identifier)
 {
-	struct libinput_device_group *g = NULL;
+	struct libinput_device_group *g;
+
+	if (!identifier)
+		return NULL;
 
-	list_for_each(g, &libinput->device_group_list, link) {
-		if (identifier && g->identifier &&
-		    streq(g->identifier, identifier)) {
+	hash_table_for_each_match(g,
+				  &libinput->device_group_index,
+				  hash_string(identifier),
+				  index_node) {
+		if (streq(g->identifier, identifier))
 			return g;
-		}
 	}
 
 	return NULL;
@@ -3606,6 +5364,7 @@ static void
 libinput_device_group_destroy(struct libinput_device_group *group)
 {
 	list_remove(&group->link);
+	hash_node_remove(&group->index_node);
 	free(group->identifier);
 	free(group);
 }
@@ -3798,6 +5557,57 @@ libinput_device_config_tap_get_default_drag_lock_enabled(struct libinput_device
 	return device->config.tap->get_default_draglock_enabled(device);
 }
 
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_tap_set_adaptive_timeout_enabled(struct libinput_device *device,
+							enum libinput_config_tap_adaptive_timeout_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED &&
+	    enable != LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+				LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.tap->set_adaptive_timeout_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_tap_adaptive_timeout_state
+libinput_device_config_tap_get_adaptive_timeout_enabled(struct libinput_device *device)
+{
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED;
+
+	return device->config.tap->get_adaptive_timeout_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_tap_adaptive_timeout_state
+libinput_device_config_tap_get_default_adaptive_timeout_enabled(struct libinput_device *device)
+{
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED;
+
+	return device->config.tap->get_default_adaptive_timeout_enabled(device);
+}
+
+LIBINPUT_EXPORT int
+libinput_device_get_tap_timeout_stats(struct libinput_device *device,
+				      uint64_t *timeout_usec,
+				      uint64_t *ntaps,
+				      uint64_t *saved_usec,
+				      uint64_t *nsplit)
+{
+	if (libinput_device_config_tap_get_finger_count(device) == 0)
+		return -1;
+
+	device->config.tap->get_timeout_stats(device,
+					      timeout_usec,
+					      ntaps,
+					      saved_usec,
+					      nsplit);
+	return 0;
+}
+
 LIBINPUT_EXPORT int
 libinput_device_config_calibration_has_matrix(struct libinput_device *device)
 {
@@ -4346,18 +6156,191 @@ libinput_device_config_rotation_get_default_angle(struct libinput_device *device
 	return device->config.rotation->get_default_angle(device);
 }
 
+LIBINPUT_EXPORT int
+libinput_device_config_passthrough_is_available(struct libinput_device *device)
+{
+	if (!device->config.passthrough)
+		return 0;
+
+	return device->config.passthrough->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_passthrough_set_enabled(struct libinput_device *device,
+					       enum libinput_config_passthrough_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_PASSTHROUGH_ENABLED &&
+	    enable != LIBINPUT_CONFIG_PASSTHROUGH_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (!libinput_device_config_passthrough_is_available(device))
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+				LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.passthrough->set_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_passthrough_state
+libinput_device_config_passthrough_get_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_passthrough_is_available(device))
+		return LIBINPUT_CONFIG_PASSTHROUGH_DISABLED;
+
+	return device->config.passthrough->get_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_passthrough_state
+libinput_device_config_passthrough_get_default_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_passthrough_is_available(device))
+		return LIBINPUT_CONFIG_PASSTHROUGH_DISABLED;
+
+	return device->config.passthrough->get_default_enabled(device);
+}
+
+LIBINPUT_EXPORT uint32_t
+libinput_device_config_tablet_smoothing_get_methods(struct libinput_device *device)
+{
+	if (device->config.tablet_smoothing)
+		return device->config.tablet_smoothing->get_methods(device);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_tablet_smoothing_set_method(struct libinput_device *device,
+						   enum libinput_config_tablet_smoothing_method method)
+{
+	/* Check method is a single valid method */
+	switch (method) {
+	case LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE:
+	case LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE:
+	case LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE:
+		break;
+	default:
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+	}
+
+	if ((libinput_device_config_tablet_smoothing_get_methods(device) & method) != method)
+		return LIBINPUT_CONFIG_STATUS_UNSUPPORTED;
+
+	if (device->config.tablet_smoothing)
+		return device->config.tablet_smoothing->set_method(device, method);
+
+	/* method must be _NONE to get here */
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+LIBINPUT_EXPORT enum libinput_config_tablet_smoothing_method
+libinput_device_config_tablet_smoothing_get_method(struct libinput_device *device)
+{
+	if (device->config.tablet_smoothing)
+		return device->config.tablet_smoothing->get_method(device);
+
+	return LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE;
+}
+
+LIBINPUT_EXPORT enum libinput_config_tablet_smoothing_method
+libinput_device_config_tablet_smoothing_get_default_method(struct libinput_device *device)
+{
+	if (device->config.tablet_smoothing)
+		return device->config.tablet_smoothing->get_default_method(device);
+
+	return LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE;
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_tablet_smoothing_set_responsiveness(struct libinput_device *device,
+							   double responsiveness)
+{
+	/* Need the negation in case responsiveness is NaN */
+	if (!(responsiveness >= 0.0 && responsiveness <= 1.0))
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (!device->config.tablet_smoothing)
+		return LIBINPUT_CONFIG_STATUS_UNSUPPORTED;
+
+	return device->config.tablet_smoothing->set_responsiveness(device,
+								   responsiveness);
+}
+
+LIBINPUT_EXPORT double
+libinput_device_config_tablet_smoothing_get_responsiveness(struct libinput_device *device)
+{
+	if (!device->config.tablet_smoothing)
+		return 0;
+
+	return device->config.tablet_smoothing->get_responsiveness(device);
+}
+
+LIBINPUT_EXPORT double
+libinput_device_config_tablet_smoothing_get_default_responsiveness(struct libinput_device *device)
+{
+	if (!device->config.tablet_smoothing)
+		return 0;
+
+	return device->config.tablet_smoothing->get_default_responsiveness(device);
+}
+
+LIBINPUT_EXPORT int
+libinput_device_config_gesture_low_latency_is_available(struct libinput_device *device)
+{
+	if (!device->config.gesture_low_latency)
+		return 0;
+
+	return device->config.gesture_low_latency->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_gesture_low_latency_set_enabled(struct libinput_device *device,
+							enum libinput_config_gesture_low_latency_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED &&
+	    enable != LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (!libinput_device_config_gesture_low_latency_is_available(device))
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED :
+				LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.gesture_low_latency->set_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_gesture_low_latency_state
+libinput_device_config_gesture_low_latency_get_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_gesture_low_latency_is_available(device))
+		return LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED;
+
+	return device->config.gesture_low_latency->get_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_gesture_low_latency_state
+libinput_device_config_gesture_low_latency_get_default_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_gesture_low_latency_is_available(device))
+		return LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED;
+
+	return device->config.gesture_low_latency->get_default_enabled(device);
+}
+
 #if HAVE_LIBWACOM
 WacomDeviceDatabase *
 libinput_libwacom_ref(struct libinput *li)
 {
 	WacomDeviceDatabase *db = NULL;
 	if (!li->libwacom.db) {
-		db = libwacom_database_new();
+		if (li->shared_data)
+			db = li->shared_data->libwacom_db;
+		if (!db)
+			db = libwacom_database_new();
 		if (!db) {
 			log_error(li,
 				  "Failed to initialize libwacom context\n");
 			return NULL;
 		}
+		if (li->shared_data)
+			li->shared_data->libwacom_db = db;
 
 		li->libwacom.db = db;
 		li->libwacom.refcount = 0;
@@ -4377,7 +6360,9 @@ libinput_libwacom_unref(struct libinput *li)
 	assert(li->libwacom.refcount >= 1);
 
 	if (--li->libwacom.refcount == 0) {
-		libwacom_database_destroy(li->libwacom.db);
+		/* A shared database is destroyed with the shared data */
+		if (!li->shared_data)
+			libwacom_database_destroy(li->libwacom.db);
 		li->libwacom.db = NULL;
 	}
 }
@@ -56,6 +56,30 @@ struct libinput;
  */
 struct libinput_device;
 
+/**
+ * @ingroup base
+ * @struct libinput_shared_data
+ *
+ * A handle to read-only data that can be shared between multiple libinput
+ * contexts. This struct is refcounted, use libinput_shared_data_ref() and
+ * libinput_shared_data_unref().
+ *
+ * @since 1.18
+ */
+struct libinput_shared_data;
+
+/**
+ * @ingroup base
+ * @struct libinput_loop
+ *
+ * A file descriptor set and timer shared by multiple libinput contexts.
+ * This struct is refcounted, use libinput_loop_ref() and
+ * libinput_loop_unref().
+ *
+ * @since 1.18
+ */
+struct libinput_loop;
+
 /**
  * @ingroup device
  * @struct libinput_device_group
@@ -1672,6 +1696,291 @@ double
 libinput_event_touch_get_y_transformed(struct libinput_event_touch *event,
 				       uint32_t height);
 
+/**
+ * @ingroup event_touch
+ *
+ * Enable or disable touch frame aggregation for this context. While
+ * enabled, libinput does not queue the @ref LIBINPUT_EVENT_TOUCH_DOWN,
+ * @ref LIBINPUT_EVENT_TOUCH_MOTION, @ref LIBINPUT_EVENT_TOUCH_UP and @ref
+ * LIBINPUT_EVENT_TOUCH_CANCEL events of a touch device. Instead, the
+ * @ref LIBINPUT_EVENT_TOUCH_FRAME event carries every slot that changed
+ * in that frame, see libinput_event_touch_get_frame_size().
+ *
+ * Aggregation affects every touch device in this context and is disabled
+ * by default. Enabling or disabling aggregation takes effect at the next
+ * touch frame.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable aggregation, zero to disable it
+ *
+ * @since 1.18
+ */
+void
+libinput_enable_touch_frame_aggregation(struct libinput *libinput,
+					int enable);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the number of slots that changed in this touch frame, see
+ * libinput_enable_touch_frame_aggregation(). The slots are ordered in the
+ * order the per-slot events would have been sent in.
+ *
+ * If touch frame aggregation is disabled, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_FRAME.
+ *
+ * @param event The libinput touch event
+ * @return The number of changed slots in this frame
+ *
+ * @since 1.18
+ */
+unsigned int
+libinput_event_touch_get_frame_size(struct libinput_event_touch *event);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the type of change for the given slot in this touch frame, one
+ * of @ref LIBINPUT_EVENT_TOUCH_DOWN, @ref LIBINPUT_EVENT_TOUCH_MOTION,
+ * @ref LIBINPUT_EVENT_TOUCH_UP or @ref LIBINPUT_EVENT_TOUCH_CANCEL. This
+ * is the type of the event that would have been sent without touch
+ * frame aggregation.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @return The type of change or @ref LIBINPUT_EVENT_NONE for an invalid
+ * index
+ *
+ * @since 1.18
+ */
+enum libinput_event_type
+libinput_event_touch_get_frame_type(struct libinput_event_touch *event,
+				    unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the slot of the given changed slot in this touch frame. See
+ * libinput_event_touch_get_slot() for details.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @return The slot or -1 for an invalid index
+ *
+ * @since 1.18
+ */
+int32_t
+libinput_event_touch_get_frame_slot(struct libinput_event_touch *event,
+				    unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the seat slot of the given changed slot in this touch frame. See
+ * libinput_event_touch_get_seat_slot() for details.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @return The seat slot or -1 for an invalid index
+ *
+ * @since 1.18
+ */
+int32_t
+libinput_event_touch_get_frame_seat_slot(struct libinput_event_touch *event,
+					 unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the absolute x coordinate of the given changed slot in this
+ * touch frame, in mm from the top left corner of the device. See
+ * libinput_event_touch_get_x() for details.
+ *
+ * For slots not of type @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @return The absolute x coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_frame_x(struct libinput_event_touch *event,
+				 unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the absolute y coordinate of the given changed slot in this
+ * touch frame, in mm from the top left corner of the device. See
+ * libinput_event_touch_get_y() for details.
+ *
+ * For slots not of type @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @return The absolute y coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_frame_y(struct libinput_event_touch *event,
+				 unsigned int index);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the absolute x coordinate of the given changed slot in this
+ * touch frame, transformed to screen coordinates. See
+ * libinput_event_touch_get_x_transformed() for details.
+ *
+ * For slots not of type @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @param width The current output screen width
+ * @return The transformed x coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_frame_x_transformed(struct libinput_event_touch *event,
+					     unsigned int index,
+					     uint32_t width);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the absolute y coordinate of the given changed slot in this
+ * touch frame, transformed to screen coordinates. See
+ * libinput_event_touch_get_y_transformed() for details.
+ *
+ * For slots not of type @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION, this function returns 0.
+ *
+ * @param event The libinput touch event
+ * @param index The slot index, must be less than the value returned by
+ * libinput_event_touch_get_frame_size()
+ * @param height The current output screen height
+ * @return The transformed y coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_frame_y_transformed(struct libinput_event_touch *event,
+					     unsigned int index,
+					     uint32_t height);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable motion prediction for touch and tablet tool events in
+ * this context. While enabled, libinput fits the recent positions of each
+ * touch and tablet tool with a least-squares velocity and acceleration
+ * estimate. The caller can then query where the touch or tool is expected
+ * to be at a time shortly after the event, e.g. at the time the next
+ * frame is presented on screen.
+ *
+ * The estimate is restarted whenever a touch or tool begins, the
+ * direction of motion changes by more than 90 degrees or no event was
+ * received for 50ms. The prediction confidence is 0 in those cases, see
+ * libinput_event_touch_get_prediction_confidence().
+ *
+ * Motion prediction is disabled by default. While disabled, the predicted
+ * position is always the position of the event.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable motion prediction, zero to disable it
+ *
+ * @since 1.18
+ */
+void
+libinput_enable_motion_prediction(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted x coordinate of this touch at the given time,
+ * transformed to screen coordinates, see
+ * libinput_enable_motion_prediction(). A time before the event time
+ * returns the event's position, predictions are limited to 50ms after
+ * the event time.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param time The time in microseconds, in the same clock as
+ * libinput_event_touch_get_time_usec()
+ * @param width The current output screen width
+ * @return The predicted x coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_predicted_x_transformed(struct libinput_event_touch *event,
+						 uint64_t time,
+						 uint32_t width);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the predicted y coordinate of this touch at the given time,
+ * transformed to screen coordinates. See
+ * libinput_event_touch_get_predicted_x_transformed() for details.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @param time The time in microseconds, in the same clock as
+ * libinput_event_touch_get_time_usec()
+ * @param height The current output screen height
+ * @return The predicted y coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_predicted_y_transformed(struct libinput_event_touch *event,
+						 uint64_t time,
+						 uint32_t height);
+
+/**
+ * @ingroup event_touch
+ *
+ * Return the confidence in the motion prediction for this event in the
+ * range [0, 1]. A confidence of 0 signals that the prediction was
+ * restarted, e.g. on a direction change, and the predicted position
+ * should not be used. The confidence increases with the number of
+ * consistent events the prediction is based on.
+ *
+ * If motion prediction is disabled, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TOUCH_DOWN or @ref
+ * LIBINPUT_EVENT_TOUCH_MOTION.
+ *
+ * @param event The libinput touch event
+ * @return The prediction confidence
+ *
+ * @since 1.18
+ */
+double
+libinput_event_touch_get_prediction_confidence(struct libinput_event_touch *event);
+
 /**
  * @ingroup event_touch
  *
@@ -2620,135 +2929,391 @@ libinput_event_tablet_tool_get_time_usec(struct libinput_event_tablet_tool *even
 /**
  * @ingroup event_tablet
  *
- * Return the high-level tool type for a tool object.
- *
- * The high level tool describes general interaction expected with the tool.
- * For example, a user would expect a tool of type @ref
- * LIBINPUT_TABLET_TOOL_TYPE_PEN to interact with a graphics application
- * taking pressure and tilt into account. The default virtual tool assigned
- * should be a drawing tool, e.g. a virtual pen or brush.
- * A tool of type @ref LIBINPUT_TABLET_TOOL_TYPE_ERASER would normally be
- * mapped to an eraser-like virtual tool.
+ * Enable or disable the coalescing of tablet tool axis events for this
+ * context. While enabled, a @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS event
+ * that is still in the event queue when the next axis event for the same
+ * tool is generated is updated to the new axis state instead of queuing a
+ * second event. The axis state it carried before is kept as a historical
+ * sample, see libinput_event_tablet_tool_get_history_size().
  *
- * If supported by the hardware, a more specific tool id is always
- * available, see libinput_tablet_tool_get_tool_id().
+ * Events are only coalesced with the most recent event in the queue, so
+ * the order of events is unchanged. Axis events are never coalesced
+ * across tip, button or proximity events or if the wheel axis changed.
+ * The relative deltas returned by libinput_event_tablet_tool_get_dx()
+ * and libinput_event_tablet_tool_get_dy() are the sum of the coalesced
+ * events, libinput_event_tablet_tool_*_has_changed() is true if the axis
+ * changed in any of the coalesced events.
  *
- * @param tool The libinput tool
- * @return The tool type for this tool object
+ * Coalescing is disabled by default.
  *
- * @see libinput_tablet_tool_get_tool_id
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable coalescing, zero to disable it
  *
- * @since 1.2
+ * @since 1.18
  */
-enum libinput_tablet_tool_type
-libinput_tablet_tool_get_type(struct libinput_tablet_tool *tool);
+void
+libinput_enable_tablet_tool_history(struct libinput *libinput, int enable);
 
 /**
  * @ingroup event_tablet
  *
- * Return the tool ID for a tool object. If nonzero, this number identifies
- * the specific type of the tool with more precision than the type returned in
- * libinput_tablet_tool_get_type(). Not all tablets support a tool ID.
- *
- * Tablets known to support tool IDs include the Wacom Intuos 3, 4, 5, Wacom
- * Cintiq and Wacom Intuos Pro series. The tool ID can be used to
- * distinguish between e.g. a Wacom Classic Pen or a Wacom Pro Pen.  It is
- * the caller's responsibility to interpret the tool ID.
+ * Return the number of historical samples in this event, see
+ * libinput_enable_tablet_tool_history(). The samples are ordered from
+ * oldest to newest, all samples are older than the current state of the
+ * event.
  *
- * @param tool The libinput tool
- * @return The tool ID for this tool object or 0 if none is provided
+ * For events other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS this
+ * function returns 0.
  *
- * @see libinput_tablet_tool_get_type
+ * @param event The libinput tablet tool event
+ * @return The number of historical samples in this event
  *
- * @since 1.2
+ * @since 1.18
  */
-uint64_t
-libinput_tablet_tool_get_tool_id(struct libinput_tablet_tool *tool);
+unsigned int
+libinput_event_tablet_tool_get_history_size(struct libinput_event_tablet_tool *event);
 
 /**
  * @ingroup event_tablet
  *
- * Increment the reference count of the tool by one. A tool is destroyed
- * whenever the reference count reaches 0. See libinput_tablet_tool_unref().
- *
- * @param tool The tool to increment the ref count of
- * @return The passed tool
+ * Return the X coordinate of the given historical sample, in mm from the
+ * top left corner of the device. See libinput_event_tablet_tool_get_x()
+ * for details.
  *
- * @see libinput_tablet_tool_unref
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @return The X coordinate of the sample, or 0 for an invalid index
  *
- * @since 1.2
+ * @since 1.18
  */
-struct libinput_tablet_tool *
-libinput_tablet_tool_ref(struct libinput_tablet_tool *tool);
+double
+libinput_event_tablet_tool_get_historical_x(struct libinput_event_tablet_tool *event,
+					    unsigned int index);
 
 /**
  * @ingroup event_tablet
  *
- * Decrement the reference count of the tool by one. When the reference
- * count of the tool reaches 0, the memory allocated for the tool will be
- * freed.
- *
- * @param tool The tool to decrement the ref count of
- * @return NULL if the tool was destroyed otherwise the passed tool
+ * Return the Y coordinate of the given historical sample, in mm from the
+ * top left corner of the device. See libinput_event_tablet_tool_get_y()
+ * for details.
  *
- * @see libinput_tablet_tool_ref
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @return The Y coordinate of the sample, or 0 for an invalid index
  *
- * @since 1.2
+ * @since 1.18
  */
-struct libinput_tablet_tool *
-libinput_tablet_tool_unref(struct libinput_tablet_tool *tool);
+double
+libinput_event_tablet_tool_get_historical_y(struct libinput_event_tablet_tool *event,
+					    unsigned int index);
 
 /**
  * @ingroup event_tablet
  *
- * Return whether the tablet tool supports pressure.
+ * Return the X coordinate of the given historical sample, transformed to
+ * screen coordinates. See libinput_event_tablet_tool_get_x_transformed()
+ * for details.
  *
- * @param tool The tool to check the axis capabilities of
- * @return Nonzero if the axis is available, zero otherwise.
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @param width The current output screen width
+ * @return The transformed X coordinate of the sample, or 0 for an invalid
+ * index
  *
- * @since 1.2
+ * @since 1.18
  */
-int
-libinput_tablet_tool_has_pressure(struct libinput_tablet_tool *tool);
+double
+libinput_event_tablet_tool_get_historical_x_transformed(struct libinput_event_tablet_tool *event,
+							unsigned int index,
+							uint32_t width);
 
 /**
  * @ingroup event_tablet
  *
- * Return whether the tablet tool supports distance.
+ * Return the Y coordinate of the given historical sample, transformed to
+ * screen coordinates. See libinput_event_tablet_tool_get_y_transformed()
+ * for details.
  *
- * @param tool The tool to check the axis capabilities of
- * @return Nonzero if the axis is available, zero otherwise.
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @param height The current output screen height
+ * @return The transformed Y coordinate of the sample, or 0 for an invalid
+ * index
  *
- * @since 1.2
+ * @since 1.18
  */
-int
-libinput_tablet_tool_has_distance(struct libinput_tablet_tool *tool);
+double
+libinput_event_tablet_tool_get_historical_y_transformed(struct libinput_event_tablet_tool *event,
+							unsigned int index,
+							uint32_t height);
 
 /**
  * @ingroup event_tablet
  *
- * Return whether the tablet tool supports tilt.
+ * Return the pressure of the given historical sample, normalized to the
+ * range [0, 1]. See libinput_event_tablet_tool_get_pressure() for
+ * details.
  *
- * @param tool The tool to check the axis capabilities of
- * @return Nonzero if the axis is available, zero otherwise.
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @return The pressure of the sample, or 0 for an invalid index
  *
- * @since 1.2
+ * @since 1.18
  */
-int
-libinput_tablet_tool_has_tilt(struct libinput_tablet_tool *tool);
+double
+libinput_event_tablet_tool_get_historical_pressure(struct libinput_event_tablet_tool *event,
+						   unsigned int index);
 
 /**
  * @ingroup event_tablet
  *
- * Return whether the tablet tool supports z-rotation.
+ * Return the X tilt of the given historical sample in degrees. See
+ * libinput_event_tablet_tool_get_tilt_x() for details.
  *
- * @param tool The tool to check the axis capabilities of
- * @return Nonzero if the axis is available, zero otherwise.
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @return The X tilt of the sample, or 0 for an invalid index
  *
- * @since 1.2
+ * @since 1.18
  */
-int
-libinput_tablet_tool_has_rotation(struct libinput_tablet_tool *tool);
+double
+libinput_event_tablet_tool_get_historical_tilt_x(struct libinput_event_tablet_tool *event,
+						 unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the Y tilt of the given historical sample in degrees. See
+ * libinput_event_tablet_tool_get_tilt_y() for details.
+ *
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @return The Y tilt of the sample, or 0 for an invalid index
+ *
+ * @since 1.18
+ */
+double
+libinput_event_tablet_tool_get_historical_tilt_y(struct libinput_event_tablet_tool *event,
+						 unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the timestamp of the given historical sample in microseconds.
+ *
+ * @param event The libinput tablet tool event
+ * @param index The sample index, must be less than the value returned by
+ * libinput_event_tablet_tool_get_history_size()
+ * @return The time of the sample in microseconds, or 0 for an invalid
+ * index
+ *
+ * @since 1.18
+ */
+uint64_t
+libinput_event_tablet_tool_get_historical_time_usec(struct libinput_event_tablet_tool *event,
+						    unsigned int index);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the predicted x coordinate of the tool at the given time,
+ * transformed to screen coordinates, see
+ * libinput_enable_motion_prediction(). A time before the event time
+ * returns the event's position, predictions are limited to 50ms after
+ * the event time.
+ *
+ * @note It is an application bug to call this function for events of type
+ * other than @ref LIBINPUT_EVENT_TABLET_TOOL_AXIS, @ref
+ * LIBINPUT_EVENT_TABLET_TOOL_TIP or @ref
+ * LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY.
+ *
+ * @param event The libinput tablet tool event
+ * @param time The time in microseconds, in the same clock as
+ * libinput_event_tablet_tool_get_time_usec()
+ * @param width The current output screen width
+ * @return The predicted x coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_tablet_tool_get_predicted_x_transformed(struct libinput_event_tablet_tool *event,
+						       uint64_t time,
+						       uint32_t width);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the predicted y coordinate of the tool at the given time,
+ * transformed to screen coordinates. See
+ * libinput_event_tablet_tool_get_predicted_x_transformed() for details.
+ *
+ * @param event The libinput tablet tool event
+ * @param time The time in microseconds, in the same clock as
+ * libinput_event_tablet_tool_get_time_usec()
+ * @param height The current output screen height
+ * @return The predicted y coordinate
+ *
+ * @since 1.18
+ */
+double
+libinput_event_tablet_tool_get_predicted_y_transformed(struct libinput_event_tablet_tool *event,
+						       uint64_t time,
+						       uint32_t height);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the confidence in the motion prediction for this event in the
+ * range [0, 1]. See libinput_event_touch_get_prediction_confidence() for
+ * details.
+ *
+ * @param event The libinput tablet tool event
+ * @return The prediction confidence
+ *
+ * @since 1.18
+ */
+double
+libinput_event_tablet_tool_get_prediction_confidence(struct libinput_event_tablet_tool *event);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the high-level tool type for a tool object.
+ *
+ * The high level tool describes general interaction expected with the tool.
+ * For example, a user would expect a tool of type @ref
+ * LIBINPUT_TABLET_TOOL_TYPE_PEN to interact with a graphics application
+ * taking pressure and tilt into account. The default virtual tool assigned
+ * should be a drawing tool, e.g. a virtual pen or brush.
+ * A tool of type @ref LIBINPUT_TABLET_TOOL_TYPE_ERASER would normally be
+ * mapped to an eraser-like virtual tool.
+ *
+ * If supported by the hardware, a more specific tool id is always
+ * available, see libinput_tablet_tool_get_tool_id().
+ *
+ * @param tool The libinput tool
+ * @return The tool type for this tool object
+ *
+ * @see libinput_tablet_tool_get_tool_id
+ *
+ * @since 1.2
+ */
+enum libinput_tablet_tool_type
+libinput_tablet_tool_get_type(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return the tool ID for a tool object. If nonzero, this number identifies
+ * the specific type of the tool with more precision than the type returned in
+ * libinput_tablet_tool_get_type(). Not all tablets support a tool ID.
+ *
+ * Tablets known to support tool IDs include the Wacom Intuos 3, 4, 5, Wacom
+ * Cintiq and Wacom Intuos Pro series. The tool ID can be used to
+ * distinguish between e.g. a Wacom Classic Pen or a Wacom Pro Pen.  It is
+ * the caller's responsibility to interpret the tool ID.
+ *
+ * @param tool The libinput tool
+ * @return The tool ID for this tool object or 0 if none is provided
+ *
+ * @see libinput_tablet_tool_get_type
+ *
+ * @since 1.2
+ */
+uint64_t
+libinput_tablet_tool_get_tool_id(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Increment the reference count of the tool by one. A tool is destroyed
+ * whenever the reference count reaches 0. See libinput_tablet_tool_unref().
+ *
+ * @param tool The tool to increment the ref count of
+ * @return The passed tool
+ *
+ * @see libinput_tablet_tool_unref
+ *
+ * @since 1.2
+ */
+struct libinput_tablet_tool *
+libinput_tablet_tool_ref(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Decrement the reference count of the tool by one. When the reference
+ * count of the tool reaches 0, the memory allocated for the tool will be
+ * freed.
+ *
+ * @param tool The tool to decrement the ref count of
+ * @return NULL if the tool was destroyed otherwise the passed tool
+ *
+ * @see libinput_tablet_tool_ref
+ *
+ * @since 1.2
+ */
+struct libinput_tablet_tool *
+libinput_tablet_tool_unref(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return whether the tablet tool supports pressure.
+ *
+ * @param tool The tool to check the axis capabilities of
+ * @return Nonzero if the axis is available, zero otherwise.
+ *
+ * @since 1.2
+ */
+int
+libinput_tablet_tool_has_pressure(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return whether the tablet tool supports distance.
+ *
+ * @param tool The tool to check the axis capabilities of
+ * @return Nonzero if the axis is available, zero otherwise.
+ *
+ * @since 1.2
+ */
+int
+libinput_tablet_tool_has_distance(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return whether the tablet tool supports tilt.
+ *
+ * @param tool The tool to check the axis capabilities of
+ * @return Nonzero if the axis is available, zero otherwise.
+ *
+ * @since 1.2
+ */
+int
+libinput_tablet_tool_has_tilt(struct libinput_tablet_tool *tool);
+
+/**
+ * @ingroup event_tablet
+ *
+ * Return whether the tablet tool supports z-rotation.
+ *
+ * @param tool The tool to check the axis capabilities of
+ * @return Nonzero if the axis is available, zero otherwise.
+ *
+ * @since 1.2
+ */
+int
+libinput_tablet_tool_has_rotation(struct libinput_tablet_tool *tool);
 
 /**
  * @ingroup event_tablet
@@ -3367,6 +3932,36 @@ int
 libinput_udev_assign_seat(struct libinput *libinput,
 			  const char *seat_id);
 
+/**
+ * @ingroup base
+ *
+ * Get the hotplug statistics of this context. Device additions and
+ * removals that arrive in a burst, e.g. when a docking station is
+ * connected, are queued until the burst has settled. A device that is
+ * removed again before it was added is never added at all.
+ *
+ * Any of the out parameters may be NULL.
+ *
+ * @param libinput A libinput context initialized with
+ * libinput_udev_create_context()
+ * @param[out] nevents The number of device add and remove events
+ * received from udev
+ * @param[out] ncancelled The number of those events that were dropped
+ * because a device was added and removed within the same burst
+ * @param[out] nstorms The number of bursts that were processed as one
+ * batch
+ *
+ * @return 0 on success or -1 if the context was not created with
+ * libinput_udev_create_context()
+ *
+ * @since 1.18
+ */
+int
+libinput_udev_get_hotplug_stats(struct libinput *libinput,
+				uint64_t *nevents,
+				uint64_t *ncancelled,
+				uint64_t *nstorms);
+
 /**
  * @ingroup base
  *
@@ -3414,6 +4009,42 @@ struct libinput_device *
 libinput_path_add_device(struct libinput *libinput,
 			 const char *path);
 
+/**
+ * @ingroup base
+ *
+ * Add multiple devices to a libinput context initialized with
+ * libinput_path_create_context(). This is equivalent to calling
+ * libinput_path_add_device() for each path but faster for large numbers
+ * of devices: libinput waits for udev to initialize all devices at once
+ * and sets up the interaction between the devices (e.g. disable-while-typing)
+ * only after all devices were initialized.
+ *
+ * The @ref LIBINPUT_EVENT_DEVICE_ADDED events are in the same order as
+ * the paths. A path that fails to initialize does not affect the other
+ * paths.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param paths An array of npaths paths to input devices
+ * @param npaths The number of elements in paths
+ * @param[out] devices An optional array of npaths elements. If not NULL,
+ * each element is set to the device initialized from the path at the
+ * same index, or NULL on failure. The lifetime of these pointers is the
+ * same as the return value of libinput_path_add_device().
+ *
+ * @return The number of devices added, or -1 if any path is NULL or too
+ * long, or if the context was not created with
+ * libinput_path_create_context()
+ *
+ * @see libinput_path_add_device
+ *
+ * @since 1.18
+ */
+int
+libinput_path_add_devices(struct libinput *libinput,
+			  const char **paths,
+			  size_t npaths,
+			  struct libinput_device **devices);
+
 /**
  * @ingroup base
  *
@@ -3469,72 +4100,370 @@ libinput_dispatch(struct libinput *libinput);
 /**
  * @ingroup base
  *
- * Retrieve the next event from libinput's internal event queue.
+ * Get the file descriptors libinput monitors internally, e.g. the device
+ * nodes, the timer and the udev monitor. A caller that integrates libinput
+ * into its own event loop may monitor these file descriptors directly
+ * instead of the file descriptor returned by libinput_get_fd() and call
+ * libinput_dispatch_source() for each file descriptor with data
+ * available.
  *
- * After handling the retrieved event, the caller must destroy it using
- * libinput_event_destroy().
+ * Sources come and go as devices are added and removed, use
+ * libinput_set_source_handler() to be notified of these changes.
+ *
+ * This function must not be used on a context attached to a loop, see
+ * libinput_attach_loop().
  *
  * @param libinput A previously initialized libinput context
- * @return The next available event, or NULL if no event is available.
+ * @param[out] fds An array to fill with the file descriptors
+ * @param nfds The number of elements in fds
+ * @return The total number of file descriptors, which may be greater than
+ * nfds, or -1 on failure
+ *
+ * @see libinput_dispatch_source
+ *
+ * @since 1.18
  */
-struct libinput_event *
-libinput_get_event(struct libinput *libinput);
+int
+libinput_get_source_fds(struct libinput *libinput,
+			int *fds,
+			size_t nfds);
 
 /**
  * @ingroup base
  *
- * Return the type of the next event in the internal queue. This function
- * does not pop the event off the queue and the next call to
- * libinput_get_event() returns that event.
+ * Process the data available on exactly one of the file descriptors
+ * returned by libinput_get_source_fds(). Use libinput_get_event() to
+ * retrieve the events. This function does not poll any other source.
  *
  * @param libinput A previously initialized libinput context
- * @return The event type of the next available event or @ref
- * LIBINPUT_EVENT_NONE if no event is available.
+ * @param fd A file descriptor returned by libinput_get_source_fds() or
+ * passed to the source handler
+ * @return 0 on success, -ENOENT if fd is not a source of this context, or
+ * -EINVAL if the context is attached to a loop
+ *
+ * @see libinput_get_source_fds
+ * @see libinput_set_source_handler
+ *
+ * @since 1.18
  */
-enum libinput_event_type
-libinput_next_event_type(struct libinput *libinput);
+int
+libinput_dispatch_source(struct libinput *libinput, int fd);
 
 /**
  * @ingroup base
  *
- * Set caller-specific data associated with this context. libinput does
- * not manage, look at, or modify this data. The caller must ensure the
- * data is valid.
+ * Describes how a source of a libinput context has changed, see
+ * libinput_set_source_handler().
  *
- * @param libinput A previously initialized libinput context
- * @param user_data Caller-specific data passed to the various callback
- * interfaces.
+ * @since 1.18
  */
-void
-libinput_set_user_data(struct libinput *libinput,
-		       void *user_data);
+enum libinput_source_change {
+	LIBINPUT_SOURCE_ADDED = 1,
+	LIBINPUT_SOURCE_REMOVED,
+};
 
 /**
  * @ingroup base
  *
- * Get the caller-specific data associated with this context, if any.
+ * Source handler type for a caller that monitors the sources of a libinput
+ * context directly. Use libinput_get_user_data() to access the
+ * caller-specific data.
  *
- * @param libinput A previously initialized libinput context
- * @return The caller-specific data previously assigned in
- * libinput_set_user_data(), libinput_path_create_context() or
- * libinput_udev_create_context().
+ * When a source is removed, the file descriptor is still valid while this
+ * handler runs but may be closed immediately afterwards.
+ *
+ * @param libinput The libinput context
+ * @param fd The file descriptor of the source
+ * @param change Whether the source was added or removed
+ *
+ * @since 1.18
  */
-void *
-libinput_get_user_data(struct libinput *libinput);
+typedef void (*libinput_source_handler)(struct libinput *libinput,
+					int fd,
+					enum libinput_source_change change);
 
 /**
  * @ingroup base
  *
- * Resume a suspended libinput context. This re-enables device
- * monitoring and adds existing devices.
+ * Set the handler called whenever a source is added to or removed from
+ * the context. The handler is not called for sources that exist when it
+ * is set, use libinput_get_source_fds() to retrieve those.
  *
  * @param libinput A previously initialized libinput context
- * @see libinput_suspend
+ * @param handler The handler to call, or NULL to unset it
  *
- * @return 0 on success or -1 on failure
+ * @see libinput_get_source_fds
+ *
+ * @since 1.18
  */
-int
-libinput_resume(struct libinput *libinput);
+void
+libinput_set_source_handler(struct libinput *libinput,
+			    libinput_source_handler handler);
+
+/**
+ * @ingroup base
+ *
+ * Create a new loop that multiple libinput contexts can be attached to
+ * with libinput_attach_loop(). All contexts attached to the loop share a
+ * single epoll file descriptor and a single timer file descriptor, so a
+ * caller with many contexts, e.g. one context per seat, only needs to
+ * monitor one file descriptor and is woken up once for timers that expire
+ * close together in different contexts.
+ *
+ * The loop is not protected against concurrent access, all contexts
+ * attached to a loop must be used from the same thread.
+ *
+ * @return A new loop with a refcount of 1, or NULL on failure
+ *
+ * @see libinput_attach_loop
+ *
+ * @since 1.18
+ */
+struct libinput_loop *
+libinput_loop_new(void);
+
+/**
+ * @ingroup base
+ *
+ * Add a reference to the loop.
+ *
+ * @param loop A previously created loop
+ * @return The passed loop
+ *
+ * @since 1.18
+ */
+struct libinput_loop *
+libinput_loop_ref(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Drop a reference to the loop. The loop is destroyed once the caller and
+ * all contexts attached to it have released their reference.
+ *
+ * @param loop A previously created loop
+ * @return NULL if the loop was destroyed, otherwise the passed loop
+ *
+ * @since 1.18
+ */
+struct libinput_loop *
+libinput_loop_unref(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * libinput keeps a single file descriptor for all contexts attached to
+ * this loop. Call libinput_loop_dispatch() once data is available on this
+ * file descriptor. For any attached context, libinput_get_fd() returns
+ * the same file descriptor.
+ *
+ * @param loop A previously created loop
+ * @return The file descriptor used to notify the caller of pending events
+ *
+ * @since 1.18
+ */
+int
+libinput_loop_get_fd(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Read events and handle timers of all contexts attached to this loop.
+ * Use libinput_get_event() on each context to retrieve its events.
+ * Calling libinput_dispatch() on any context attached to the loop is
+ * equivalent to calling this function.
+ *
+ * @param loop A previously created loop
+ * @return 0 on success, or a negative errno on failure
+ *
+ * @see libinput_dispatch
+ *
+ * @since 1.18
+ */
+int
+libinput_loop_dispatch(struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Attach the context to the loop. The context takes a reference to the
+ * loop and uses the loop's file descriptors instead of its own. The
+ * context stays attached until it is destroyed.
+ *
+ * This function must be called once, after creating the context and
+ * before assigning a seat with libinput_udev_assign_seat() or adding a
+ * device with libinput_path_add_device().
+ *
+ * @param libinput A previously initialized libinput context
+ * @param loop A previously created loop
+ * @return 0 on success or -1 if the context could not be attached
+ *
+ * @see libinput_loop_new
+ *
+ * @since 1.18
+ */
+int
+libinput_attach_loop(struct libinput *libinput,
+		     struct libinput_loop *loop);
+
+/**
+ * @ingroup base
+ *
+ * Advance the clock of this libinput context by the given number of
+ * microseconds without waiting for that time to pass.
+ *
+ * libinput's clock is CLOCK_MONOTONIC. After this call, libinput's
+ * internal clock, its timers and the timestamps of all events read from
+ * the kernel are offset by the accumulated amount. Event timestamps
+ * returned to the caller reflect the advanced clock.
+ *
+ * Any timers that expire within the skipped time are handled during the
+ * next call to libinput_dispatch(). Events pending on the file descriptor
+ * are considered to have happened after the skipped time, a caller should
+ * call libinput_dispatch() before advancing the clock to process those
+ * events first.
+ *
+ * This function is intended for test suites and replay tools that need to
+ * trigger timeouts deterministically without sleeping. A caller that
+ * compares event timestamps against the system clock must not use this
+ * function.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param usec The number of microseconds to advance the clock by
+ *
+ * @since 1.18
+ */
+void
+libinput_clock_advance(struct libinput *libinput, uint64_t usec);
+
+/**
+ * @ingroup base
+ *
+ * Retrieve the next event from libinput's internal event queue.
+ *
+ * After handling the retrieved event, the caller must destroy it using
+ * libinput_event_destroy().
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The next available event, or NULL if no event is available.
+ */
+struct libinput_event *
+libinput_get_event(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Return the type of the next event in the internal queue. This function
+ * does not pop the event off the queue and the next call to
+ * libinput_get_event() returns that event.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The event type of the next available event or @ref
+ * LIBINPUT_EVENT_NONE if no event is available.
+ */
+enum libinput_event_type
+libinput_next_event_type(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Mask or unmask an event type. Events of a masked type are discarded by
+ * libinput before they are added to the event queue and, where possible,
+ * before they are created, avoiding the cost of building and queuing
+ * events the caller is not interested in. Masking an event type does not
+ * change libinput's internal behavior, e.g. a keyboard with masked @ref
+ * LIBINPUT_EVENT_KEYBOARD_KEY events still disables the touchpad while
+ * typing.
+ *
+ * All event types are unmasked by default. The @ref
+ * LIBINPUT_EVENT_DEVICE_ADDED and @ref LIBINPUT_EVENT_DEVICE_REMOVED
+ * events cannot be masked.
+ *
+ * Masking an event type only affects events generated after this call.
+ * Events already in the queue are not discarded.
+ *
+ * @note Masking an event type may leave the caller with an incomplete
+ * sequence of events. For example, if @ref LIBINPUT_EVENT_TOUCH_FRAME is
+ * masked, the caller will not see the end of a touch frame and a caller
+ * that masks @ref LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN but not
+ * @ref LIBINPUT_EVENT_GESTURE_SWIPE_END will see swipe end events without
+ * the matching begin event.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param type The event type to mask or unmask
+ * @param masked Non-zero to mask the event type, zero to unmask it
+ *
+ * @return 0 on success or -1 if the event type is invalid or cannot be
+ * masked
+ *
+ * @see libinput_get_event_mask
+ *
+ * @since 1.18
+ */
+int
+libinput_set_event_mask(struct libinput *libinput,
+			enum libinput_event_type type,
+			int masked);
+
+/**
+ * @ingroup base
+ *
+ * Check if an event type is masked, see libinput_set_event_mask().
+ *
+ * @param libinput A previously initialized libinput context
+ * @param type The event type to check
+ *
+ * @return 1 if the event type is masked, 0 otherwise
+ *
+ * @see libinput_set_event_mask
+ *
+ * @since 1.18
+ */
+int
+libinput_get_event_mask(struct libinput *libinput,
+			enum libinput_event_type type);
+
+/**
+ * @ingroup base
+ *
+ * Set caller-specific data associated with this context. libinput does
+ * not manage, look at, or modify this data. The caller must ensure the
+ * data is valid.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param user_data Caller-specific data passed to the various callback
+ * interfaces.
+ */
+void
+libinput_set_user_data(struct libinput *libinput,
+		       void *user_data);
+
+/**
+ * @ingroup base
+ *
+ * Get the caller-specific data associated with this context, if any.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The caller-specific data previously assigned in
+ * libinput_set_user_data(), libinput_path_create_context() or
+ * libinput_udev_create_context().
+ */
+void *
+libinput_get_user_data(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Resume a suspended libinput context. This re-enables device
+ * monitoring and adds existing devices.
+ *
+ * @param libinput A previously initialized libinput context
+ * @see libinput_suspend
+ *
+ * @return 0 on success or -1 on failure
+ */
+int
+libinput_resume(struct libinput *libinput);
 
 /**
  * @ingroup base
@@ -3544,10 +4473,313 @@ libinput_resume(struct libinput *libinput);
  * valid to be resumed with libinput_resume().
  *
  * @param libinput A previously initialized libinput context
+ * @see libinput_enable_warm_suspend
  */
 void
 libinput_suspend(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Enable or disable warm suspend for this context. By default,
+ * libinput_suspend() removes all devices and libinput_resume() adds and
+ * probes them again as if they were newly plugged in.
+ *
+ * With warm suspend enabled, libinput_suspend() only closes the file
+ * descriptors of the devices; the devices themselves, their
+ * configuration and their internal state are kept. libinput_resume()
+ * re-opens each device and re-syncs its state with the kernel. No @ref
+ * LIBINPUT_EVENT_DEVICE_REMOVED and @ref LIBINPUT_EVENT_DEVICE_ADDED
+ * events are sent for these devices. A device that was unplugged while
+ * suspended, or whose device node now refers to a different device, is
+ * removed on resume and any new device is added as usual.
+ *
+ * Warm suspend is only supported by contexts created with
+ * libinput_udev_create_context(). For other contexts this setting has
+ * no effect.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable warm suspend, zero to disable it
+ *
+ * @since 1.18
+ */
+void
+libinput_enable_warm_suspend(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable reading the devices through io_uring. By default,
+ * libinput monitors every device file descriptor and reads the events of
+ * each device with separate read() calls.
+ *
+ * With io_uring enabled, the events of all devices with data available
+ * are read in a single system call per libinput_dispatch(), which reduces
+ * the per-device overhead when many devices send events at the same time.
+ * libinput_get_source_fds() returns a single file descriptor for all
+ * devices read through io_uring.
+ *
+ * This setting only affects devices added after this call. Where the
+ * kernel does not support the required io_uring features, this function
+ * returns -1 and devices are read with read() as usual.
+ *
+ * If the context is to be attached to a loop with libinput_attach_loop(),
+ * it must be attached before io_uring is enabled.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable io_uring, zero to disable it
+ * @return 0 on success or -1 if io_uring is not available
+ *
+ * @since 1.18
+ */
+int
+libinput_enable_io_uring(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable the export of this context's events to other
+ * processes. With the export enabled, every event queued for the caller
+ * is also written as a fixed-size struct libinput_event_export_record
+ * into a ring in shared memory. Another process, e.g. an accessibility
+ * or telemetry service, can map the ring with
+ * libinput_event_export_reader_new() and observe the processed event
+ * stream without opening the devices itself.
+ *
+ * The ring is backed by a memfd, use libinput_get_event_export_fd() and
+ * pass that file descriptor to the observers. Writing into the ring never
+ * blocks: once the ring is full, the oldest records are overwritten and
+ * observers that have not read them yet count them as overflow, see
+ * libinput_event_export_reader_get_overflow_count().
+ *
+ * Events masked with libinput_set_event_mask() are not exported. Tablet
+ * tool axis events coalesced with libinput_enable_tablet_tool_history()
+ * are exported once per sample, i.e. observers see the axis events the
+ * caller would see with coalescing disabled.
+ *
+ * Enabling the export again replaces the ring with a new one, observers
+ * of the previous ring no longer receive records.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param size The minimum number of records the ring can hold, rounded up
+ * to the next power of two. Zero disables the export.
+ * @return 0 on success or -1 if the ring could not be created
+ *
+ * @see libinput_get_event_export_fd
+ *
+ * @since 1.18
+ */
+int
+libinput_enable_event_export(struct libinput *libinput, unsigned int size);
+
+/**
+ * @ingroup base
+ *
+ * Get the file descriptor of the event export ring. The file descriptor
+ * is read-only and remains owned by libinput, a caller passing it to
+ * another process must duplicate it or send it with SCM_RIGHTS.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return A read-only fd of the memfd backing the ring, or -1 if the
+ * export is not enabled
+ *
+ * @see libinput_enable_event_export
+ *
+ * @since 1.18
+ */
+int
+libinput_get_event_export_fd(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * A single exported event, see libinput_enable_event_export(). The
+ * meaning of code, state, x and y depends on the event type:
+ *
+ * - @ref LIBINPUT_EVENT_KEYBOARD_KEY: code is the key, state the key state
+ * - @ref LIBINPUT_EVENT_POINTER_MOTION: x/y are the accelerated deltas
+ * - @ref LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: x/y in mm
+ * - @ref LIBINPUT_EVENT_POINTER_BUTTON: code is the button, state the
+ *   button state
+ * - @ref LIBINPUT_EVENT_POINTER_AXIS: code is the axis source, x/y the
+ *   horizontal and vertical scroll values
+ * - touch events: code is the seat slot, x/y in mm for down and motion
+ * - tablet tool events: x/y in mm, code is the button and state the
+ *   button state, the tip state or the proximity state
+ * - tablet pad events: code is the button, key, ring or strip number,
+ *   state the button or key state, x the ring or strip position
+ * - gesture events: code is the finger count, state is nonzero for a
+ *   cancelled gesture, x/y are the accelerated deltas
+ * - @ref LIBINPUT_EVENT_SWITCH_TOGGLE: code is the switch, state the
+ *   switch state
+ *
+ * Fields not listed for an event type are zero.
+ *
+ * @since 1.18
+ */
+struct libinput_event_export_record {
+	/** The event time in microseconds */
+	uint64_t time_usec;
+	/** The enum libinput_event_type */
+	uint32_t type;
+	/** A number identifying the device within the context, assigned
+	 * when the device is added and not reused */
+	uint32_t device_id;
+	uint32_t code;
+	int32_t state;
+	double x;
+	double y;
+};
+
+/**
+ * @ingroup base
+ * @struct libinput_event_export_reader
+ *
+ * A handle to read exported events from an event export ring, see
+ * libinput_event_export_reader_new().
+ *
+ * @since 1.18
+ */
+struct libinput_event_export_reader;
+
+/**
+ * @ingroup base
+ *
+ * Map an event export ring for reading. This function is used by the
+ * observing process and does not require a libinput context. The reader
+ * only sees records written after it was created.
+ *
+ * Reading records does not require any system calls, a caller that needs
+ * to wait for records has to poll the ring periodically.
+ *
+ * @param fd The file descriptor returned by
+ * libinput_get_event_export_fd() in the exporting process. The caller
+ * may close the file descriptor after this call.
+ * @return A new reader, or NULL if fd is not an event export ring
+ *
+ * @since 1.18
+ */
+struct libinput_event_export_reader *
+libinput_event_export_reader_new(int fd);
+
+/**
+ * @ingroup base
+ *
+ * Unmap the ring and destroy the reader.
+ *
+ * @param reader A reader created with libinput_event_export_reader_new()
+ *
+ * @since 1.18
+ */
+void
+libinput_event_export_reader_destroy(struct libinput_event_export_reader *reader);
+
+/**
+ * @ingroup base
+ *
+ * Copy the next record from the ring.
+ *
+ * @param reader A reader created with libinput_event_export_reader_new()
+ * @param[out] record The record
+ * @return 1 if a record was read, or 0 if no new record is available
+ *
+ * @since 1.18
+ */
+int
+libinput_event_export_reader_read(struct libinput_event_export_reader *reader,
+				  struct libinput_event_export_record *record);
+
+/**
+ * @ingroup base
+ *
+ * Get the number of records this reader has missed because they were
+ * overwritten before they were read.
+ *
+ * @param reader A reader created with libinput_event_export_reader_new()
+ * @return The number of records lost to overflow
+ *
+ * @since 1.18
+ */
+uint64_t
+libinput_event_export_reader_get_overflow_count(struct libinput_event_export_reader *reader);
+
+/**
+ * @ingroup base
+ *
+ * Create a new handle for data that can be shared between multiple
+ * libinput contexts. The device quirks and the libwacom database are
+ * loaded once, the first time a context using this handle requires them.
+ * Callers that create more than one context, e.g. one context per seat,
+ * should create one handle and attach it to each context with
+ * libinput_attach_shared_data().
+ *
+ * Messages from loading the device quirks, e.g. parser errors, are logged
+ * through the context that loads them. Messages from matching the quirks
+ * to a device are logged through the context of that device.
+ *
+ * The data is not protected against concurrent access, all contexts
+ * sharing a handle must be used from the same thread.
+ *
+ * @return A new handle with a refcount of 1
+ *
+ * @see libinput_attach_shared_data
+ *
+ * @since 1.18
+ */
+struct libinput_shared_data *
+libinput_shared_data_new(void);
+
+/**
+ * @ingroup base
+ *
+ * Add a reference to the shared data handle.
+ *
+ * @param data A previously created shared data handle
+ * @return The passed handle
+ *
+ * @since 1.18
+ */
+struct libinput_shared_data *
+libinput_shared_data_ref(struct libinput_shared_data *data);
+
+/**
+ * @ingroup base
+ *
+ * Drop a reference to the shared data handle. The handle is destroyed
+ * once the caller and all contexts it is attached to have released
+ * their reference.
+ *
+ * @param data A previously created shared data handle
+ * @return NULL if the handle was destroyed, otherwise the passed handle
+ *
+ * @since 1.18
+ */
+struct libinput_shared_data *
+libinput_shared_data_unref(struct libinput_shared_data *data);
+
+/**
+ * @ingroup base
+ *
+ * Attach the shared data handle to this context. The context takes a
+ * reference to the handle and uses the device quirks and the libwacom
+ * database of the handle instead of loading its own copy.
+ *
+ * This function must be called once, after creating the context and
+ * before assigning a seat with libinput_udev_assign_seat() or adding a
+ * device with libinput_path_add_device().
+ *
+ * @param libinput A previously initialized libinput context
+ * @param data A previously created shared data handle
+ * @return 0 on success or -1 if the handle could not be attached
+ *
+ * @see libinput_shared_data_new
+ *
+ * @since 1.18
+ */
+int
+libinput_attach_shared_data(struct libinput *libinput,
+			    struct libinput_shared_data *data);
+
 /**
  * @ingroup base
  *
@@ -3668,6 +4900,56 @@ void
 libinput_log_set_handler(struct libinput *libinput,
 			 libinput_log_handler log_handler);
 
+/**
+ * @ingroup base
+ *
+ * Set the size of the context's log ring. When the log ring is enabled,
+ * every log message is recorded in an in-memory ring of the given number
+ * of messages, regardless of the context's log priority and log handler.
+ * Once the ring is full, the oldest messages are overwritten.
+ *
+ * Recording a message only stores its arguments, the message is not
+ * formatted until the ring is dumped with libinput_log_dump_ring(). This
+ * makes it possible to keep a history of debug messages at a fraction of
+ * the cost of the log handler and only retrieve it when needed, e.g.
+ * after a bug was observed.
+ *
+ * Changing the size discards all messages currently in the ring. A size
+ * of zero disables the log ring, this is the default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param size The maximum number of messages in the log ring
+ *
+ * @see libinput_log_dump_ring
+ *
+ * @since 1.18
+ */
+void
+libinput_log_set_ring_size(struct libinput *libinput, unsigned int size);
+
+/**
+ * @ingroup base
+ *
+ * Write the messages in the context's log ring to the given file
+ * descriptor, oldest first. Each message is prefixed with its timestamp
+ * and priority and terminated by a newline. The log ring is left
+ * unmodified.
+ *
+ * This function does not allocate memory. It formats the messages with
+ * the C library's printf functions and is thus not async-signal-safe.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param fd The file descriptor to write to
+ *
+ * @return The number of messages written
+ *
+ * @see libinput_log_set_ring_size
+ *
+ * @since 1.18
+ */
+unsigned int
+libinput_log_dump_ring(struct libinput *libinput, int fd);
+
 /**
  * @defgroup seat Initialization and manipulation of seats
  *
@@ -4035,38 +5317,139 @@ libinput_device_set_seat_logical_name(struct libinput_device *device,
 /**
  * @ingroup device
  *
- * Return a udev handle to the device that is this libinput device, if any.
- * The returned handle has a refcount of at least 1, the caller must call
- * <i>udev_device_unref()</i> once to release the associated resources.
- * See the [libudev documentation]
- * (http://www.freedesktop.org/software/systemd/libudev/) for details.
+ * Return a udev handle to the device that is this libinput device, if any.
+ * The returned handle has a refcount of at least 1, the caller must call
+ * <i>udev_device_unref()</i> once to release the associated resources.
+ * See the [libudev documentation]
+ * (http://www.freedesktop.org/software/systemd/libudev/) for details.
+ *
+ * Some devices may not have a udev device, or the udev device may be
+ * unobtainable. This function returns NULL if no udev device was available.
+ *
+ * Calling this function multiple times for the same device may not
+ * return the same udev handle each time.
+ *
+ * @param device A previously obtained device
+ * @return A udev handle to the device with a refcount of >= 1 or NULL.
+ * @retval NULL This device is not represented by a udev device
+ */
+struct udev_device *
+libinput_device_get_udev_device(struct libinput_device *device);
+
+/**
+ * @ingroup device
+ *
+ * Update the LEDs on the device, if any. If the device does not have
+ * LEDs, or does not have one or more of the LEDs given in the mask, this
+ * function does nothing.
+ *
+ * @param device A previously obtained device
+ * @param leds A mask of the LEDs to set, or unset.
+ */
+void
+libinput_device_led_update(struct libinput_device *device,
+			   enum libinput_led leds);
+
+/**
+ * @ingroup device
+ *
+ * Processing stages measured by the stage counters, see
+ * libinput_enable_stage_counters(). Stages may be nested, e.g. the time
+ * spent in @ref LIBINPUT_STAGE_TP_PALM is included in the time spent in
+ * @ref LIBINPUT_STAGE_TP_PROCESS_STATE.
+ *
+ * @since 1.18
+ */
+enum libinput_stage {
+	/** Reading events from the kernel device */
+	LIBINPUT_STAGE_READ = 0,
+	/** Touchpad: touch state updates before processing */
+	LIBINPUT_STAGE_TP_PRE_PROCESS_STATE,
+	/** Touchpad: touch state processing, includes the thumb, palm,
+	 * button and edge scroll stages */
+	LIBINPUT_STAGE_TP_PROCESS_STATE,
+	/** Touchpad: thumb detection */
+	LIBINPUT_STAGE_TP_THUMB,
+	/** Touchpad: palm detection */
+	LIBINPUT_STAGE_TP_PALM,
+	/** Touchpad: physical and software button state handling */
+	LIBINPUT_STAGE_TP_BUTTONS,
+	/** Touchpad: edge scroll state handling */
+	LIBINPUT_STAGE_TP_EDGE_SCROLL,
+	/** Touchpad: event generation, includes the tap stage */
+	LIBINPUT_STAGE_TP_POST_EVENTS,
+	/** Touchpad: tap state machine */
+	LIBINPUT_STAGE_TP_TAP,
+	/** Touchpad: gesture state handling and gesture event generation,
+	 * this stage is split across the touch state processing and the
+	 * event generation stages */
+	LIBINPUT_STAGE_TP_GESTURE,
+	/** Mouse, keyboard, touchscreen and switch frame processing */
+	LIBINPUT_STAGE_FALLBACK_HANDLE_STATE,
+	/** Tablet frame processing */
+	LIBINPUT_STAGE_TABLET_FLUSH,
+	/** Pointer acceleration */
+	LIBINPUT_STAGE_FILTER_DISPATCH,
+};
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable the stage counters for all devices in this context.
+ * While enabled, libinput accumulates the number of invocations, the
+ * time and, where the CPU provides a cycle counter, the number of CPU
+ * cycles spent in each of the @ref libinput_stage processing stages for
+ * each device. The counters are retrieved with
+ * libinput_device_get_stage_counters().
+ *
+ * The stage counters are disabled by default. Measuring each stage adds
+ * a small overhead, this is intended for debugging and profiling only.
+ * Disabling the stage counters does not reset them.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enable Non-zero to enable the stage counters, zero to disable
+ *
+ * @since 1.18
+ */
+void
+libinput_enable_stage_counters(struct libinput *libinput, int enable);
+
+/**
+ * @ingroup device
+ *
+ * Get the stage counters for the given processing stage of this device,
+ * see libinput_enable_stage_counters(). Any of the out parameters may be
+ * NULL.
  *
- * Some devices may not have a udev device, or the udev device may be
- * unobtainable. This function returns NULL if no udev device was available.
+ * @param device A previously obtained device
+ * @param stage The processing stage
+ * @param[out] count The number of times the stage was run
+ * @param[out] nsec The time spent in this stage in nanoseconds
+ * @param[out] cycles The CPU cycles spent in this stage, always 0 if the
+ * CPU does not have a cycle counter usable by libinput
  *
- * Calling this function multiple times for the same device may not
- * return the same udev handle each time.
+ * @return 0 on success or -1 if the stage is invalid
  *
- * @param device A previously obtained device
- * @return A udev handle to the device with a refcount of >= 1 or NULL.
- * @retval NULL This device is not represented by a udev device
+ * @since 1.18
  */
-struct udev_device *
-libinput_device_get_udev_device(struct libinput_device *device);
+int
+libinput_device_get_stage_counters(struct libinput_device *device,
+				   enum libinput_stage stage,
+				   uint64_t *count,
+				   uint64_t *nsec,
+				   uint64_t *cycles);
 
 /**
  * @ingroup device
  *
- * Update the LEDs on the device, if any. If the device does not have
- * LEDs, or does not have one or more of the LEDs given in the mask, this
- * function does nothing.
+ * Reset all stage counters of this device to zero.
  *
  * @param device A previously obtained device
- * @param leds A mask of the LEDs to set, or unset.
+ *
+ * @since 1.18
  */
 void
-libinput_device_led_update(struct libinput_device *device,
-			   enum libinput_led leds);
+libinput_device_reset_stage_counters(struct libinput_device *device);
 
 /**
  * @ingroup device
@@ -4694,6 +6077,127 @@ libinput_device_config_tap_get_drag_lock_enabled(struct libinput_device *device)
 enum libinput_config_drag_lock_state
 libinput_device_config_tap_get_default_drag_lock_enabled(struct libinput_device *device);
 
+/**
+ * @ingroup config
+ *
+ * @since 1.18
+ */
+enum libinput_config_tap_adaptive_timeout_state {
+	/** The tap timeouts are fixed */
+	LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED,
+	/** The tap timeouts adapt to the user */
+	LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED,
+};
+
+/**
+ * @ingroup config
+ *
+ * Enable or disable adaptive tap timeouts on this device.
+ *
+ * After a tap, libinput waits for a timeout before it releases the
+ * button, in case the tap is the first half of a double-tap or a
+ * tap-and-drag. With adaptive timeouts enabled, libinput records the
+ * time between a tap and the next touch of a double-tap or tap-and-drag
+ * and shortens the timeout to what this user actually needs. The
+ * timeout never exceeds the default timeout.
+ *
+ * libinput only learns while adaptive timeouts are enabled, and the
+ * learned intervals are discarded when the device is removed.
+ *
+ * @param device The device to configure
+ * @param enable @ref LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED to
+ * enable adaptive timeouts, @ref
+ * LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED to disable them
+ *
+ * @return A config status code. Disabling adaptive timeouts on a device
+ * that does not support tapping always succeeds.
+ *
+ * @see libinput_device_config_tap_get_adaptive_timeout_enabled
+ * @see libinput_device_config_tap_get_default_adaptive_timeout_enabled
+ * @see libinput_device_get_tap_timeout_stats
+ *
+ * @since 1.18
+ */
+enum libinput_config_status
+libinput_device_config_tap_set_adaptive_timeout_enabled(struct libinput_device *device,
+							enum libinput_config_tap_adaptive_timeout_state enable);
+
+/**
+ * @ingroup config
+ *
+ * Check if adaptive tap timeouts are enabled on this device. If the
+ * device does not support tapping, this function always returns
+ * @ref LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED.
+ *
+ * @param device The device to configure
+ *
+ * @retval LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED If adaptive
+ * timeouts are currently enabled
+ * @retval LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED If adaptive
+ * timeouts are currently disabled
+ *
+ * @see libinput_device_config_tap_set_adaptive_timeout_enabled
+ * @see libinput_device_config_tap_get_default_adaptive_timeout_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_tap_adaptive_timeout_state
+libinput_device_config_tap_get_adaptive_timeout_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if adaptive tap timeouts are enabled by default on this device.
+ * This is always @ref LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED.
+ *
+ * @param device The device to configure
+ *
+ * @retval LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED If adaptive
+ * timeouts are enabled by default
+ * @retval LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED If adaptive
+ * timeouts are disabled by default
+ *
+ * @see libinput_device_config_tap_set_adaptive_timeout_enabled
+ * @see libinput_device_config_tap_get_adaptive_timeout_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_tap_adaptive_timeout_state
+libinput_device_config_tap_get_default_adaptive_timeout_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Get the tap timeout statistics for this device. These statistics
+ * are collected whether or not adaptive tap timeouts are enabled and
+ * can be used to measure the latency adaptive timeouts save.
+ *
+ * Any of the out parameters may be NULL.
+ *
+ * @param device The device to query
+ * @param[out] timeout_usec The current timeout after a single-finger
+ * tap, in microseconds
+ * @param[out] ntaps The number of taps whose button release was sent
+ * after the timeout expired
+ * @param[out] saved_usec The total time in microseconds by which those
+ * button releases were sent earlier than with the default timeout
+ * @param[out] nsplit The number of times a touch started after the
+ * adaptive timeout but before the default timeout, i.e. a double-tap
+ * or tap-and-drag that was split into two taps
+ *
+ * @return 0 on success or -1 if the device does not support tapping
+ *
+ * @see libinput_device_config_tap_set_adaptive_timeout_enabled
+ *
+ * @since 1.18
+ */
+int
+libinput_device_get_tap_timeout_stats(struct libinput_device *device,
+				      uint64_t *timeout_usec,
+				      uint64_t *ntaps,
+				      uint64_t *saved_usec,
+				      uint64_t *nsplit);
+
 /**
  * @ingroup config
  *
@@ -5927,6 +7431,394 @@ libinput_device_config_rotation_get_angle(struct libinput_device *device);
 unsigned int
 libinput_device_config_rotation_get_default_angle(struct libinput_device *device);
 
+/**
+ * @ingroup config
+ *
+ * @since 1.18
+ */
+enum libinput_config_passthrough_state {
+	LIBINPUT_CONFIG_PASSTHROUGH_DISABLED,
+	LIBINPUT_CONFIG_PASSTHROUGH_ENABLED,
+};
+
+/**
+ * @ingroup config
+ *
+ * Check if this device supports raw passthrough. Raw passthrough is
+ * usually available on mice, keyboards and other devices with relative
+ * motion, buttons or keys, but not on touchpads, touchscreens or tablets.
+ *
+ * @param device The device to configure
+ * @return 0 if this device does not support raw passthrough, or 1
+ * otherwise.
+ *
+ * @see libinput_device_config_passthrough_set_enabled
+ * @see libinput_device_config_passthrough_get_enabled
+ * @see libinput_device_config_passthrough_get_default_enabled
+ *
+ * @since 1.18
+ */
+int
+libinput_device_config_passthrough_is_available(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Enable or disable raw passthrough. When enabled, the device's
+ * relative motion, wheel, button and key events are sent to the caller
+ * as they come from the device, without any of libinput's processing.
+ * Specifically, in raw passthrough mode:
+ * - button events are not debounced
+ * - middle button emulation and button scrolling are not available
+ * - the left-handed configuration does not swap the buttons
+ * - rotation and pointer acceleration are not applied, the accelerated
+ *   deltas of @ref LIBINPUT_EVENT_POINTER_MOTION events are identical
+ *   to the unaccelerated deltas
+ * - a middle button press does not inhibit wheel events
+ *
+ * The configuration of those features is retained and applies again once
+ * raw passthrough is disabled. Raw passthrough is intended for clients
+ * with low latency requirements like games that apply their own
+ * processing of the device data.
+ *
+ * @note Enabling or disabling raw passthrough takes effect at the end of
+ * the next hardware event frame that has no buttons logically down.
+ *
+ * @param device The device to configure
+ * @param enable @ref LIBINPUT_CONFIG_PASSTHROUGH_DISABLED to disable
+ * raw passthrough, @ref LIBINPUT_CONFIG_PASSTHROUGH_ENABLED to enable
+ *
+ * @return A config status code. Disabling raw passthrough on a device
+ * that does not support the feature always succeeds.
+ *
+ * @see libinput_device_config_passthrough_is_available
+ * @see libinput_device_config_passthrough_get_enabled
+ * @see libinput_device_config_passthrough_get_default_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_status
+libinput_device_config_passthrough_set_enabled(struct libinput_device *device,
+					       enum libinput_config_passthrough_state enable);
+
+/**
+ * @ingroup config
+ *
+ * Check if raw passthrough is currently configured on this device. If
+ * the device does not support raw passthrough, this function returns
+ * @ref LIBINPUT_CONFIG_PASSTHROUGH_DISABLED.
+ *
+ * @note The return value reflects the configuration, the change may not
+ * have taken effect yet, see
+ * libinput_device_config_passthrough_set_enabled().
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_PASSTHROUGH_DISABLED if disabled, @ref
+ * LIBINPUT_CONFIG_PASSTHROUGH_ENABLED if enabled.
+ *
+ * @see libinput_device_config_passthrough_is_available
+ * @see libinput_device_config_passthrough_set_enabled
+ * @see libinput_device_config_passthrough_get_default_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_passthrough_state
+libinput_device_config_passthrough_get_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if raw passthrough is enabled on this device by default. This is
+ * always @ref LIBINPUT_CONFIG_PASSTHROUGH_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_PASSTHROUGH_DISABLED if disabled, @ref
+ * LIBINPUT_CONFIG_PASSTHROUGH_ENABLED if enabled.
+ *
+ * @see libinput_device_config_passthrough_is_available
+ * @see libinput_device_config_passthrough_set_enabled
+ * @see libinput_device_config_passthrough_get_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_passthrough_state
+libinput_device_config_passthrough_get_default_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * The smoothing method of a tablet selects how the position and tilt of a
+ * tablet tool are filtered before they are sent to the caller.
+ *
+ * @since 1.18
+ */
+enum libinput_config_tablet_smoothing_method {
+	/**
+	 * Do not smooth the tool's position and tilt.
+	 */
+	LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE = 0,
+	/**
+	 * Average the position and tilt over the last few hardware events.
+	 * This removes jitter at a constant lag of a few events,
+	 * regardless of the tool's speed.
+	 */
+	LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE = (1 << 0),
+	/**
+	 * Filter the position and tilt depending on the tool's speed. A
+	 * slow-moving tool is smoothed heavily, a fast-moving tool is
+	 * smoothed little, if at all, to keep the lag to a minimum.
+	 *
+	 * @see libinput_device_config_tablet_smoothing_set_responsiveness
+	 */
+	LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE = (1 << 1),
+};
+
+/**
+ * @ingroup config
+ *
+ * Check which smoothing methods a tablet supports.
+ *
+ * @param device The device to configure
+ * @return A bitmask of possible methods, or 0 if the device is not a
+ * tablet.
+ *
+ * @see libinput_device_config_tablet_smoothing_set_method
+ * @see libinput_device_config_tablet_smoothing_get_method
+ * @see libinput_device_config_tablet_smoothing_get_default_method
+ *
+ * @since 1.18
+ */
+uint32_t
+libinput_device_config_tablet_smoothing_get_methods(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Set the smoothing method for this tablet. Changing the method resets
+ * the smoothing state, the next event is sent as it comes from the
+ * device.
+ *
+ * @param device The device to configure
+ * @param method The smoothing method
+ *
+ * @return A config status code. Setting
+ * @ref LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE on a device that is not a
+ * tablet always succeeds.
+ *
+ * @see libinput_device_config_tablet_smoothing_get_methods
+ * @see libinput_device_config_tablet_smoothing_get_method
+ * @see libinput_device_config_tablet_smoothing_get_default_method
+ *
+ * @since 1.18
+ */
+enum libinput_config_status
+libinput_device_config_tablet_smoothing_set_method(struct libinput_device *device,
+						   enum libinput_config_tablet_smoothing_method method);
+
+/**
+ * @ingroup config
+ *
+ * Get the smoothing method for this tablet.
+ *
+ * @param device The device to configure
+ * @return The current smoothing method
+ *
+ * @see libinput_device_config_tablet_smoothing_get_methods
+ * @see libinput_device_config_tablet_smoothing_set_method
+ * @see libinput_device_config_tablet_smoothing_get_default_method
+ *
+ * @since 1.18
+ */
+enum libinput_config_tablet_smoothing_method
+libinput_device_config_tablet_smoothing_get_method(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Get the default smoothing method for this tablet. This is
+ * @ref LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE on most tablets and
+ * @ref LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE on tablets that are known
+ * to smooth in the firmware already.
+ *
+ * @param device The device to configure
+ * @return The default smoothing method
+ *
+ * @see libinput_device_config_tablet_smoothing_get_methods
+ * @see libinput_device_config_tablet_smoothing_set_method
+ * @see libinput_device_config_tablet_smoothing_get_method
+ *
+ * @since 1.18
+ */
+enum libinput_config_tablet_smoothing_method
+libinput_device_config_tablet_smoothing_get_default_method(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Set the responsiveness of the @ref
+ * LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE smoothing method, normalized
+ * to a range of [0, 1]. A value of 0 removes the most jitter at the cost
+ * of lag, a value of 1 keeps the lag to a minimum at the cost of jitter.
+ *
+ * The responsiveness can be set independently of the current smoothing
+ * method, it has no effect unless the method is @ref
+ * LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE.
+ *
+ * @param device The device to configure
+ * @param responsiveness The normalized responsiveness, in the range [0, 1]
+ *
+ * @return A config status code
+ *
+ * @see libinput_device_config_tablet_smoothing_get_responsiveness
+ * @see libinput_device_config_tablet_smoothing_get_default_responsiveness
+ *
+ * @since 1.18
+ */
+enum libinput_config_status
+libinput_device_config_tablet_smoothing_set_responsiveness(struct libinput_device *device,
+							   double responsiveness);
+
+/**
+ * @ingroup config
+ *
+ * Get the current responsiveness of the @ref
+ * LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE smoothing method. For
+ * devices that are not tablets, this function returns 0.
+ *
+ * @param device The device to configure
+ * @return The normalized responsiveness, in the range [0, 1]
+ *
+ * @see libinput_device_config_tablet_smoothing_set_responsiveness
+ * @see libinput_device_config_tablet_smoothing_get_default_responsiveness
+ *
+ * @since 1.18
+ */
+double
+libinput_device_config_tablet_smoothing_get_responsiveness(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Get the default responsiveness of the @ref
+ * LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE smoothing method. For
+ * devices that are not tablets, this function returns 0.
+ *
+ * @param device The device to configure
+ * @return The default normalized responsiveness, in the range [0, 1]
+ *
+ * @see libinput_device_config_tablet_smoothing_set_responsiveness
+ * @see libinput_device_config_tablet_smoothing_get_responsiveness
+ *
+ * @since 1.18
+ */
+double
+libinput_device_config_tablet_smoothing_get_default_responsiveness(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * @since 1.18
+ */
+enum libinput_config_gesture_low_latency_state {
+	LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED,
+	LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED,
+};
+
+/**
+ * @ingroup config
+ *
+ * Check if this device supports low-latency gesture detection. This is
+ * usually available on touchpads only.
+ *
+ * @param device The device to configure
+ * @return 0 if this device does not support low-latency gesture
+ * detection, or 1 otherwise.
+ *
+ * @see libinput_device_config_gesture_low_latency_set_enabled
+ * @see libinput_device_config_gesture_low_latency_get_enabled
+ * @see libinput_device_config_gesture_low_latency_get_default_enabled
+ *
+ * @since 1.18
+ */
+int
+libinput_device_config_gesture_low_latency_is_available(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Enable or disable low-latency gesture detection.
+ *
+ * When multiple fingers are down, libinput holds back all events until
+ * the fingers have moved far enough, or long enough, to tell whether
+ * the user is scrolling, swiping or pinching. With low-latency gesture
+ * detection enabled, libinput compares the common motion of the
+ * fingers against the change in distance between them and commits to
+ * a gesture as soon as one of them clearly dominates. Where that is not
+ * clear, e.g. with a resting thumb, the regular detection applies.
+ *
+ * In this mode, the motion made before the gesture was detected is not
+ * discarded but included in the first @ref
+ * LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE or @ref
+ * LIBINPUT_EVENT_GESTURE_PINCH_UPDATE event of the gesture.
+ *
+ * @param device The device to configure
+ * @param enable @ref LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED to
+ * enable low-latency gesture detection, @ref
+ * LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED to disable it
+ *
+ * @return A config status code. Disabling low-latency gesture detection
+ * on a device that does not support the feature always succeeds.
+ *
+ * @see libinput_device_config_gesture_low_latency_is_available
+ * @see libinput_device_config_gesture_low_latency_get_enabled
+ * @see libinput_device_config_gesture_low_latency_get_default_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_status
+libinput_device_config_gesture_low_latency_set_enabled(struct libinput_device *device,
+							enum libinput_config_gesture_low_latency_state enable);
+
+/**
+ * @ingroup config
+ *
+ * Check if low-latency gesture detection is enabled on this device. If
+ * the device does not support low-latency gesture detection, this
+ * function returns @ref LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED if disabled,
+ * @ref LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED if enabled.
+ *
+ * @see libinput_device_config_gesture_low_latency_is_available
+ * @see libinput_device_config_gesture_low_latency_set_enabled
+ * @see libinput_device_config_gesture_low_latency_get_default_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_gesture_low_latency_state
+libinput_device_config_gesture_low_latency_get_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if low-latency gesture detection is enabled on this device by
+ * default. This is always @ref
+ * LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED if disabled,
+ * @ref LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED if enabled.
+ *
+ * @see libinput_device_config_gesture_low_latency_is_available
+ * @see libinput_device_config_gesture_low_latency_set_enabled
+ * @see libinput_device_config_gesture_low_latency_get_enabled
+ *
+ * @since 1.18
+ */
+enum libinput_config_gesture_low_latency_state
+libinput_device_config_gesture_low_latency_get_default_enabled(struct libinput_device *device);
+
 #ifdef __cplusplus
 }
 #endif
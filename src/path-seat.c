@@ -170,10 +170,10 @@ out:
 	return seat;
 }
 
-static struct libinput_device *
-path_device_enable(struct path_input *input,
-		   struct udev_device *udev_device,
-		   const char *seat_logical_name_override)
+static struct evdev_device *
+path_device_probe(struct path_input *input,
+		  struct udev_device *udev_device,
+		  const char *seat_logical_name_override)
 {
 	struct path_seat *seat;
 	struct evdev_device *device = NULL;
@@ -187,7 +187,7 @@ path_device_enable(struct path_input *input,
 	if (!seat)
 		goto out;
 
-	device = evdev_device_create(&seat->base, udev_device);
+	device = evdev_device_probe(&seat->base, udev_device);
 	libinput_seat_unref(&seat->base);
 
 	if (device == EVDEV_UNHANDLED_DEVICE) {
@@ -210,7 +210,25 @@ path_device_enable(struct path_input *input,
 	device->output_name = safe_strdup(output_name);
 
 out:
-	return device ? &device->base : NULL;
+	return device;
+}
+
+static struct libinput_device *
+path_device_enable(struct path_input *input,
+		   struct udev_device *udev_device,
+		   const char *seat_logical_name_override)
+{
+	struct evdev_device *device;
+
+	device = path_device_probe(input,
+				   udev_device,
+				   seat_logical_name_override);
+	if (!device)
+		return NULL;
+
+	evdev_notify_added_device(device);
+
+	return &device->base;
 }
 
 static int
@@ -250,21 +268,21 @@ path_input_destroy(struct libinput *input)
 
 }
 
-static struct libinput_device *
-path_create_device(struct libinput *libinput,
-		   struct udev_device *udev_device,
-		   const char *seat_name)
+static struct evdev_device *
+path_create_device_probe(struct libinput *libinput,
+			 struct udev_device *udev_device,
+			 const char *seat_name)
 {
 	struct path_input *input = (struct path_input*)libinput;
 	struct path_device *dev;
-	struct libinput_device *device;
+	struct evdev_device *device;
 
 	dev = zalloc(sizeof *dev);
 	dev->udev_device = udev_device_ref(udev_device);
 
 	list_insert(&input->path_list, &dev->link);
 
-	device = path_device_enable(input, udev_device, seat_name);
+	device = path_device_probe(input, udev_device, seat_name);
 
 	if (!device)
 		path_device_destroy(dev);
@@ -272,6 +290,22 @@ path_create_device(struct libinput *libinput,
 	return device;
 }
 
+static struct libinput_device *
+path_create_device(struct libinput *libinput,
+		   struct udev_device *udev_device,
+		   const char *seat_name)
+{
+	struct evdev_device *device;
+
+	device = path_create_device_probe(libinput, udev_device, seat_name);
+	if (!device)
+		return NULL;
+
+	evdev_notify_added_device(device);
+
+	return &device->base;
+}
+
 static int
 path_device_change_seat(struct libinput_device *device,
 			const char *seat_name)
@@ -326,33 +360,80 @@ libinput_path_create_context(const struct libinput_interface *interface,
 	return &input->base;
 }
 
-static inline struct udev_device *
-udev_device_from_devnode(struct libinput *libinput,
-			 struct udev *udev,
-			 const char *devnode)
+/* Look up the udev devices for all devnodes, waiting for those udev
+ * hasn't initialized yet. The wait is shared between all devnodes, so
+ * a batch takes as long as its slowest device, not the sum of all */
+static void
+udev_devices_from_devnodes(struct libinput *libinput,
+			   struct udev *udev,
+			   const char **devnodes,
+			   size_t ndevnodes,
+			   struct udev_device **udev_devices)
 {
-	struct udev_device *dev;
-	struct stat st;
+	dev_t *devnums = zalloc(ndevnodes * sizeof(*devnums));
+	size_t npending = 0;
 	size_t count = 0;
 
-	if (stat(devnode, &st) < 0)
-		return NULL;
+	for (size_t i = 0; i < ndevnodes; i++) {
+		struct stat st;
 
-	dev = udev_device_new_from_devnum(udev, 'c', st.st_rdev);
+		udev_devices[i] = NULL;
 
-	while (dev && !udev_device_get_is_initialized(dev)) {
-		udev_device_unref(dev);
+		if (stat(devnodes[i], &st) < 0)
+			continue;
+
+		devnums[i] = st.st_rdev;
+		udev_devices[i] = udev_device_new_from_devnum(udev, 'c', devnums[i]);
+		if (udev_devices[i] &&
+		    !udev_device_get_is_initialized(udev_devices[i]))
+			npending++;
+	}
+
+	while (npending > 0) {
 		count++;
-		if (count > 200) {
-			log_bug_libinput(libinput,
-					"udev device never initialized (%s)\n",
-					devnode);
-			return NULL;
-		}
+		if (count > 200)
+			break;
+
 		msleep(10);
-		dev = udev_device_new_from_devnum(udev, 'c', st.st_rdev);
+
+		npending = 0;
+		for (size_t i = 0; i < ndevnodes; i++) {
+			if (!udev_devices[i] ||
+			    udev_device_get_is_initialized(udev_devices[i]))
+				continue;
+
+			udev_device_unref(udev_devices[i]);
+			udev_devices[i] = udev_device_new_from_devnum(udev, 'c', devnums[i]);
+			if (udev_devices[i] &&
+			    !udev_device_get_is_initialized(udev_devices[i]))
+				npending++;
+		}
+	}
+
+	for (size_t i = 0; npending > 0 && i < ndevnodes; i++) {
+		if (!udev_devices[i] ||
+		    udev_device_get_is_initialized(udev_devices[i]))
+			continue;
+
+		log_bug_libinput(libinput,
+				 "udev device never initialized (%s)\n",
+				 devnodes[i]);
+		udev_device_unref(udev_devices[i]);
+		udev_devices[i] = NULL;
 	}
 
+	free(devnums);
+}
+
+static inline struct udev_device *
+udev_device_from_devnode(struct libinput *libinput,
+			 struct udev *udev,
+			 const char *devnode)
+{
+	struct udev_device *dev;
+
+	udev_devices_from_devnodes(libinput, udev, &devnode, 1, &dev);
+
 	return dev;
 }
 
@@ -400,6 +481,85 @@ libinput_path_add_device(struct libinput *libinput,
 	return device;
 }
 
+LIBINPUT_EXPORT int
+libinput_path_add_devices(struct libinput *libinput,
+			  const char **paths,
+			  size_t npaths,
+			  struct libinput_device **devices)
+{
+	struct path_input *input = (struct path_input *)libinput;
+	struct udev_device **udev_devices;
+	struct evdev_device **probed;
+	int nadded = 0;
+
+	if (libinput->interface_backend != &interface_backend) {
+		log_bug_client(libinput, "Mismatching backends.\n");
+		return -1;
+	}
+
+	if (!paths) {
+		log_bug_client(libinput, "Invalid path array\n");
+		return -1;
+	}
+
+	if (npaths == 0)
+		return 0;
+
+	for (size_t i = 0; i < npaths; i++) {
+		if (!paths[i] || strlen(paths[i]) > PATH_MAX) {
+			log_bug_client(libinput,
+				       "Unexpected path, limited to %d characters.\n",
+				       PATH_MAX);
+			return -1;
+		}
+	}
+
+	udev_devices = zalloc(npaths * sizeof(*udev_devices));
+	probed = zalloc(npaths * sizeof(*probed));
+
+	udev_devices_from_devnodes(libinput,
+				   input->udev,
+				   paths,
+				   npaths,
+				   udev_devices);
+
+	libinput_init_quirks(libinput);
+
+	for (size_t i = 0; i < npaths; i++) {
+		if (!udev_devices[i]) {
+			log_bug_client(libinput, "Invalid path %s\n", paths[i]);
+			continue;
+		}
+
+		if (ignore_litest_test_suite_device(udev_devices[i]))
+			continue;
+
+		probed[i] = path_create_device_probe(libinput,
+						     udev_devices[i],
+						     NULL);
+	}
+
+	/* Pair and announce the devices only once all of them are
+	 * probed, in the order they were given */
+	for (size_t i = 0; i < npaths; i++) {
+		if (probed[i]) {
+			evdev_notify_added_device(probed[i]);
+			nadded++;
+		}
+
+		if (devices)
+			devices[i] = probed[i] ? &probed[i]->base : NULL;
+
+		if (udev_devices[i])
+			udev_device_unref(udev_devices[i]);
+	}
+
+	free(udev_devices);
+	free(probed);
+
+	return nadded;
+}
+
 LIBINPUT_EXPORT void
 libinput_path_remove_device(struct libinput_device *device)
 {
@@ -1167,6 +1167,13 @@ quirks_context_ref(struct quirks_context *ctx)
 	return ctx;
 }
 
+void
+quirks_context_set_log_target(struct quirks_context *ctx,
+			      struct libinput *libinput)
+{
+	ctx->libinput = libinput;
+}
+
 struct quirks_context *
 quirks_context_unref(struct quirks_context *ctx)
 {
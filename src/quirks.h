@@ -181,6 +181,14 @@ quirks_context_unref(struct quirks_context *ctx);
 struct quirks_context *
 quirks_context_ref(struct quirks_context *ctx);
 
+/**
+ * Change the libinput struct passed to the log handler, e.g. for a
+ * context shared between several libinput contexts.
+ */
+void
+quirks_context_set_log_target(struct quirks_context *ctx,
+			      struct libinput *libinput);
+
 /**
  * Fetch the quirks for a given device. If no quirks are defined, this
  * function returns NULL.
@@ -31,6 +31,7 @@
 
 #include "libinput-private.h"
 #include "timer.h"
+#include "util-trace.h"
 
 void
 libinput_timer_init(struct libinput_timer *timer,
@@ -40,9 +41,11 @@ libinput_timer_init(struct libinput_timer *timer,
 		    void *timer_func_data)
 {
 	timer->libinput = libinput;
+	timer->device = NULL;
 	timer->timer_name = safe_strdup(timer_name);
 	timer->timer_func = timer_func;
 	timer->timer_func_data = timer_func_data;
+	timer->slack = 0;
 }
 
 void
@@ -58,29 +61,120 @@ libinput_timer_destroy(struct libinput_timer *timer)
 	free(timer->timer_name);
 }
 
+static inline uint64_t
+libinput_timer_deadline(struct libinput_timer *timer)
+{
+	return timer->expire + timer->slack;
+}
+
+static inline uint64_t
+libinput_timer_real_expiry(struct libinput *libinput, uint64_t expiry)
+{
+	if (expiry == UINT64_MAX)
+		return UINT64_MAX;
+
+	/* The timerfd runs on the real clock, our expiry times include the
+	 * offset from libinput_clock_advance(). Anything in the past is
+	 * handled in libinput_dispatch() anyway, so just make sure we don't
+	 * disarm the timerfd */
+	if (expiry <= libinput->clock.offset)
+		return 1;
+
+	return expiry - libinput->clock.offset;
+}
+
+/**
+ * Arm the loop's timerfd for the earliest expiry any of its contexts has
+ * armed its timer for.
+ */
+static int
+libinput_loop_arm_timer_fd(struct libinput_loop *loop)
+{
+	struct libinput *libinput;
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+	uint64_t expiry = UINT64_MAX;
+	int r;
+
+	if (loop->timer.dispatching)
+		return 0;
+
+	list_for_each(libinput, &loop->contexts, loop_link) {
+		expiry = min(expiry,
+			     libinput_timer_real_expiry(libinput,
+							libinput->timer.armed_expiry));
+	}
+
+	if (expiry == loop->timer.armed_expiry)
+		return 0;
+
+	if (expiry != UINT64_MAX) {
+		its.it_value.tv_sec = expiry / ms2us(1000);
+		its.it_value.tv_nsec = (expiry % ms2us(1000)) * 1000;
+	}
+
+	r = timerfd_settime(loop->timer.fd, TFD_TIMER_ABSTIME, &its, NULL);
+	loop->timer.armed_expiry = expiry;
+
+	return r;
+}
+
 static void
-libinput_timer_arm_timer_fd(struct libinput *libinput)
+libinput_timer_program_timer_fd(struct libinput *libinput, uint64_t expiry)
 {
 	int r;
-	struct libinput_timer *timer;
 	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
-	uint64_t earliest_expire = UINT64_MAX;
 
-	list_for_each(timer, &libinput->timer.list, link) {
-		if (timer->expire < earliest_expire)
-			earliest_expire = timer->expire;
+	if (libinput->loop) {
+		libinput->timer.armed_expiry = expiry;
+		if (libinput_loop_arm_timer_fd(libinput->loop))
+			log_error(libinput,
+				  "timer: timerfd_settime error: %s\n",
+				  strerror(errno));
+		return;
 	}
 
-	if (earliest_expire != UINT64_MAX) {
-		its.it_value.tv_sec = earliest_expire / ms2us(1000);
-		its.it_value.tv_nsec = (earliest_expire % ms2us(1000)) * 1000;
+	if (expiry != UINT64_MAX) {
+		uint64_t expire = libinput_timer_real_expiry(libinput, expiry);
+
+		its.it_value.tv_sec = expire / ms2us(1000);
+		its.it_value.tv_nsec = (expire % ms2us(1000)) * 1000;
 	}
 
 	r = timerfd_settime(libinput->timer.fd, TFD_TIMER_ABSTIME, &its, NULL);
 	if (r)
 		log_error(libinput, "timer: timerfd_settime error: %s\n", strerror(errno));
 
+	libinput->timer.armed_expiry = expiry;
+}
+
+/**
+ * Re-arm the timerfd for the earliest timer deadline, unless it's already
+ * armed for that time.
+ *
+ * Timers are set and cancelled frequently (e.g. the DWT timer is pushed
+ * back on every key press), so the timerfd is not re-armed on every
+ * change. It only needs to be armed at or before the earliest deadline:
+ * libinput_timer_set() re-arms it when a deadline moves earlier, any later
+ * deadline or a cancelled timer results in an early wakeup that we handle
+ * in libinput_timer_handler() before calling this function again.
+ */
+static void
+libinput_timer_arm_timer_fd(struct libinput *libinput)
+{
+	struct libinput_timer *timer;
+	uint64_t earliest_expire = UINT64_MAX;
+	uint64_t earliest_deadline = UINT64_MAX;
+
+	list_for_each(timer, &libinput->timer.list, link) {
+		earliest_expire = min(earliest_expire, timer->expire);
+		earliest_deadline = min(earliest_deadline,
+					libinput_timer_deadline(timer));
+	}
+
 	libinput->timer.next_expiry = earliest_expire;
+
+	if (earliest_deadline != libinput->timer.armed_expiry)
+		libinput_timer_program_timer_fd(libinput, earliest_deadline);
 }
 
 void
@@ -110,7 +204,17 @@ libinput_timer_set_flags(struct libinput_timer *timer,
 		list_insert(&timer->libinput->timer.list, &timer->link);
 
 	timer->expire = expire;
-	libinput_timer_arm_timer_fd(timer->libinput);
+
+	if (expire < timer->libinput->timer.next_expiry)
+		timer->libinput->timer.next_expiry = expire;
+
+	/* The timer handler re-arms once all timer funcs have run */
+	if (timer->libinput->timer.dispatching)
+		return;
+
+	if (libinput_timer_deadline(timer) < timer->libinput->timer.armed_expiry)
+		libinput_timer_program_timer_fd(timer->libinput,
+						libinput_timer_deadline(timer));
 }
 
 void
@@ -125,9 +229,22 @@ libinput_timer_cancel(struct libinput_timer *timer)
 	if (!timer->expire)
 		return;
 
+	/* Leave the timerfd armed, see libinput_timer_arm_timer_fd() */
 	timer->expire = 0;
 	list_remove(&timer->link);
-	libinput_timer_arm_timer_fd(timer->libinput);
+}
+
+void
+libinput_timer_set_slack(struct libinput_timer *timer, uint64_t slack)
+{
+	timer->slack = slack;
+}
+
+void
+libinput_timer_set_device(struct libinput_timer *timer,
+			  struct libinput_device *device)
+{
+	timer->device = device;
 }
 
 static void
@@ -135,6 +252,8 @@ libinput_timer_handler(struct libinput *libinput , uint64_t now)
 {
 	struct libinput_timer *timer;
 
+	libinput->timer.dispatching = true;
+
 restart:
 	list_for_each(timer, &libinput->timer.list, link) {
 		if (timer->expire == 0)
@@ -143,6 +262,12 @@ restart:
 		if (timer->expire <= now) {
 			/* Clear the timer before calling timer_func,
 			   as timer_func may re-arm it */
+			trace_probe(timer_fire,
+				    libinput,
+				    timer->device,
+				    timer->timer_name,
+				    timer->expire,
+				    now);
 			libinput_timer_cancel(timer);
 			timer->timer_func(now, timer->timer_func_data);
 
@@ -157,6 +282,9 @@ restart:
 			goto restart;
 		}
 	}
+
+	libinput->timer.dispatching = false;
+	libinput_timer_arm_timer_fd(libinput);
 }
 
 static void
@@ -174,13 +302,101 @@ libinput_timer_dispatch(void *data)
 				 errno,
 				 strerror(errno));
 
+	/* If we read an expiration, the timerfd is now disarmed. If not,
+	 * it was re-armed since it became readable and is still armed */
+	if (r == sizeof(discard))
+		libinput->timer.armed_expiry = UINT64_MAX;
+
 	now = libinput_now(libinput);
-	if (now == 0)
+	if (now == 0) {
+		libinput_timer_arm_timer_fd(libinput);
 		return;
+	}
 
 	libinput_timer_handler(libinput, now);
 }
 
+static void
+libinput_loop_timer_dispatch(void *data)
+{
+	struct libinput_loop *loop = data;
+	struct libinput *libinput;
+	uint64_t discard;
+	int r;
+
+	r = read(loop->timer.fd, &discard, sizeof(discard));
+	if (r == sizeof(discard))
+		loop->timer.armed_expiry = UINT64_MAX;
+
+	/* Every context re-arms for its own earliest deadline, the loop's
+	 * timerfd is armed once for the earliest of those afterwards */
+	loop->timer.dispatching = true;
+	list_for_each(libinput, &loop->contexts, loop_link) {
+		uint64_t now;
+
+		libinput->timer.armed_expiry = UINT64_MAX;
+
+		now = libinput_now(libinput);
+		if (now == 0)
+			libinput_timer_arm_timer_fd(libinput);
+		else
+			libinput_timer_handler(libinput, now);
+	}
+	loop->timer.dispatching = false;
+
+	if (libinput_loop_arm_timer_fd(loop) &&
+	    !list_empty(&loop->contexts)) {
+		libinput = list_first_entry(&loop->contexts,
+					    libinput,
+					    loop_link);
+		log_error(libinput,
+			  "timer: timerfd_settime error: %s\n",
+			  strerror(errno));
+	}
+}
+
+int
+libinput_loop_timer_init(struct libinput_loop *loop)
+{
+	loop->timer.fd = timerfd_create(CLOCK_MONOTONIC,
+					TFD_CLOEXEC | TFD_NONBLOCK);
+	if (loop->timer.fd < 0)
+		return -1;
+
+	loop->timer.armed_expiry = UINT64_MAX;
+
+	loop->timer.source = libinput_loop_add_fd(loop,
+						  loop->timer.fd,
+						  libinput_loop_timer_dispatch,
+						  loop);
+	if (!loop->timer.source) {
+		close(loop->timer.fd);
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+libinput_loop_timer_destroy(struct libinput_loop *loop)
+{
+	libinput_loop_remove_source(loop, loop->timer.source);
+	close(loop->timer.fd);
+}
+
+void
+libinput_timer_subsys_attach_loop(struct libinput *libinput)
+{
+	/* The loop's timerfd replaces ours */
+	libinput_remove_source(libinput, libinput->timer.source);
+	close(libinput->timer.fd);
+	libinput->timer.source = NULL;
+	libinput->timer.fd = -1;
+
+	libinput->timer.armed_expiry = UINT64_MAX;
+	libinput_timer_arm_timer_fd(libinput);
+}
+
 int
 libinput_timer_subsys_init(struct libinput *libinput)
 {
@@ -190,6 +406,8 @@ libinput_timer_subsys_init(struct libinput *libinput)
 		return -1;
 
 	list_init(&libinput->timer.list);
+	libinput->timer.next_expiry = UINT64_MAX;
+	libinput->timer.armed_expiry = UINT64_MAX;
 
 	libinput->timer.source = libinput_add_fd(libinput,
 						 libinput->timer.fd,
@@ -221,8 +439,18 @@ libinput_timer_subsys_destroy(struct libinput *libinput)
 	/* All timer users should have destroyed their timers now */
 	assert(list_empty(&libinput->timer.list));
 
-	libinput_remove_source(libinput, libinput->timer.source);
-	close(libinput->timer.fd);
+	if (libinput->timer.source) {
+		libinput_remove_source(libinput, libinput->timer.source);
+		close(libinput->timer.fd);
+	}
+}
+
+void
+libinput_timer_clock_advanced(struct libinput *libinput)
+{
+	/* Our next expiry is now earlier in real time, force a re-arm */
+	libinput->timer.armed_expiry = 0;
+	libinput_timer_arm_timer_fd(libinput);
 }
 
 /**
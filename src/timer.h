@@ -29,12 +29,16 @@
 #include "libinput-util.h"
 
 struct libinput;
+struct libinput_loop;
+struct libinput_device;
 
 struct libinput_timer {
 	struct libinput *libinput;
+	struct libinput_device *device; /* may be NULL */
 	char *timer_name;
 	struct list link;
 	uint64_t expire; /* in absolute us CLOCK_MONOTONIC */
+	uint64_t slack; /* in us, see libinput_timer_set_slack() */
 	void (*timer_func)(uint64_t now, void *timer_func_data);
 	void *timer_func_data;
 };
@@ -65,13 +69,35 @@ libinput_timer_set_flags(struct libinput_timer *timer,
 void
 libinput_timer_cancel(struct libinput_timer *timer);
 
+/* Allow the timer to fire up to slack us after its expiry time so its
+ * wakeup can be merged with that of other timers. */
+void
+libinput_timer_set_slack(struct libinput_timer *timer, uint64_t slack);
+
+/* The device the timer belongs to, used for tracing only */
+void
+libinput_timer_set_device(struct libinput_timer *timer,
+			  struct libinput_device *device);
+
 int
 libinput_timer_subsys_init(struct libinput *libinput);
 
 void
 libinput_timer_subsys_destroy(struct libinput *libinput);
 
+void
+libinput_timer_subsys_attach_loop(struct libinput *libinput);
+
+int
+libinput_loop_timer_init(struct libinput_loop *loop);
+
+void
+libinput_loop_timer_destroy(struct libinput_loop *loop);
+
 void
 libinput_timer_flush(struct libinput *libinput, uint64_t now);
 
+void
+libinput_timer_clock_advanced(struct libinput *libinput);
+
 #endif
@@ -24,6 +24,7 @@
 
 #include "config.h"
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -46,31 +47,14 @@ static inline bool
 filter_duplicates(struct udev_seat *udev_seat,
 		  struct udev_device *udev_device)
 {
-	struct libinput_device *device;
 	const char *new_syspath = udev_device_get_syspath(udev_device);
-	bool ignore_device = false;
 
-	if (!udev_seat)
+	if (!udev_seat || !new_syspath)
 		return false;
 
-	list_for_each(device, &udev_seat->base.devices_list, link) {
-		const char *syspath;
-		struct udev_device *ud;
-
-		ud = libinput_device_get_udev_device(device);
-		if (!ud)
-			continue;
-
-		syspath = udev_device_get_syspath(ud);
-		if (syspath && new_syspath && streq(syspath, new_syspath))
-			ignore_device = true;
-		udev_device_unref(ud);
-
-		if (ignore_device)
-			break;
-	}
-
-	return ignore_device;
+	return evdev_device_find_by_syspath(udev_seat->base.libinput,
+					    new_syspath,
+					    &udev_seat->base) != NULL;
 }
 
 static int
@@ -150,20 +134,13 @@ static void
 device_removed(struct udev_device *udev_device, struct udev_input *input)
 {
 	struct evdev_device *device;
-	struct udev_seat *seat;
 	const char *syspath;
 
 	syspath = udev_device_get_syspath(udev_device);
-	list_for_each(seat, &input->base.seat_list, base.link) {
-		list_for_each_safe(device,
-				   &seat->base.devices_list, base.link) {
-			if (streq(syspath,
-				  udev_device_get_syspath(device->udev_device))) {
-				evdev_device_remove(device);
-				break;
-			}
-		}
-	}
+	while ((device = evdev_device_find_by_syspath(&input->base,
+						      syspath,
+						      NULL)))
+		evdev_device_remove(device);
 }
 
 static int
@@ -213,35 +190,253 @@ udev_input_add_devices(struct udev_input *input, struct udev *udev)
 	return 0;
 }
 
+/* Events closer together than this are treated as one burst */
+#define HOTPLUG_SETTLE_TIMEOUT ms2us(50)
+/* A burst is processed after this time even if it hasn't settled */
+#define HOTPLUG_SETTLE_MAX ms2us(250)
+
+struct udev_pending_event {
+	struct list link;
+	struct udev_device *udev_device;
+	bool is_add;
+};
+
+static void
+udev_pending_event_destroy(struct udev_pending_event *pending)
+{
+	list_remove(&pending->link);
+	udev_device_unref(pending->udev_device);
+	free(pending);
+}
+
+static void
+udev_input_drop_pending(struct udev_input *input)
+{
+	struct udev_pending_event *pending;
+
+	libinput_timer_cancel(&input->hotplug.timer);
+
+	list_for_each_safe(pending, &input->hotplug.pending, link)
+		udev_pending_event_destroy(pending);
+}
+
+static void
+udev_input_process_pending(struct udev_input *input)
+{
+	struct udev_pending_event *pending;
+
+	libinput_timer_cancel(&input->hotplug.timer);
+
+	/* Any add and remove for the same syspath that are both still
+	 * queued are a remove of an existing device followed by an add
+	 * of its replacement, so process all removals first */
+	list_for_each_safe(pending, &input->hotplug.pending, link) {
+		if (!pending->is_add) {
+			device_removed(pending->udev_device, input);
+			udev_pending_event_destroy(pending);
+		}
+	}
+
+	list_for_each_safe(pending, &input->hotplug.pending, link) {
+		device_added(pending->udev_device, input, NULL);
+		udev_pending_event_destroy(pending);
+	}
+}
+
+static void
+udev_input_queue_event(struct udev_input *input,
+		       struct udev_device *udev_device,
+		       bool is_add)
+{
+	struct udev_pending_event *pending;
+	const char *syspath = udev_device_get_syspath(udev_device);
+
+	input->hotplug.nevents++;
+
+	/* A device removed before we ever added it is dropped, along
+	 * with its add */
+	if (!is_add) {
+		list_for_each(pending, &input->hotplug.pending, link) {
+			if (pending->is_add &&
+			    streq(syspath,
+				  udev_device_get_syspath(pending->udev_device))) {
+				udev_pending_event_destroy(pending);
+				input->hotplug.ncancelled += 2;
+				return;
+			}
+		}
+	}
+
+	pending = zalloc(sizeof *pending);
+	pending->udev_device = udev_device_ref(udev_device);
+	pending->is_add = is_add;
+	list_append(&input->hotplug.pending, &pending->link);
+}
+
+static void
+udev_input_hotplug_timeout(uint64_t now, void *data)
+{
+	struct udev_input *input = data;
+
+	if (list_empty(&input->hotplug.pending))
+		return;
+
+	input->hotplug.nstorms++;
+	log_debug(&input->base,
+		  "udev: processing hotplug burst (%" PRIu64 " events, %" PRIu64 " cancelled so far)\n",
+		  input->hotplug.nevents,
+		  input->hotplug.ncancelled);
+	udev_input_process_pending(input);
+}
+
 static void
 evdev_udev_handler(void *data)
 {
 	struct udev_input *input = data;
 	struct udev_device *udev_device;
-	const char *action;
+	uint64_t now = libinput_now(&input->base);
+	bool was_idle;
+	size_t nqueued = 0;
+
+	was_idle = list_empty(&input->hotplug.pending) &&
+		   now - input->hotplug.last_time > HOTPLUG_SETTLE_TIMEOUT;
+
+	/* Drain everything the monitor has for us */
+	while ((udev_device = udev_monitor_receive_device(input->udev_monitor))) {
+		const char *action = udev_device_get_action(udev_device);
+
+		if (action &&
+		    strneq("event", udev_device_get_sysname(udev_device), 5)) {
+			if (streq(action, "add")) {
+				udev_input_queue_event(input, udev_device, true);
+				nqueued++;
+			} else if (streq(action, "remove")) {
+				udev_input_queue_event(input, udev_device, false);
+				nqueued++;
+			}
+		}
 
-	udev_device = udev_monitor_receive_device(input->udev_monitor);
-	if (!udev_device)
+		udev_device_unref(udev_device);
+	}
+
+	if (nqueued == 0)
 		return;
 
-	action = udev_device_get_action(udev_device);
-	if (!action)
+	input->hotplug.last_time = now;
+
+	/* A single event after a quiet period is the common case,
+	 * don't delay it */
+	if (was_idle && nqueued == 1) {
+		udev_input_process_pending(input);
+		return;
+	}
+
+	if (list_empty(&input->hotplug.pending))
+		return;
+
+	if (!input->hotplug.timer.expire)
+		input->hotplug.first_time = now;
+
+	libinput_timer_set(&input->hotplug.timer,
+			   min(now + HOTPLUG_SETTLE_TIMEOUT,
+			       input->hotplug.first_time + HOTPLUG_SETTLE_MAX));
+}
+
+static void
+udev_input_remove_devices(struct udev_input *input)
+{
+	struct evdev_device *device;
+	struct udev_seat *seat;
+
+	list_for_each_safe(seat, &input->base.seat_list, base.link) {
+		libinput_seat_ref(&seat->base);
+		list_for_each_safe(device,
+				   &seat->base.devices_list, base.link) {
+			evdev_device_remove(device);
+		}
+		libinput_seat_unref(&seat->base);
+	}
+}
+
+static void
+udev_input_suspend_devices(struct udev_input *input)
+{
+	struct evdev_device *device;
+	struct udev_seat *seat;
+
+	list_for_each(seat, &input->base.seat_list, base.link) {
+		list_for_each(device, &seat->base.devices_list, base.link) {
+			/* Devices disabled through the send-events
+			 * configuration already have their fd closed and
+			 * must stay closed on resume */
+			if (device->fd == -1)
+				continue;
+
+			evdev_device_suspend(device);
+			device->warm_suspended = true;
+		}
+	}
+}
+
+static bool
+udev_sysattr_hex_equals(struct udev_device *udev_device,
+			const char *sysattr,
+			int value)
+{
+	const char *str;
+	unsigned int v;
+
+	str = udev_device_get_sysattr_value(udev_device, sysattr);
+
+	return str && safe_atou_base(str, &v, 16) && (int)v == value;
+}
+
+static bool
+udev_device_is_unchanged(struct udev_input *input,
+			 struct evdev_device *device)
+{
+	struct udev_device *udev_device, *parent;
+	const char *syspath, *device_seat, *name;
+	bool unchanged = false;
+
+	syspath = udev_device_get_syspath(device->udev_device);
+	udev_device = udev_device_new_from_syspath(input->udev, syspath);
+	if (!udev_device)
+		return false;
+
+	if (!udev_device_get_is_initialized(udev_device) ||
+	    udev_device_get_devnum(udev_device) !=
+	    udev_device_get_devnum(device->udev_device))
+		goto out;
+
+	device_seat = udev_device_get_property_value(udev_device, "ID_SEAT");
+	if (!device_seat)
+		device_seat = default_seat;
+	if (!streq(device_seat, input->seat_id))
+		goto out;
+
+	parent = udev_device_get_parent_with_subsystem_devtype(udev_device,
+							       "input",
+							       NULL);
+	if (!parent)
 		goto out;
 
-	if (!strneq("event", udev_device_get_sysname(udev_device), 5))
+	name = udev_device_get_sysattr_value(parent, "name");
+	if (!name || !streq(name, libevdev_get_name(device->evdev)))
 		goto out;
 
-	if (streq(action, "add"))
-		device_added(udev_device, input, NULL);
-	else if (streq(action, "remove"))
-		device_removed(udev_device, input);
+	unchanged = udev_sysattr_hex_equals(parent, "id/vendor",
+					    libevdev_get_id_vendor(device->evdev)) &&
+		    udev_sysattr_hex_equals(parent, "id/product",
+					    libevdev_get_id_product(device->evdev));
 
 out:
 	udev_device_unref(udev_device);
+	return unchanged;
 }
 
 static void
-udev_input_remove_devices(struct udev_input *input)
+udev_input_resume_devices(struct udev_input *input)
 {
 	struct evdev_device *device;
 	struct udev_seat *seat;
@@ -250,7 +445,20 @@ udev_input_remove_devices(struct udev_input *input)
 		libinput_seat_ref(&seat->base);
 		list_for_each_safe(device,
 				   &seat->base.devices_list, base.link) {
-			evdev_device_remove(device);
+			bool warm_suspended = device->warm_suspended;
+
+			device->warm_suspended = false;
+
+			/* Anything that changed while we were suspended
+			 * is removed here and re-added as a new device */
+			if (!udev_device_is_unchanged(input, device)) {
+				evdev_device_remove(device);
+				continue;
+			}
+
+			if (warm_suspended &&
+			    evdev_device_resume(device) != 0)
+				evdev_device_remove(device);
 		}
 		libinput_seat_unref(&seat->base);
 	}
@@ -269,7 +477,14 @@ udev_input_disable(struct libinput *libinput)
 	libinput_remove_source(&input->base, input->udev_monitor_source);
 	input->udev_monitor_source = NULL;
 
-	udev_input_remove_devices(input);
+	/* Whatever is still queued is picked up by the enumeration on
+	 * resume */
+	udev_input_drop_pending(input);
+
+	if (libinput->warm_suspend_enabled)
+		udev_input_suspend_devices(input);
+	else
+		udev_input_remove_devices(input);
 }
 
 static int
@@ -313,8 +528,13 @@ udev_input_enable(struct libinput *libinput)
 		return -1;
 	}
 
+	/* Devices kept by a warm suspend are re-opened first so the
+	 * enumeration below skips them as duplicates */
+	udev_input_resume_devices(input);
+
 	if (udev_input_add_devices(input, udev) < 0) {
 		udev_input_disable(libinput);
+		udev_input_remove_devices(input);
 		return -1;
 	}
 
@@ -329,6 +549,12 @@ udev_input_destroy(struct libinput *input)
 	if (input == NULL)
 		return;
 
+	/* Devices kept by a warm suspend */
+	udev_input_remove_devices(udev_input);
+
+	udev_input_drop_pending(udev_input);
+	libinput_timer_destroy(&udev_input->hotplug.timer);
+
 	udev_unref(udev_input->udev);
 	free(udev_input->seat_id);
 }
@@ -405,6 +631,7 @@ libinput_udev_create_context(const struct libinput_interface *interface,
 		return NULL;
 
 	input = zalloc(sizeof *input);
+	list_init(&input->hotplug.pending);
 
 	if (libinput_init(&input->base, interface,
 			  &interface_backend, user_data) != 0) {
@@ -414,6 +641,11 @@ libinput_udev_create_context(const struct libinput_interface *interface,
 	}
 
 	input->udev = udev_ref(udev);
+	libinput_timer_init(&input->hotplug.timer,
+			    &input->base,
+			    "udev hotplug",
+			    udev_input_hotplug_timeout,
+			    input);
 
 	return &input->base;
 }
@@ -455,3 +687,26 @@ libinput_udev_assign_seat(struct libinput *libinput,
 
 	return 0;
 }
+
+LIBINPUT_EXPORT int
+libinput_udev_get_hotplug_stats(struct libinput *libinput,
+				uint64_t *nevents,
+				uint64_t *ncancelled,
+				uint64_t *nstorms)
+{
+	struct udev_input *input = (struct udev_input*)libinput;
+
+	if (libinput->interface_backend != &interface_backend) {
+		log_bug_client(libinput, "Mismatching backends.\n");
+		return -1;
+	}
+
+	if (nevents)
+		*nevents = input->hotplug.nevents;
+	if (ncancelled)
+		*ncancelled = input->hotplug.ncancelled;
+	if (nstorms)
+		*nstorms = input->hotplug.nstorms;
+
+	return 0;
+}
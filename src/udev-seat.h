@@ -39,6 +39,19 @@ struct udev_input {
 	struct udev_monitor *udev_monitor;
 	struct libinput_source *udev_monitor_source;
 	char *seat_id;
+
+	/* Monitor events are queued while they arrive in bursts and
+	 * processed once the burst has settled */
+	struct {
+		struct list pending; /* struct udev_pending_event */
+		struct libinput_timer timer;
+		uint64_t first_time; /* of the oldest pending event */
+		uint64_t last_time; /* of the most recent event */
+
+		uint64_t nevents;
+		uint64_t ncancelled;
+		uint64_t nstorms;
+	} hotplug;
 };
 
 #endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "config.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "util-hash.h"
+#include "util-strings.h"
+
+#define HASH_TABLE_MIN_BUCKETS 16
+
+static void
+hash_table_alloc_buckets(struct hash_table *table, size_t nbuckets)
+{
+	table->buckets = zalloc(nbuckets * sizeof(*table->buckets));
+	table->nbuckets = nbuckets;
+
+	for (size_t i = 0; i < nbuckets; i++)
+		list_init(&table->buckets[i]);
+}
+
+void
+hash_table_init(struct hash_table *table)
+{
+	table->count = 0;
+	hash_table_alloc_buckets(table, HASH_TABLE_MIN_BUCKETS);
+}
+
+void
+hash_table_destroy(struct hash_table *table)
+{
+	free(table->buckets);
+	table->buckets = NULL;
+	table->nbuckets = 0;
+	table->count = 0;
+}
+
+static void
+hash_table_grow(struct hash_table *table)
+{
+	struct list *old_buckets = table->buckets;
+	size_t old_nbuckets = table->nbuckets;
+
+	hash_table_alloc_buckets(table, old_nbuckets * 2);
+
+	for (size_t i = 0; i < old_nbuckets; i++) {
+		struct hash_node *node;
+
+		list_for_each_safe(node, &old_buckets[i], link) {
+			list_remove(&node->link);
+			list_append(hash_table_bucket(table, node->hash),
+				    &node->link);
+		}
+	}
+
+	free(old_buckets);
+}
+
+void
+hash_table_insert(struct hash_table *table,
+		  struct hash_node *node,
+		  uint64_t hash)
+{
+	assert(node->table == NULL);
+
+	if (table->count >= table->nbuckets * 2)
+		hash_table_grow(table);
+
+	node->hash = hash;
+	node->table = table;
+	list_append(hash_table_bucket(table, hash), &node->link);
+	table->count++;
+}
+
+void
+hash_node_remove(struct hash_node *node)
+{
+	if (!node->table)
+		return;
+
+	list_remove(&node->link);
+	node->table->count--;
+	node->table = NULL;
+}
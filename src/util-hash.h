@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "util-list.h"
+
+/* An intrusive hash table with chained buckets. The table does not own
+ * its nodes and does not know the keys, it only buckets the nodes by a
+ * caller-supplied hash. Lookups must compare the actual key of each
+ * node in the bucket, see hash_table_for_each_match().
+ *
+ * The bucket array grows whenever the table holds more than two nodes
+ * per bucket, it never shrinks.
+ */
+
+struct hash_table {
+	struct list *buckets;
+	size_t nbuckets;
+	size_t count;
+};
+
+struct hash_node {
+	struct list link;
+	struct hash_table *table; /* NULL when not in a table */
+	uint64_t hash;
+};
+
+void
+hash_table_init(struct hash_table *table);
+
+/* Frees the buckets, the nodes are left as they are */
+void
+hash_table_destroy(struct hash_table *table);
+
+void
+hash_table_insert(struct hash_table *table,
+		  struct hash_node *node,
+		  uint64_t hash);
+
+/* Remove the node from its table, if any */
+void
+hash_node_remove(struct hash_node *node);
+
+static inline struct list *
+hash_table_bucket(struct hash_table *table, uint64_t hash)
+{
+	return &table->buckets[hash & (table->nbuckets - 1)];
+}
+
+/**
+ * Iterate over all nodes in table with the given hash. pos is the
+ * containing struct, member the name of the struct hash_node within.
+ * The node must not be removed inside the loop.
+ */
+#define hash_table_for_each_match(pos, table, hash_, member)		\
+	list_for_each(pos, hash_table_bucket((table), (hash_)), member.link) \
+		if (pos->member.hash != (hash_)) {} else
+
+/* FNV-1a */
+static inline uint64_t
+hash_string(const char *str)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	while (*str) {
+		hash ^= (unsigned char)*str++;
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+/* splitmix64 finalizer */
+static inline uint64_t
+hash_u64(uint64_t value)
+{
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ULL;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebULL;
+	value ^= value >> 31;
+
+	return value;
+}
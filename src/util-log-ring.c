@@ -0,0 +1,511 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "util-log-ring.h"
+#include "util-macros.h"
+#include "util-strings.h"
+
+enum conversion_type {
+	CONV_PERCENT,
+	CONV_INT,
+	CONV_UINT,
+	CONV_CHAR,
+	CONV_DOUBLE,
+	CONV_STRING,
+	CONV_POINTER,
+	CONV_INVALID,
+};
+
+enum length_modifier {
+	LEN_NONE,
+	LEN_HH,
+	LEN_H,
+	LEN_L,
+	LEN_LL,
+	LEN_J,
+	LEN_Z,
+	LEN_T,
+	LEN_LONG_DOUBLE,
+};
+
+struct conversion {
+	enum conversion_type type;
+	enum length_modifier length;
+	/* flags, width and precision, i.e. everything between the % and
+	 * the length modifier */
+	const char *flags;
+	size_t flags_len;
+	unsigned int nstars; /* '*' width and/or precision */
+	char conv;
+};
+
+static inline bool
+is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/* Parses the conversion specification at *format, which must point to a
+ * '%', and advances *format past it. */
+static struct conversion
+parse_conversion(const char **format)
+{
+	const char *f = *format + 1;
+	struct conversion c = {
+		.type = CONV_INVALID,
+		.length = LEN_NONE,
+		.flags = f,
+	};
+
+	if (*f == '%') {
+		c.type = CONV_PERCENT;
+		*format = f + 1;
+		return c;
+	}
+
+	while (*f != '\0' && strchr("-+ #0'", *f))
+		f++;
+
+	if (*f == '*') {
+		c.nstars++;
+		f++;
+	} else {
+		while (is_digit(*f))
+			f++;
+	}
+
+	if (*f == '.') {
+		f++;
+		if (*f == '*') {
+			c.nstars++;
+			f++;
+		} else {
+			while (is_digit(*f))
+				f++;
+		}
+	}
+	c.flags_len = f - c.flags;
+
+	switch (*f) {
+	case 'h':
+		f++;
+		c.length = LEN_H;
+		if (*f == 'h') {
+			c.length = LEN_HH;
+			f++;
+		}
+		break;
+	case 'l':
+		f++;
+		c.length = LEN_L;
+		if (*f == 'l') {
+			c.length = LEN_LL;
+			f++;
+		}
+		break;
+	case 'j': c.length = LEN_J; f++; break;
+	case 'z': c.length = LEN_Z; f++; break;
+	case 't': c.length = LEN_T; f++; break;
+	case 'L': c.length = LEN_LONG_DOUBLE; f++; break;
+	default:
+		break;
+	}
+
+	c.conv = *f;
+	switch (*f) {
+	case 'd':
+	case 'i':
+		c.type = CONV_INT;
+		break;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		c.type = CONV_UINT;
+		break;
+	case 'c':
+		if (c.length == LEN_NONE)
+			c.type = CONV_CHAR;
+		break;
+	case 'a':
+	case 'A':
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+		if (c.length == LEN_NONE || c.length == LEN_L)
+			c.type = CONV_DOUBLE;
+		break;
+	case 's':
+		if (c.length == LEN_NONE)
+			c.type = CONV_STRING;
+		break;
+	case 'p':
+		c.type = CONV_POINTER;
+		break;
+	default:
+		/* %n, %ls, %Lf, etc. are not supported */
+		break;
+	}
+
+	if (*f != '\0')
+		f++;
+	*format = f;
+
+	return c;
+}
+
+/* Copies as much of src as fits, returns the number of bytes used
+ * including the terminating null byte */
+static inline size_t
+copy_string(char *dest, size_t sz, const char *src)
+{
+	size_t len;
+
+	if (sz == 0)
+		return 0;
+
+	len = min(strlen(src), sz - 1);
+	memcpy(dest, src, len);
+	dest[len] = '\0';
+
+	return len + 1;
+}
+
+void
+log_ring_init(struct log_ring *ring, size_t size)
+{
+	free(ring->records);
+
+	ring->records = size ? zalloc(size * sizeof(*ring->records)) : NULL;
+	ring->size = size;
+	ring->count = 0;
+}
+
+void
+log_ring_destroy(struct log_ring *ring)
+{
+	log_ring_init(ring, 0);
+}
+
+void
+log_ring_record(struct log_ring *ring,
+		uint64_t time,
+		enum libinput_log_priority priority,
+		const char *prefix,
+		const char *format,
+		bool copy_format,
+		va_list args)
+{
+	struct log_ring_record *r;
+	const char *f;
+	size_t stroffset = 0;
+
+	if (!log_ring_is_enabled(ring))
+		return;
+
+	r = &ring->records[ring->count % ring->size];
+	ring->count++;
+
+	r->time = time;
+	r->priority = priority;
+	r->format = format;
+	r->nargs = 0;
+	r->truncated = false;
+	copy_string(r->prefix, sizeof(r->prefix), prefix ? prefix : "");
+
+	/* Only the arguments of the copied part are recorded */
+	if (copy_format) {
+		size_t len = copy_string(r->format_copy,
+					 sizeof(r->format_copy),
+					 format);
+		r->format = NULL;
+		r->truncated = format[len - 1] != '\0';
+	}
+
+	f = r->format ? r->format : r->format_copy;
+
+	while ((f = strchr(f, '%'))) {
+		struct conversion c = parse_conversion(&f);
+		union log_ring_arg *arg;
+		const char *str;
+
+		if (c.type == CONV_PERCENT)
+			continue;
+
+		if (c.type == CONV_INVALID ||
+		    r->nargs + c.nstars >= LOG_RING_MAX_ARGS) {
+			r->truncated = true;
+			break;
+		}
+
+		for (unsigned int i = 0; i < c.nstars; i++)
+			r->args[r->nargs++].i = va_arg(args, int);
+
+		arg = &r->args[r->nargs++];
+
+		switch (c.type) {
+		case CONV_INT:
+			switch (c.length) {
+			case LEN_HH: arg->i = (signed char)va_arg(args, int); break;
+			case LEN_H: arg->i = (short)va_arg(args, int); break;
+			case LEN_L: arg->i = va_arg(args, long); break;
+			case LEN_LL: arg->i = va_arg(args, long long); break;
+			case LEN_J: arg->i = va_arg(args, intmax_t); break;
+			case LEN_Z: arg->i = va_arg(args, ssize_t); break;
+			case LEN_T: arg->i = va_arg(args, ptrdiff_t); break;
+			default: arg->i = va_arg(args, int); break;
+			}
+			break;
+		case CONV_UINT:
+			switch (c.length) {
+			case LEN_HH: arg->i = (unsigned char)va_arg(args, unsigned int); break;
+			case LEN_H: arg->i = (unsigned short)va_arg(args, unsigned int); break;
+			case LEN_L: arg->i = va_arg(args, unsigned long); break;
+			case LEN_LL: arg->i = va_arg(args, unsigned long long); break;
+			case LEN_J: arg->i = va_arg(args, uintmax_t); break;
+			case LEN_Z: arg->i = va_arg(args, size_t); break;
+			case LEN_T: arg->i = va_arg(args, ptrdiff_t); break;
+			default: arg->i = va_arg(args, unsigned int); break;
+			}
+			break;
+		case CONV_CHAR:
+			arg->i = va_arg(args, int);
+			break;
+		case CONV_DOUBLE:
+			arg->d = va_arg(args, double);
+			break;
+		case CONV_STRING:
+			str = va_arg(args, const char *);
+			if (stroffset == sizeof(r->strings)) {
+				/* out of space, point to the last
+				 * string's terminating null byte */
+				arg->str = stroffset - 1;
+			} else {
+				arg->str = stroffset;
+				stroffset += copy_string(r->strings + stroffset,
+							 sizeof(r->strings) - stroffset,
+							 str ? str : "(null)");
+			}
+			break;
+		case CONV_POINTER:
+			arg->p = va_arg(args, void *);
+			break;
+		case CONV_PERCENT:
+		case CONV_INVALID:
+			abort();
+		}
+	}
+}
+
+LIBINPUT_ATTRIBUTE_PRINTF(4, 0)
+static void
+append_va(char *buf, size_t sz, size_t *len, const char *format, va_list args)
+{
+	int n;
+
+	if (*len >= sz - 1)
+		return;
+
+	n = vsnprintf(buf + *len, sz - *len, format, args);
+	if (n > 0)
+		*len = min(*len + n, sz - 1);
+}
+
+LIBINPUT_ATTRIBUTE_PRINTF(4, 5)
+static void
+append(char *buf, size_t sz, size_t *len, const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	append_va(buf, sz, len, format, args);
+	va_end(args);
+}
+
+/* The conversion spec is built at runtime, so this one can't have the
+ * printf attribute */
+static void
+append_conversion(char *buf, size_t sz, size_t *len, const char *spec, ...)
+{
+	va_list args;
+
+	va_start(args, spec);
+	append_va(buf, sz, len, spec, args);
+	va_end(args);
+}
+
+size_t
+log_ring_format_record(const struct log_ring_record *r,
+		       char *buf,
+		       size_t sz)
+{
+	const char *f = r->format ? r->format : r->format_copy;
+	const char *prio;
+	unsigned int argidx = 0;
+	size_t len = 0;
+	bool cut = false;
+
+	if (sz < 2) {
+		if (sz > 0)
+			buf[0] = '\0';
+		return 0;
+	}
+
+	buf[0] = '\0';
+
+	switch (r->priority) {
+	case LIBINPUT_LOG_PRIORITY_DEBUG: prio = "debug"; break;
+	case LIBINPUT_LOG_PRIORITY_INFO: prio = "info"; break;
+	case LIBINPUT_LOG_PRIORITY_ERROR: prio = "error"; break;
+	default: prio = "<invalid priority>"; break;
+	}
+
+	append(buf, sz, &len, "%" PRIu64 ".%06" PRIu64 " %s: ",
+	       r->time / 1000000,
+	       r->time % 1000000,
+	       prio);
+	if (r->prefix[0] != '\0')
+		append(buf, sz, &len, "%-7s - ", r->prefix);
+
+	while (*f != '\0') {
+		const char *pct = strchrnul(f, '%');
+		struct conversion c;
+		const union log_ring_arg *arg;
+		char spec[64];
+		size_t speclen = 0;
+
+		append(buf, sz, &len, "%.*s", (int)(pct - f), f);
+		if (*pct == '\0')
+			break;
+
+		f = pct;
+		c = parse_conversion(&f);
+		if (c.type == CONV_PERCENT) {
+			append(buf, sz, &len, "%%");
+			continue;
+		}
+
+		if (c.type == CONV_INVALID ||
+		    argidx + c.nstars >= r->nargs) {
+			append(buf, sz, &len, "[...]");
+			cut = true;
+			break;
+		}
+
+		/* Rebuild the spec with any '*' replaced by the recorded
+		 * width/precision and our own length modifier */
+		append(spec, sizeof(spec), &speclen, "%%");
+		for (size_t i = 0; i < c.flags_len; i++) {
+			if (c.flags[i] == '*')
+				append(spec, sizeof(spec), &speclen, "%d",
+				       (int)r->args[argidx++].i);
+			else
+				append(spec, sizeof(spec), &speclen, "%c",
+				       c.flags[i]);
+		}
+		if (c.type == CONV_INT || c.type == CONV_UINT)
+			append(spec, sizeof(spec), &speclen, "ll");
+		append(spec, sizeof(spec), &speclen, "%c", c.conv);
+
+		arg = &r->args[argidx++];
+		switch (c.type) {
+		case CONV_INT:
+			append_conversion(buf, sz, &len, spec, arg->i);
+			break;
+		case CONV_UINT:
+			append_conversion(buf, sz, &len, spec,
+					  (unsigned long long)arg->i);
+			break;
+		case CONV_CHAR:
+			append_conversion(buf, sz, &len, spec, (int)arg->i);
+			break;
+		case CONV_DOUBLE:
+			append_conversion(buf, sz, &len, spec, arg->d);
+			break;
+		case CONV_STRING:
+			append_conversion(buf, sz, &len, spec,
+					  &r->strings[arg->str]);
+			break;
+		case CONV_POINTER:
+			append_conversion(buf, sz, &len, spec, arg->p);
+			break;
+		case CONV_PERCENT:
+		case CONV_INVALID:
+			abort();
+		}
+	}
+
+	/* The copied format was cut short */
+	if (r->truncated && !cut)
+		append(buf, sz, &len, "[...]");
+
+	if (len == 0 || buf[len - 1] != '\n') {
+		if (len == sz - 1)
+			len--;
+		buf[len++] = '\n';
+		buf[len] = '\0';
+	}
+
+	return len;
+}
+
+size_t
+log_ring_dump(const struct log_ring *ring, int fd)
+{
+	uint64_t first, i;
+	char buf[1024];
+
+	if (!log_ring_is_enabled(ring))
+		return 0;
+
+	first = ring->count > ring->size ? ring->count - ring->size : 0;
+	for (i = first; i < ring->count; i++) {
+		const struct log_ring_record *r = &ring->records[i % ring->size];
+		size_t len = log_ring_format_record(r, buf, sizeof(buf));
+		size_t written = 0;
+
+		while (written < len) {
+			ssize_t rc = write(fd, buf + written, len - written);
+			if (rc < 0 && errno == EINTR)
+				continue;
+			if (rc <= 0)
+				return i - first;
+			written += rc;
+		}
+	}
+
+	return ring->count - first;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libinput.h"
+
+/* A ring of binary log records. Recording a message only stores the
+ * format string pointer and a copy of its arguments, the message is
+ * formatted when the ring is dumped. Format strings must thus be string
+ * literals (or otherwise outlive the ring), formats built at runtime are
+ * copied into the record instead.
+ */
+
+#define LOG_RING_MAX_ARGS 10
+#define LOG_RING_STRING_SIZE 96
+#define LOG_RING_FORMAT_SIZE 128
+
+union log_ring_arg {
+	long long i;
+	double d;
+	const void *p;
+	size_t str; /* offset into log_ring_record.strings */
+};
+
+struct log_ring_record {
+	uint64_t time; /* us */
+	enum libinput_log_priority priority;
+	const char *format; /* NULL if the format is in format_copy */
+	char prefix[16];
+	unsigned int nargs;
+	/* arguments after nargs or the end of a copied format were not
+	 * recorded */
+	bool truncated;
+	union log_ring_arg args[LOG_RING_MAX_ARGS];
+	char strings[LOG_RING_STRING_SIZE];
+	char format_copy[LOG_RING_FORMAT_SIZE];
+};
+
+struct log_ring {
+	struct log_ring_record *records;
+	size_t size;
+	uint64_t count; /* total number of records written */
+};
+
+static inline bool
+log_ring_is_enabled(const struct log_ring *ring)
+{
+	return ring->size > 0;
+}
+
+/* Resizes the ring, discarding all records. A size of 0 disables it */
+void
+log_ring_init(struct log_ring *ring, size_t size);
+
+void
+log_ring_destroy(struct log_ring *ring);
+
+/* Records the message in the next slot. If copy_format is true the
+ * format is copied into the record, otherwise only its pointer is
+ * stored. */
+void
+log_ring_record(struct log_ring *ring,
+		uint64_t time,
+		enum libinput_log_priority priority,
+		const char *prefix,
+		const char *format,
+		bool copy_format,
+		va_list args);
+
+/* Formats the record into buf, always null-terminated and ending in a
+ * newline (if there is space). Returns the string length. */
+size_t
+log_ring_format_record(const struct log_ring_record *record,
+		       char *buf,
+		       size_t sz);
+
+/* Writes all records to the fd, oldest first. This function does not
+ * allocate memory but formats with vsnprintf(), it is not
+ * async-signal-safe. */
+size_t
+log_ring_dump(const struct log_ring *ring, int fd);
@@ -0,0 +1,239 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "util-macros.h"
+#include "util-time.h"
+#include "util-prediction.h"
+
+static inline double
+us2ms_double(uint64_t us)
+{
+	return us / 1000.0;
+}
+
+static inline const struct predictor_sample *
+predictor_get_sample(const struct predictor *predictor, unsigned int age)
+{
+	unsigned int idx;
+
+	idx = (predictor->newest + PREDICTOR_HISTORY_SIZE - age) %
+		PREDICTOR_HISTORY_SIZE;
+
+	return &predictor->samples[idx];
+}
+
+void
+predictor_reset(struct predictor *predictor)
+{
+	memset(predictor, 0, sizeof(*predictor));
+}
+
+static inline void
+predictor_restart(struct predictor *predictor)
+{
+	struct predictor_sample newest;
+
+	newest = *predictor_get_sample(predictor, 0);
+	predictor_reset(predictor);
+	predictor->samples[0] = newest;
+	predictor->count = 1;
+}
+
+/* Least-squares slope of v over t */
+static double
+fit_linear(const double *t, const double *v, unsigned int n)
+{
+	double tm = 0, vm = 0, num = 0, denom = 0;
+
+	for (unsigned int i = 0; i < n; i++) {
+		tm += t[i];
+		vm += v[i];
+	}
+	tm /= n;
+	vm /= n;
+
+	for (unsigned int i = 0; i < n; i++) {
+		num += (t[i] - tm) * (v[i] - vm);
+		denom += (t[i] - tm) * (t[i] - tm);
+	}
+
+	return denom > 0 ? num / denom : 0.0;
+}
+
+static inline double
+det3(double a, double b, double c,
+     double d, double e, double f,
+     double g, double h, double i)
+{
+	return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+/* Least-squares fit of v = c0 + c1 t + c2 t², returns false if the
+ * system is degenerate */
+static bool
+fit_quadratic(const double *t, const double *v, unsigned int n,
+	      double *c1, double *c2)
+{
+	double s0 = n, s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+	double r0 = 0, r1 = 0, r2 = 0;
+	double det;
+
+	for (unsigned int i = 0; i < n; i++) {
+		double t2 = t[i] * t[i];
+
+		s1 += t[i];
+		s2 += t2;
+		s3 += t2 * t[i];
+		s4 += t2 * t2;
+		r0 += v[i];
+		r1 += v[i] * t[i];
+		r2 += v[i] * t2;
+	}
+
+	det = det3(s0, s1, s2,
+		   s1, s2, s3,
+		   s2, s3, s4);
+	if (fabs(det) < 1e-9)
+		return false;
+
+	*c1 = det3(s0, r0, s2,
+		   s1, r1, s3,
+		   s2, r2, s4) / det;
+	*c2 = det3(s0, s1, r0,
+		   s1, s2, r1,
+		   s2, s3, r2) / det;
+
+	return true;
+}
+
+void
+predictor_add_sample(struct predictor *predictor,
+		     uint64_t time,
+		     double x,
+		     double y,
+		     struct prediction *prediction)
+{
+	double t[PREDICTOR_HISTORY_SIZE],
+	       vx[PREDICTOR_HISTORY_SIZE],
+	       vy[PREDICTOR_HISTORY_SIZE];
+	unsigned int n;
+	bool restarted = false;
+
+	*prediction = (struct prediction) {
+		.time = time,
+		.x = x,
+		.y = y,
+	};
+
+	if (predictor->count > 0) {
+		const struct predictor_sample *last;
+
+		last = predictor_get_sample(predictor, 0);
+		if (time == last->time) {
+			/* Multiple events within one frame, the latest
+			 * position replaces the previous one */
+			predictor->count--;
+			predictor->newest = (predictor->newest +
+					     PREDICTOR_HISTORY_SIZE - 1) %
+						PREDICTOR_HISTORY_SIZE;
+		} else if (time < last->time ||
+			   time - last->time > PREDICTOR_MAX_SAMPLE_AGE) {
+			predictor_reset(predictor);
+		} else if (predictor->count > 1) {
+			const struct predictor_sample *prev;
+			double dot;
+
+			/* Direction change: restart from the last sample */
+			prev = predictor_get_sample(predictor, 1);
+			dot = (x - last->x) * (last->x - prev->x) +
+			      (y - last->y) * (last->y - prev->y);
+			if (dot < 0) {
+				predictor_restart(predictor);
+				restarted = true;
+			}
+		}
+	}
+
+	predictor->newest = (predictor->newest + 1) % PREDICTOR_HISTORY_SIZE;
+	if (predictor->count == 0)
+		predictor->newest = 0;
+	predictor->samples[predictor->newest] = (struct predictor_sample) {
+		.time = time,
+		.x = x,
+		.y = y,
+	};
+	predictor->count = min(predictor->count + 1, PREDICTOR_HISTORY_SIZE);
+
+	/* Collect the samples within the maximum age, relative to the
+	 * newest sample and in ms */
+	for (n = 0; n < predictor->count; n++) {
+		const struct predictor_sample *s = predictor_get_sample(predictor, n);
+
+		if (time - s->time > PREDICTOR_MAX_SAMPLE_AGE)
+			break;
+
+		t[n] = -us2ms_double(time - s->time);
+		vx[n] = s->x;
+		vy[n] = s->y;
+	}
+
+	if (n < 2)
+		return;
+
+	if (n == 2 ||
+	    !fit_quadratic(t, vx, n, &prediction->vx, &prediction->ax) ||
+	    !fit_quadratic(t, vy, n, &prediction->vy, &prediction->ay)) {
+		prediction->vx = fit_linear(t, vx, n);
+		prediction->vy = fit_linear(t, vy, n);
+		prediction->ax = 0;
+		prediction->ay = 0;
+	} else {
+		prediction->ax *= 2;
+		prediction->ay *= 2;
+	}
+
+	if (!restarted)
+		prediction->confidence = (double)(n - 1) /
+					 (PREDICTOR_HISTORY_SIZE - 1);
+}
+
+void
+prediction_at(const struct prediction *prediction,
+	      uint64_t time,
+	      double *x,
+	      double *y)
+{
+	double dt = 0;
+
+	if (time > prediction->time)
+		dt = us2ms_double(min(time - prediction->time,
+				 PREDICTOR_MAX_HORIZON));
+
+	*x = prediction->x + prediction->vx * dt + 0.5 * prediction->ax * dt * dt;
+	*y = prediction->y + prediction->vy * dt + 0.5 * prediction->ay * dt * dt;
+}
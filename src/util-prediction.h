@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* A least-squares motion predictor. The most recent samples are fitted
+ * with a second-order polynomial (first-order if only two samples are
+ * available), the resulting velocity and acceleration extrapolate the
+ * newest position into the near future.
+ *
+ * The history is restarted whenever the direction of motion changes by
+ * more than 90 degrees or samples are too far apart in time, the
+ * confidence of the prediction drops to 0 in that case.
+ */
+
+#define PREDICTOR_HISTORY_SIZE 6
+#define PREDICTOR_MAX_SAMPLE_AGE ms2us(50)
+#define PREDICTOR_MAX_HORIZON ms2us(50)
+
+struct predictor_sample {
+	uint64_t time; /* us */
+	double x, y;
+};
+
+struct predictor {
+	struct predictor_sample samples[PREDICTOR_HISTORY_SIZE];
+	unsigned int count;
+	unsigned int newest;
+};
+
+struct prediction {
+	uint64_t time; /* us, time of the newest sample */
+	double x, y; /* newest sample */
+	double vx, vy; /* units/ms */
+	double ax, ay; /* units/ms² */
+	double confidence; /* [0, 1] */
+};
+
+void
+predictor_reset(struct predictor *predictor);
+
+/* Adds a sample and fills in the prediction based on the updated
+ * history */
+void
+predictor_add_sample(struct predictor *predictor,
+		     uint64_t time,
+		     double x,
+		     double y,
+		     struct prediction *prediction);
+
+/* The predicted position at the given time. Times before the newest
+ * sample return the newest sample, times further ahead than
+ * PREDICTOR_MAX_HORIZON are clamped to that horizon. */
+void
+prediction_at(const struct prediction *prediction,
+	      uint64_t time,
+	      double *x,
+	      double *y);
@@ -151,6 +151,9 @@ struct path {
 struct litest_context {
 	struct litest_user_data *user_data;
 	struct list paths;
+
+	struct libinput *libinput;
+	struct list link; /* litest_contexts */
 };
 
 void litest_set_current_device(struct litest_device *device);
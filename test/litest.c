@@ -60,6 +60,7 @@
 #include "litest.h"
 #include "litest-int.h"
 #include "libinput-util.h"
+#include "libinput-test-hooks.h"
 #include "quirks.h"
 #include "builddir.h"
 
@@ -78,6 +79,7 @@
 static int jobs;
 static bool in_debugger = false;
 static bool verbose = false;
+static bool inject_events = false;
 static bool run_deviceless = false;
 static bool use_system_rules_quirks = false;
 const char *filter_test = NULL;
@@ -94,6 +96,8 @@ struct created_file {
 struct list created_files_list; /* list of all files to remove at the end of
 				   the test run */
 
+static struct list litest_contexts; /* all contexts created in this test */
+
 static void litest_init_udev_rules(struct list *created_files_list);
 static void litest_remove_udev_rules(struct list *created_files_list);
 
@@ -1251,6 +1255,9 @@ litest_run(int argc, char **argv)
 	if (getenv("LITEST_VERBOSE"))
 		verbose = true;
 
+	if (getenv("LITEST_INJECT_EVENTS"))
+		inject_events = true;
+
 	if (run_deviceless) {
 		litest_setup_quirks(&created_files_list,
 				    QUIRKS_SETUP_USE_SRCDIR);
@@ -1704,6 +1711,11 @@ litest_create_context(void)
 	libinput = libinput_path_create_context(&interface, ctx);
 	litest_assert_notnull(libinput);
 
+	if (litest_contexts.next == NULL)
+		list_init(&litest_contexts);
+	ctx->libinput = libinput;
+	list_insert(&litest_contexts, &ctx->link);
+
 	libinput_log_set_handler(libinput, litest_log_handler);
 	if (verbose)
 		libinput_log_set_priority(libinput, LIBINPUT_LOG_PRIORITY_DEBUG);
@@ -1721,6 +1733,7 @@ litest_destroy_context(struct libinput *li)
 	ctx = libinput_get_user_data(li);
 	litest_assert_ptr_notnull(ctx);
 	libinput_unref(li);
+	list_remove(&ctx->link);
 
 	list_for_each_safe(p, &ctx->paths, link) {
 		litest_abort_msg("Device paths should be removed by now");
@@ -1728,6 +1741,28 @@ litest_destroy_context(struct libinput *li)
 	free(ctx);
 }
 
+/**
+ * Advance the clock of all contexts by the given number of ms, without
+ * actually sleeping. Any events already written to the devices are
+ * processed first so they keep their timestamps from before the skipped
+ * interval. Timers expiring in that interval are handled by the next
+ * libinput_dispatch().
+ */
+static void
+litest_advance_clock(unsigned int ms)
+{
+	struct litest_context *ctx;
+
+	if (litest_contexts.next == NULL)
+		return;
+
+	list_for_each(ctx, &litest_contexts, link)
+		libinput_dispatch(ctx->libinput);
+
+	list_for_each(ctx, &litest_contexts, link)
+		libinput_clock_advance(ctx->libinput, ms2us(ms));
+}
+
 void
 litest_disable_log_handler(struct libinput *libinput)
 {
@@ -1960,6 +1995,19 @@ litest_event(struct litest_device *d, unsigned int type,
 	if (d->skip_ev_syn && type == EV_SYN && code == SYN_REPORT)
 		return;
 
+	/* Devices not (or no longer) in a context always go through
+	 * uinput */
+	if (inject_events && d->libinput_device) {
+		ret = libinput_device_inject_event(d->libinput_device,
+						   type,
+						   code,
+						   value);
+		if (ret != -ENODEV) {
+			litest_assert_int_eq(ret, 0);
+			return;
+		}
+	}
+
 	ret = libevdev_uinput_write_event(d->uinput, type, code, value);
 	litest_assert_int_eq(ret, 0);
 }
@@ -2390,7 +2438,7 @@ litest_touch_move_to_extended(struct litest_device *d,
 					   y_from + (y_to - y_from)/steps * i,
 					   axes);
 		libinput_dispatch(d->libinput);
-		msleep(sleep_ms);
+		litest_advance_clock(sleep_ms);
 		libinput_dispatch(d->libinput);
 	}
 	litest_touch_move_extended(d, slot, x_to, y_to, axes);
@@ -2557,7 +2605,7 @@ litest_touch_move_two_touches(struct litest_device *d,
 					y1 + dy / steps * i);
 		litest_pop_event_frame(d);
 		libinput_dispatch(d->libinput);
-		msleep(sleep_ms);
+		litest_advance_clock(sleep_ms);
 		libinput_dispatch(d->libinput);
 	}
 	litest_push_event_frame(d);
@@ -2587,7 +2635,7 @@ litest_touch_move_three_touches(struct litest_device *d,
 		litest_pop_event_frame(d);
 
 		libinput_dispatch(d->libinput);
-		msleep(sleep_ms);
+		litest_advance_clock(sleep_ms);
 	}
 	libinput_dispatch(d->libinput);
 }
@@ -2666,7 +2714,7 @@ litest_hover_move_to(struct litest_device *d,
 				  x_from + (x_to - x_from)/steps * i,
 				  y_from + (y_to - y_from)/steps * i);
 		libinput_dispatch(d->libinput);
-		msleep(sleep_ms);
+		litest_advance_clock(sleep_ms);
 		libinput_dispatch(d->libinput);
 	}
 	litest_hover_move(d, slot, x_to, y_to);
@@ -2689,7 +2737,7 @@ litest_hover_move_two_touches(struct litest_device *d,
 					y1 + dy / steps * i);
 		litest_pop_event_frame(d);
 		libinput_dispatch(d->libinput);
-		msleep(sleep_ms);
+		litest_advance_clock(sleep_ms);
 		libinput_dispatch(d->libinput);
 	}
 	litest_push_event_frame(d);
@@ -4068,97 +4116,97 @@ litest_assert_touch_cancel(struct libinput *li)
 void
 litest_timeout_tap(void)
 {
-	msleep(300);
+	litest_advance_clock(300);
 }
 
 void
 litest_timeout_tapndrag(void)
 {
-	msleep(520);
+	litest_advance_clock(520);
 }
 
 void
 litest_timeout_debounce(void)
 {
-	msleep(30);
+	litest_advance_clock(30);
 }
 
 void
 litest_timeout_softbuttons(void)
 {
-	msleep(300);
+	litest_advance_clock(300);
 }
 
 void
 litest_timeout_buttonscroll(void)
 {
-	msleep(300);
+	litest_advance_clock(300);
 }
 
 void
 litest_timeout_finger_switch(void)
 {
-	msleep(120);
+	litest_advance_clock(120);
 }
 
 void
 litest_timeout_edgescroll(void)
 {
-	msleep(300);
+	litest_advance_clock(300);
 }
 
 void
 litest_timeout_middlebutton(void)
 {
-	msleep(70);
+	litest_advance_clock(70);
 }
 
 void
 litest_timeout_dwt_short(void)
 {
-	msleep(220);
+	litest_advance_clock(220);
 }
 
 void
 litest_timeout_dwt_long(void)
 {
-	msleep(520);
+	litest_advance_clock(520);
 }
 
 void
 litest_timeout_gesture(void)
 {
-	msleep(120);
+	litest_advance_clock(120);
 }
 
 void
 litest_timeout_gesture_scroll(void)
 {
-	msleep(180);
+	litest_advance_clock(180);
 }
 
 void
 litest_timeout_trackpoint(void)
 {
-	msleep(320);
+	litest_advance_clock(320);
 }
 
 void
 litest_timeout_tablet_proxout(void)
 {
-	msleep(170);
+	litest_advance_clock(170);
 }
 
 void
 litest_timeout_touch_arbitration(void)
 {
-	msleep(100);
+	litest_advance_clock(100);
 }
 
 void
 litest_timeout_hysteresis(void)
 {
-	msleep(90);
+	litest_advance_clock(90);
 }
 
 void
@@ -4356,6 +4404,7 @@ litest_parse_argv(int argc, char **argv)
 		OPT_JOBS,
 		OPT_LIST,
 		OPT_VERBOSE,
+		OPT_INJECT_EVENTS,
 	};
 	static const struct option opts[] = {
 		{ "filter-test", 1, 0, OPT_FILTER_TEST },
@@ -4366,6 +4415,7 @@ litest_parse_argv(int argc, char **argv)
 		{ "jobs", 1, 0, OPT_JOBS },
 		{ "list", 0, 0, OPT_LIST },
 		{ "verbose", 0, 0, OPT_VERBOSE },
+		{ "inject-events", 0, 0, OPT_INJECT_EVENTS },
 		{ "help", 0, 0, 'h'},
 		{ 0, 0, 0, 0}
 	};
@@ -4421,6 +4471,9 @@ litest_parse_argv(int argc, char **argv)
 			       "          prefix-XXXXXX.xml and only the prefix is your choice.\n"
 			       "    --verbose\n"
 			       "          Enable verbose output\n"
+			       "    --inject-events\n"
+			       "          Pass events to libinput directly instead of\n"
+			       "          writing them to the uinput device\n"
 			       "    --jobs 8\n"
 			       "          Number of parallel test suites to run (default: 8).\n"
 			       "	  This overrides the LITEST_JOBS environment variable.\n"
@@ -4457,6 +4510,9 @@ litest_parse_argv(int argc, char **argv)
 		case OPT_VERBOSE:
 			verbose = true;
 			break;
+		case OPT_INJECT_EVENTS:
+			inject_events = true;
+			break;
 		case OPT_FILTER_DEVICELESS:
 			run_deviceless = true;
 			break;
@@ -32,6 +32,7 @@
 
 #include "litest.h"
 #include "libinput-util.h"
+#include "libinput-test-hooks.h"
 
 START_TEST(device_sendevents_config)
 {
@@ -774,6 +775,485 @@ START_TEST(device_get_udev_handle)
 }
 END_TEST
 
+START_TEST(device_inject_event)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	int rc;
+
+	litest_drain_events(li);
+
+	rc = libinput_device_inject_event(device, EV_KEY, KEY_A, 1);
+	ck_assert_int_eq(rc, 0);
+	rc = libinput_device_inject_event(device, EV_SYN, SYN_REPORT, 0);
+	ck_assert_int_eq(rc, 0);
+	libinput_dispatch(li);
+	litest_assert_key_event(li, KEY_A, LIBINPUT_KEY_STATE_PRESSED);
+
+	/* unchanged value is filtered, leaving an empty frame */
+	rc = libinput_device_inject_event(device, EV_KEY, KEY_A, 1);
+	ck_assert_int_eq(rc, 0);
+	rc = libinput_device_inject_event(device, EV_SYN, SYN_REPORT, 0);
+	ck_assert_int_eq(rc, 0);
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	rc = libinput_device_inject_event(device, EV_KEY, KEY_A, 0);
+	ck_assert_int_eq(rc, 0);
+	rc = libinput_device_inject_event(device, EV_SYN, SYN_REPORT, 0);
+	ck_assert_int_eq(rc, 0);
+	libinput_dispatch(li);
+	litest_assert_key_event(li, KEY_A, LIBINPUT_KEY_STATE_RELEASED);
+
+	rc = libinput_device_inject_event(device, EV_REL, REL_X, 1);
+	ck_assert_int_eq(rc, -EINVAL);
+	rc = libinput_device_inject_event(device, EV_SYN, SYN_CONFIG, 0);
+	ck_assert_int_eq(rc, -EINVAL);
+}
+END_TEST
+
+START_TEST(device_stage_counters)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	uint64_t count, nsec, cycles;
+	int rc;
+
+	litest_drain_events(li);
+
+	/* disabled by default */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_FALLBACK_HANDLE_STATE,
+						&count, &nsec, &cycles);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(count, 0);
+	ck_assert_int_eq(nsec, 0);
+	ck_assert_int_eq(cycles, 0);
+
+	libinput_enable_stage_counters(li, 1);
+	for (int i = 0; i < 5; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+		libinput_dispatch(li);
+	}
+	litest_drain_events(li);
+
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_FALLBACK_HANDLE_STATE,
+						&count, NULL, NULL);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(count, 5);
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_FILTER_DISPATCH,
+						&count, NULL, NULL);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(count, 5);
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_TP_PROCESS_STATE,
+						&count, NULL, NULL);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(count, 0);
+
+	/* disabling keeps the counters */
+	libinput_enable_stage_counters(li, 0);
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_FALLBACK_HANDLE_STATE,
+						&count, NULL, NULL);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(count, 5);
+
+	libinput_device_reset_stage_counters(device);
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_FALLBACK_HANDLE_STATE,
+						&count, NULL, NULL);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(count, 0);
+
+	rc = libinput_device_get_stage_counters(device,
+						LIBINPUT_STAGE_FILTER_DISPATCH + 1,
+						&count, NULL, NULL);
+	ck_assert_int_eq(rc, -1);
+}
+END_TEST
+
+static char fallback_interface_name[64];
+
+LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
+static void
+fallback_interface_log_handler(struct libinput *libinput,
+			       enum libinput_log_priority priority,
+			       const char *format,
+			       va_list args)
+{
+	char msg[256];
+	const char *name;
+
+	vsnprintf(msg, sizeof(msg), format, args);
+	name = strstr(msg, "fallback: using the ");
+	if (!name)
+		return;
+
+	name += strlen("fallback: using the ");
+	snprintf(fallback_interface_name,
+		 sizeof(fallback_interface_name),
+		 "%.*s",
+		 (int)strcspn(name, " "),
+		 name);
+}
+
+/* Add a device of the given type to the litest context and check which
+ * fallback interface it uses. With generic set, the test suite forces
+ * the generic interface */
+static struct litest_device *
+add_fallback_device(struct libinput *li,
+		    enum litest_device_type which,
+		    bool generic,
+		    const char *expected_interface)
+{
+	struct litest_device *d;
+
+	fallback_interface_name[0] = '\0';
+	libinput_log_set_handler(li, fallback_interface_log_handler);
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_DEBUG);
+
+	if (generic)
+		setenv("LIBINPUT_FALLBACK_GENERIC_INTERFACE", "1", 1);
+	d = litest_add_device(li, which);
+	unsetenv("LIBINPUT_FALLBACK_GENERIC_INTERFACE");
+
+	litest_restore_log_handler(li);
+	ck_assert_str_eq(fallback_interface_name, expected_interface);
+
+	if (libinput_device_config_accel_is_available(d->libinput_device)) {
+		/* the adaptive profile depends on the event timing, which
+		 * differs between the two devices */
+		enum libinput_config_status status;
+
+		status = libinput_device_config_accel_set_profile(d->libinput_device,
+								  LIBINPUT_CONFIG_ACCEL_PROFILE_FLAT);
+		ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	}
+
+	return d;
+}
+
+static void
+assert_fallback_event_equal(struct libinput_event *event,
+			    struct libinput_event *expected)
+{
+	enum libinput_event_type type = libinput_event_get_type(expected);
+
+	litest_assert_event_type(event, type);
+
+	switch (type) {
+	case LIBINPUT_EVENT_KEYBOARD_KEY: {
+		struct libinput_event_keyboard *k, *kexp;
+
+		k = libinput_event_get_keyboard_event(event);
+		kexp = libinput_event_get_keyboard_event(expected);
+		ck_assert_int_eq(libinput_event_keyboard_get_key(k),
+				 libinput_event_keyboard_get_key(kexp));
+		ck_assert_int_eq(libinput_event_keyboard_get_key_state(k),
+				 libinput_event_keyboard_get_key_state(kexp));
+		break;
+	}
+	case LIBINPUT_EVENT_POINTER_MOTION: {
+		struct libinput_event_pointer *p, *pexp;
+
+		p = libinput_event_get_pointer_event(event);
+		pexp = libinput_event_get_pointer_event(expected);
+		litest_assert_double_eq(libinput_event_pointer_get_dx(p),
+					libinput_event_pointer_get_dx(pexp));
+		litest_assert_double_eq(libinput_event_pointer_get_dy(p),
+					libinput_event_pointer_get_dy(pexp));
+		litest_assert_double_eq(libinput_event_pointer_get_dx_unaccelerated(p),
+					libinput_event_pointer_get_dx_unaccelerated(pexp));
+		litest_assert_double_eq(libinput_event_pointer_get_dy_unaccelerated(p),
+					libinput_event_pointer_get_dy_unaccelerated(pexp));
+		break;
+	}
+	case LIBINPUT_EVENT_POINTER_BUTTON: {
+		struct libinput_event_pointer *p, *pexp;
+
+		p = libinput_event_get_pointer_event(event);
+		pexp = libinput_event_get_pointer_event(expected);
+		ck_assert_int_eq(libinput_event_pointer_get_button(p),
+				 libinput_event_pointer_get_button(pexp));
+		ck_assert_int_eq(libinput_event_pointer_get_button_state(p),
+				 libinput_event_pointer_get_button_state(pexp));
+		break;
+	}
+	case LIBINPUT_EVENT_POINTER_AXIS: {
+		struct libinput_event_pointer *p, *pexp;
+		enum libinput_pointer_axis axes[] = {
+			LIBINPUT_POINTER_AXIS_SCROLL_VERTICAL,
+			LIBINPUT_POINTER_AXIS_SCROLL_HORIZONTAL,
+		};
+
+		p = libinput_event_get_pointer_event(event);
+		pexp = libinput_event_get_pointer_event(expected);
+		ck_assert_int_eq(libinput_event_pointer_get_axis_source(p),
+				 libinput_event_pointer_get_axis_source(pexp));
+		for (size_t i = 0; i < ARRAY_LENGTH(axes); i++) {
+			enum libinput_pointer_axis axis = axes[i];
+
+			ck_assert_int_eq(libinput_event_pointer_has_axis(p, axis),
+					 libinput_event_pointer_has_axis(pexp, axis));
+			if (!libinput_event_pointer_has_axis(p, axis))
+				continue;
+
+			litest_assert_double_eq(libinput_event_pointer_get_axis_value(p, axis),
+						libinput_event_pointer_get_axis_value(pexp, axis));
+			litest_assert_double_eq(libinput_event_pointer_get_axis_value_discrete(p, axis),
+						libinput_event_pointer_get_axis_value_discrete(pexp, axis));
+		}
+		break;
+	}
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_MOTION: {
+		struct libinput_event_touch *t, *texp;
+
+		t = libinput_event_get_touch_event(event);
+		texp = libinput_event_get_touch_event(expected);
+		ck_assert_int_eq(libinput_event_touch_get_slot(t),
+				 libinput_event_touch_get_slot(texp));
+		litest_assert_double_eq(libinput_event_touch_get_x_transformed(t, 100),
+					libinput_event_touch_get_x_transformed(texp, 100));
+		litest_assert_double_eq(libinput_event_touch_get_y_transformed(t, 100),
+					libinput_event_touch_get_y_transformed(texp, 100));
+		break;
+	}
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_CANCEL: {
+		struct libinput_event_touch *t, *texp;
+
+		t = libinput_event_get_touch_event(event);
+		texp = libinput_event_get_touch_event(expected);
+		ck_assert_int_eq(libinput_event_touch_get_slot(t),
+				 libinput_event_touch_get_slot(texp));
+		break;
+	}
+	case LIBINPUT_EVENT_SWITCH_TOGGLE: {
+		struct libinput_event_switch *sw, *swexp;
+
+		sw = libinput_event_get_switch_event(event);
+		swexp = libinput_event_get_switch_event(expected);
+		ck_assert_int_eq(libinput_event_switch_get_switch(sw),
+				 libinput_event_switch_get_switch(swexp));
+		ck_assert_int_eq(libinput_event_switch_get_switch_state(sw),
+				 libinput_event_switch_get_switch_state(swexp));
+		break;
+	}
+	default:
+		break;
+	}
+
+}
+
+/* Compares the events from the device using the specialized interface
+ * with those from the device using the generic one */
+static void
+assert_fallback_events_equal(struct libinput *li,
+			     struct litest_device *specialized,
+			     struct litest_device *generic)
+{
+	struct libinput_event *event;
+	struct libinput_event *events[64], *expected[64];
+	size_t nevents = 0, nexpected = 0;
+
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		struct libinput_device *device = libinput_event_get_device(event);
+
+		if (device == specialized->libinput_device) {
+			ck_assert_int_lt(nevents, ARRAY_LENGTH(events));
+			events[nevents++] = event;
+		} else if (device == generic->libinput_device) {
+			ck_assert_int_lt(nexpected, ARRAY_LENGTH(expected));
+			expected[nexpected++] = event;
+		} else {
+			libinput_event_destroy(event);
+		}
+	}
+
+	ck_assert_int_eq(nevents, nexpected);
+	for (size_t i = 0; i < nevents; i++) {
+		assert_fallback_event_equal(events[i], expected[i]);
+		libinput_event_destroy(events[i]);
+		libinput_event_destroy(expected[i]);
+	}
+}
+
+START_TEST(device_fallback_keyboard_equivalence)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct litest_device *devices[2];
+	struct litest_device **d;
+	unsigned int keys[] = { KEY_A, KEY_LEFTSHIFT, KEY_B, KEY_ENTER };
+
+	devices[0] = add_fallback_device(li, dev->which, false, "keyboard");
+	devices[1] = add_fallback_device(li, dev->which, true, "generic");
+	litest_drain_events(li);
+
+	for (size_t i = 0; i < ARRAY_LENGTH(keys); i++) {
+		ARRAY_FOR_EACH(devices, d)
+			litest_keyboard_key(*d, keys[i], true);
+		assert_fallback_events_equal(li, devices[0], devices[1]);
+	}
+	/* kernel key repeat and a release for a key never pressed */
+	ARRAY_FOR_EACH(devices, d) {
+		litest_event(*d, EV_KEY, KEY_A, 2);
+		litest_event(*d, EV_SYN, SYN_REPORT, 0);
+		litest_keyboard_key(*d, KEY_C, false);
+	}
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+
+	for (size_t i = 0; i < ARRAY_LENGTH(keys); i++) {
+		ARRAY_FOR_EACH(devices, d)
+			litest_keyboard_key(*d, keys[i], false);
+		assert_fallback_events_equal(li, devices[0], devices[1]);
+	}
+
+	ARRAY_FOR_EACH(devices, d)
+		litest_delete_device(*d);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(device_fallback_pointer_equivalence)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct litest_device *devices[2];
+	struct litest_device **d;
+
+	devices[0] = add_fallback_device(li, dev->which, false, "pointer");
+	devices[1] = add_fallback_device(li, dev->which, true, "generic");
+	litest_drain_events(li);
+
+	for (int i = 0; i < 10; i++) {
+		ARRAY_FOR_EACH(devices, d) {
+			litest_event(*d, EV_REL, REL_X, i);
+			litest_event(*d, EV_REL, REL_Y, -i * 2);
+			litest_event(*d, EV_SYN, SYN_REPORT, 0);
+		}
+		assert_fallback_events_equal(li, devices[0], devices[1]);
+	}
+
+	ARRAY_FOR_EACH(devices, d) {
+		litest_event(*d, EV_REL, REL_WHEEL, -1);
+		litest_event(*d, EV_SYN, SYN_REPORT, 0);
+		litest_event(*d, EV_REL, REL_HWHEEL, 2);
+		litest_event(*d, EV_REL, REL_X, 3);
+		litest_event(*d, EV_SYN, SYN_REPORT, 0);
+	}
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+
+	ARRAY_FOR_EACH(devices, d) {
+		litest_event(*d, EV_KEY, BTN_LEFT, 1);
+		litest_event(*d, EV_SYN, SYN_REPORT, 0);
+	}
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d) {
+		litest_event(*d, EV_REL, REL_Y, 5);
+		litest_event(*d, EV_SYN, SYN_REPORT, 0);
+		litest_event(*d, EV_KEY, BTN_LEFT, 0);
+		litest_event(*d, EV_SYN, SYN_REPORT, 0);
+	}
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	litest_timeout_debounce();
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+
+	ARRAY_FOR_EACH(devices, d)
+		litest_delete_device(*d);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(device_fallback_touch_mt_equivalence)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct litest_device *devices[2];
+	struct litest_device **d;
+
+	devices[0] = add_fallback_device(li, dev->which, false, "touch-mt");
+	devices[1] = add_fallback_device(li, dev->which, true, "generic");
+	litest_drain_events(li);
+
+	ARRAY_FOR_EACH(devices, d)
+		litest_touch_down(*d, 0, 20, 30);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d)
+		litest_touch_down(*d, 1, 70, 60);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d)
+		litest_touch_move_two_touches(*d, 20, 30, 70, 60, 10, 10, 10);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d)
+		litest_touch_up(*d, 0);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d)
+		litest_touch_move_to(*d, 1, 80, 70, 50, 50, 10);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d)
+		litest_touch_up(*d, 1);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+
+	ARRAY_FOR_EACH(devices, d)
+		litest_delete_device(*d);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(device_fallback_switch_equivalence)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct litest_device *devices[2];
+	struct litest_device **d;
+
+	devices[0] = add_fallback_device(li, dev->which, false, "switch");
+	devices[1] = add_fallback_device(li, dev->which, true, "generic");
+	litest_drain_events(li);
+
+	ARRAY_FOR_EACH(devices, d)
+		litest_switch_action(*d,
+				     LIBINPUT_SWITCH_LID,
+				     LIBINPUT_SWITCH_STATE_ON);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	/* repeated state is filtered */
+	ARRAY_FOR_EACH(devices, d)
+		litest_switch_action(*d,
+				     LIBINPUT_SWITCH_LID,
+				     LIBINPUT_SWITCH_STATE_ON);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+	ARRAY_FOR_EACH(devices, d)
+		litest_switch_action(*d,
+				     LIBINPUT_SWITCH_LID,
+				     LIBINPUT_SWITCH_STATE_OFF);
+	assert_fallback_events_equal(li, devices[0], devices[1]);
+
+	ARRAY_FOR_EACH(devices, d)
+		litest_delete_device(*d);
+	litest_drain_events(li);
+}
+END_TEST
+
 START_TEST(device_context)
 {
 	struct litest_device *dev = litest_current_device();
@@ -1730,6 +2210,12 @@ TEST_COLLECTION(device)
 	litest_add_for_device(device_user_data, LITEST_SYNAPTICS_CLICKPAD_X220);
 
 	litest_add(device_get_udev_handle, LITEST_ANY, LITEST_ANY);
+	litest_add_for_device(device_inject_event, LITEST_KEYBOARD);
+	litest_add_for_device(device_stage_counters, LITEST_MOUSE);
+	litest_add_for_device(device_fallback_keyboard_equivalence, LITEST_KEYBOARD);
+	litest_add_for_device(device_fallback_pointer_equivalence, LITEST_MOUSE);
+	litest_add_for_device(device_fallback_touch_mt_equivalence, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add_for_device(device_fallback_switch_equivalence, LITEST_LID_SWITCH);
 
 	litest_add(device_group_get, LITEST_ANY, LITEST_ANY);
 	litest_add_no_device(device_group_ref);
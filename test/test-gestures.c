@@ -1160,6 +1160,127 @@ START_TEST(gestures_swipe_3fg_unaccel)
 }
 END_TEST
 
+START_TEST(gestures_low_latency_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(libinput_device_config_gesture_low_latency_is_available(device));
+	ck_assert_int_eq(libinput_device_config_gesture_low_latency_get_enabled(device),
+			 LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED);
+	ck_assert_int_eq(libinput_device_config_gesture_low_latency_get_default_enabled(device),
+			 LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED);
+
+	status = libinput_device_config_gesture_low_latency_set_enabled(device,
+			LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_gesture_low_latency_get_enabled(device),
+			 LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED);
+
+	status = libinput_device_config_gesture_low_latency_set_enabled(device, 3);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+}
+END_TEST
+
+START_TEST(gestures_low_latency_unavailable)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(!libinput_device_config_gesture_low_latency_is_available(device));
+	status = libinput_device_config_gesture_low_latency_set_enabled(device,
+			LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_UNSUPPORTED);
+	status = libinput_device_config_gesture_low_latency_set_enabled(device,
+			LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+}
+END_TEST
+
+/* Swipe with three fingers in small steps, return the number of frames
+ * until the first gesture event and the total unaccelerated motion */
+static int
+swipe_3fg_frames_to_begin(struct litest_device *dev, double *total_dx)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	int nframes = 0;
+	double x = 30;
+
+	*total_dx = 0.0;
+
+	litest_drain_events(li);
+	litest_touch_down(dev, 0, 30, 40);
+	litest_touch_down(dev, 1, 40, 40);
+	litest_touch_down(dev, 2, 50, 40);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	while (nframes < 40) {
+		x += 0.5;
+		nframes++;
+
+		litest_push_event_frame(dev);
+		litest_touch_move(dev, 0, x, 40);
+		litest_touch_move(dev, 1, x + 10, 40);
+		litest_touch_move(dev, 2, x + 20, 40);
+		litest_pop_event_frame(dev);
+		libinput_dispatch(li);
+
+		if (libinput_next_event_type(li) != LIBINPUT_EVENT_NONE)
+			break;
+	}
+
+	event = libinput_get_event(li);
+	litest_is_gesture_event(event, LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN, 3);
+	libinput_event_destroy(event);
+
+	while ((event = libinput_get_event(li))) {
+		struct libinput_event_gesture *gevent;
+
+		gevent = litest_is_gesture_event(event,
+						 LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE,
+						 3);
+		*total_dx += libinput_event_gesture_get_dx_unaccelerated(gevent);
+		libinput_event_destroy(event);
+	}
+
+	litest_touch_up(dev, 0);
+	litest_touch_up(dev, 1);
+	litest_touch_up(dev, 2);
+	litest_drain_events(li);
+
+	return nframes;
+}
+
+START_TEST(gestures_low_latency_swipe)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	int nframes, nframes_low_latency;
+	double dx, dx_low_latency;
+
+	if (litest_slot_count(dev) < 3)
+		return;
+
+	nframes = swipe_3fg_frames_to_begin(dev, &dx);
+
+	libinput_device_config_gesture_low_latency_set_enabled(device,
+			LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED);
+	nframes_low_latency = swipe_3fg_frames_to_begin(dev, &dx_low_latency);
+
+	ck_assert_int_lt(nframes_low_latency, nframes);
+
+	/* The motion before the gesture was detected is included in the
+	 * first update, so we get at least as much motion despite
+	 * committing earlier */
+	ck_assert_double_gt(dx_low_latency, 0.0);
+	ck_assert_double_gt(dx_low_latency, dx);
+}
+END_TEST
+
 TEST_COLLECTION(gestures)
 {
 	struct range cardinals = { N, N + NCARDINALS };
@@ -1182,6 +1303,12 @@ TEST_COLLECTION(gestures)
 
 	litest_add(gestures_time_usec, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 
+	litest_add(gestures_low_latency_config, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
+	litest_add(gestures_low_latency_unavailable, LITEST_ANY, LITEST_TOUCHPAD);
+	litest_add(gestures_low_latency_unavailable, LITEST_SEMI_MT, LITEST_ANY);
+	litest_add(gestures_low_latency_unavailable, LITEST_TOUCHPAD|LITEST_SINGLE_TOUCH, LITEST_ANY);
+	litest_add(gestures_low_latency_swipe, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
+
 	/* Timing-sensitive test, valgrind is too slow */
 	if (!RUNNING_ON_VALGRIND)
 		litest_add(gestures_swipe_3fg_unaccel, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
@@ -134,6 +134,60 @@ START_TEST(log_priority)
 }
 END_TEST
 
+START_TEST(log_ring)
+{
+	struct libinput *li;
+	int fds[2];
+	char buf[4096] = {0};
+	unsigned int nmessages;
+	ssize_t len;
+
+	log_handler_context = NULL;
+	log_handler_called = 0;
+
+	li = litest_create_context();
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_ERROR);
+	libinput_log_set_handler(li, simple_log_handler);
+	log_handler_context = li;
+
+	ck_assert_int_eq(pipe2(fds, O_CLOEXEC|O_NONBLOCK), 0);
+
+	/* disabled by default */
+	libinput_path_add_device(li, "/tmp");
+	ck_assert_int_eq(log_handler_called, 1);
+	ck_assert_int_eq(libinput_log_dump_ring(li, fds[1]), 0);
+
+	libinput_log_set_ring_size(li, 4);
+	for (int i = 0; i < 10; i++)
+		libinput_path_add_device(li, "/tmp");
+	/* the log handler is unaffected by the log ring */
+	ck_assert_int_eq(log_handler_called, 11);
+
+	nmessages = libinput_log_dump_ring(li, fds[1]);
+	ck_assert_int_eq(nmessages, 4);
+
+	len = read(fds[0], buf, sizeof(buf) - 1);
+	ck_assert_int_gt(len, 0);
+	ck_assert_notnull(strstr(buf, "error: client bug: Invalid path /tmp\n"));
+	ck_assert_int_eq(buf[len - 1], '\n');
+
+	/* resizing discards the old messages */
+	libinput_log_set_ring_size(li, 8);
+	ck_assert_int_eq(libinput_log_dump_ring(li, fds[1]), 0);
+
+	libinput_log_set_ring_size(li, 0);
+	libinput_path_add_device(li, "/tmp");
+	ck_assert_int_eq(libinput_log_dump_ring(li, fds[1]), 0);
+
+	close(fds[0]);
+	close(fds[1]);
+	litest_destroy_context(li);
+
+	log_handler_context = NULL;
+	log_handler_called = 0;
+}
+END_TEST
+
 static int axisrange_log_handler_called = 0;
 
 static void
@@ -192,6 +246,7 @@ TEST_COLLECTION(log)
 	litest_add_deviceless(log_handler_invoked);
 	litest_add_deviceless(log_handler_NULL);
 	litest_add_no_device(log_priority);
+	litest_add_deviceless(log_ring);
 
 	/* mtdev clips to axis ranges */
 	litest_add_ranged(log_axisrange_warning, LITEST_TOUCH, LITEST_PROTOCOL_A, &axes);
@@ -26,6 +26,7 @@
 #include <check.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <libinput.h>
 #include <libinput-util.h>
 #include <unistd.h>
@@ -206,6 +207,127 @@ START_TEST(event_conversion_pointer)
 }
 END_TEST
 
+START_TEST(event_mask)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	litest_drain_events(li);
+
+	ck_assert_int_eq(libinput_get_event_mask(li,
+						 LIBINPUT_EVENT_POINTER_MOTION),
+			 0);
+	ck_assert_int_eq(libinput_set_event_mask(li,
+						 LIBINPUT_EVENT_POINTER_MOTION,
+						 1),
+			 0);
+	ck_assert_int_eq(libinput_get_event_mask(li,
+						 LIBINPUT_EVENT_POINTER_MOTION),
+			 1);
+
+	ck_assert_int_eq(libinput_set_event_mask(li, LIBINPUT_EVENT_NONE, 1),
+			 -1);
+	ck_assert_int_eq(libinput_set_event_mask(li,
+						 LIBINPUT_EVENT_DEVICE_ADDED,
+						 1),
+			 -1);
+	ck_assert_int_eq(libinput_set_event_mask(li,
+						 LIBINPUT_EVENT_DEVICE_REMOVED,
+						 1),
+			 -1);
+	ck_assert_int_eq(libinput_set_event_mask(li, 12345, 1), -1);
+	ck_assert_int_eq(libinput_get_event_mask(li, 12345), 0);
+
+	litest_event(dev, EV_REL, REL_X, -1);
+	litest_event(dev, EV_REL, REL_Y, -1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_REL, REL_X, -1);
+	litest_event(dev, EV_REL, REL_Y, -1);
+	litest_event(dev, EV_KEY, BTN_LEFT, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_KEY, BTN_LEFT, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+
+	ck_assert_int_eq(libinput_set_event_mask(li,
+						 LIBINPUT_EVENT_POINTER_MOTION,
+						 0),
+			 0);
+	litest_event(dev, EV_REL, REL_X, -1);
+	litest_event(dev, EV_REL, REL_Y, -1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_REL, REL_X, -1);
+	litest_event(dev, EV_REL, REL_Y, -1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+}
+END_TEST
+
+START_TEST(event_export)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_export_reader *reader;
+	struct libinput_event_export_record record;
+	int fd;
+
+	litest_drain_events(li);
+
+	ck_assert_int_eq(libinput_get_event_export_fd(li), -1);
+	ck_assert_int_eq(libinput_enable_event_export(li, 3), 0);
+	fd = libinput_get_event_export_fd(li);
+	ck_assert_int_ge(fd, 0);
+	ck_assert_int_eq(fcntl(fd, F_GETFL) & O_ACCMODE, O_RDONLY);
+
+	reader = libinput_event_export_reader_new(fd);
+	ck_assert_notnull(reader);
+	ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 0);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	libinput_dispatch(li);
+
+	ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 1);
+	ck_assert_int_eq(record.type, LIBINPUT_EVENT_POINTER_BUTTON);
+	ck_assert_int_eq(record.code, BTN_LEFT);
+	ck_assert_int_eq(record.state, LIBINPUT_BUTTON_STATE_PRESSED);
+	ck_assert_int_ne(record.device_id, 0);
+	ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 1);
+	ck_assert_int_eq(record.type, LIBINPUT_EVENT_POINTER_BUTTON);
+	ck_assert_int_eq(record.state, LIBINPUT_BUTTON_STATE_RELEASED);
+	ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 0);
+	ck_assert(libinput_event_export_reader_get_overflow_count(reader) == 0);
+	litest_drain_events(li);
+
+	/* the ring holds 4 records, the oldest two are overwritten */
+	for (int i = 0; i < 3; i++) {
+		litest_button_click_debounced(dev, li, BTN_LEFT, true);
+		litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	}
+	libinput_dispatch(li);
+
+	for (int i = 0; i < 4; i++)
+		ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 1);
+	ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 0);
+	ck_assert(libinput_event_export_reader_get_overflow_count(reader) == 2);
+	litest_drain_events(li);
+
+	libinput_event_export_reader_destroy(reader);
+
+	ck_assert_int_eq(libinput_enable_event_export(li, 0), 0);
+	ck_assert_int_eq(libinput_get_event_export_fd(li), -1);
+	ck_assert(libinput_event_export_reader_new(-1) == NULL);
+}
+END_TEST
+
 START_TEST(event_conversion_pointer_abs)
 {
 	struct litest_device *dev = litest_current_device();
@@ -678,7 +800,9 @@ START_TEST(timer_offset_bug_warning)
 	litest_touch_down(dev, 0, 50, 50);
 	litest_touch_up(dev, 0);
 
-	litest_timeout_tap();
+	/* litest_timeout_tap() doesn't sleep, we need the real clock to
+	 * move on before the events are processed */
+	msleep(300);
 
 	user_data->private = &warning_triggered;
 	libinput_log_set_handler(li, timer_offset_warning);
@@ -727,6 +851,43 @@ START_TEST(timer_delay_bug_warning)
 }
 END_TEST
 
+START_TEST(timer_clock_advance)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_keyboard *kev;
+	uint64_t press_time, release_time;
+
+	litest_drain_events(li);
+
+	litest_keyboard_key(dev, KEY_A, true);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	kev = litest_is_keyboard_event(event,
+				       KEY_A,
+				       LIBINPUT_KEY_STATE_PRESSED);
+	press_time = libinput_event_keyboard_get_time_usec(kev);
+	libinput_event_destroy(event);
+
+	libinput_clock_advance(li, s2us(10));
+
+	litest_keyboard_key(dev, KEY_A, false);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	kev = litest_is_keyboard_event(event,
+				       KEY_A,
+				       LIBINPUT_KEY_STATE_RELEASED);
+	release_time = libinput_event_keyboard_get_time_usec(kev);
+	libinput_event_destroy(event);
+
+	ck_assert_int_ge(release_time - press_time, s2us(10));
+	ck_assert_int_lt(release_time - press_time, s2us(11));
+}
+END_TEST
+
 START_TEST(timer_flush)
 {
 	struct libinput *li;
@@ -800,6 +961,63 @@ START_TEST(timer_flush)
 }
 END_TEST
 
+START_TEST(timer_moved_later)
+{
+	struct libinput *li;
+	struct litest_device *keyboard, *touchpad;
+	struct pollfd fds;
+
+	li = litest_create_context();
+
+	touchpad = litest_add_device(li, LITEST_SYNAPTICS_TOUCHPAD);
+	litest_enable_tap(touchpad->libinput_device);
+	libinput_dispatch(li);
+	keyboard = litest_add_device(li, LITEST_KEYBOARD);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	fds.fd = libinput_get_fd(li);
+	fds.events = POLLIN;
+	fds.revents = 0;
+
+	/* The first key press starts the short DWT timeout, the second one
+	 * pushes it back to the long timeout. The timerfd is not re-armed
+	 * for the later expiry, so we get an early wakeup first and must
+	 * still get the real one afterwards */
+	litest_keyboard_key(keyboard, KEY_A, true);
+	litest_keyboard_key(keyboard, KEY_A, false);
+	libinput_dispatch(li);
+	msleep(100);
+	litest_keyboard_key(keyboard, KEY_A, true);
+	litest_keyboard_key(keyboard, KEY_A, false);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	ck_assert_int_eq(poll(&fds, 1, 2000), 1);
+	libinput_dispatch(li);
+	ck_assert_int_eq(poll(&fds, 1, 2000), 1);
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	/* DWT has timed out, tapping works again */
+	litest_touch_down(touchpad, 0, 50, 50);
+	litest_touch_up(touchpad, 0);
+	libinput_dispatch(li);
+	litest_timeout_tap();
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+
+	litest_delete_device(keyboard);
+	litest_delete_device(touchpad);
+
+	litest_destroy_context(li);
+}
+END_TEST
+
 START_TEST(udev_absinfo_override)
 {
 	struct litest_device *dev = litest_current_device();
@@ -882,6 +1100,8 @@ TEST_COLLECTION(misc)
 {
 	litest_add_no_device(event_conversion_device_notify);
 	litest_add_for_device(event_conversion_pointer, LITEST_MOUSE);
+	litest_add_for_device(event_mask, LITEST_MOUSE);
+	litest_add_for_device(event_export, LITEST_MOUSE);
 	litest_add_for_device(event_conversion_pointer_abs, LITEST_XEN_VIRTUAL_POINTER);
 	litest_add_for_device(event_conversion_key, LITEST_KEYBOARD);
 	litest_add_for_device(event_conversion_touch, LITEST_WACOM_TOUCH);
@@ -895,7 +1115,9 @@ TEST_COLLECTION(misc)
 
 	litest_add_for_device(timer_offset_bug_warning, LITEST_SYNAPTICS_TOUCHPAD);
 	litest_add_for_device(timer_delay_bug_warning, LITEST_MOUSE);
+	litest_add_for_device(timer_clock_advance, LITEST_KEYBOARD);
 	litest_add_no_device(timer_flush);
+	litest_add_no_device(timer_moved_later);
 
 	litest_add_no_device(fd_no_event_leak);
 
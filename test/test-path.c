@@ -27,6 +27,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <libinput.h>
+#include <poll.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -473,6 +474,502 @@ START_TEST(path_add_invalid_path)
 }
 END_TEST
 
+START_TEST(path_add_devices)
+{
+	struct libinput *li;
+	struct libinput_device *devices[3];
+	struct libinput_event *event;
+	struct libevdev_uinput *uinput1, *uinput2;
+	const char *paths[3];
+	int rc;
+
+	uinput1 = litest_create_uinput_device("test device", NULL,
+					      EV_KEY, BTN_LEFT,
+					      EV_KEY, BTN_RIGHT,
+					      EV_REL, REL_X,
+					      EV_REL, REL_Y,
+					      -1);
+	uinput2 = litest_create_uinput_device("test device 2", NULL,
+					      EV_KEY, BTN_LEFT,
+					      EV_KEY, BTN_RIGHT,
+					      EV_REL, REL_X,
+					      EV_REL, REL_Y,
+					      -1);
+
+	li = litest_create_context();
+
+	paths[0] = libevdev_uinput_get_devnode(uinput1);
+	paths[1] = "/tmp/";
+	paths[2] = libevdev_uinput_get_devnode(uinput2);
+
+	litest_disable_log_handler(li);
+	rc = libinput_path_add_devices(li, paths, 3, devices);
+	litest_restore_log_handler(li);
+	ck_assert_int_eq(rc, 2);
+	ck_assert_notnull(devices[0]);
+	ck_assert(devices[1] == NULL);
+	ck_assert_notnull(devices[2]);
+
+	libinput_dispatch(li);
+
+	/* added events are in the order of the paths */
+	event = libinput_get_event(li);
+	ck_assert_int_eq(libinput_event_get_type(event),
+			 LIBINPUT_EVENT_DEVICE_ADDED);
+	ck_assert_ptr_eq(libinput_event_get_device(event), devices[0]);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	ck_assert_int_eq(libinput_event_get_type(event),
+			 LIBINPUT_EVENT_DEVICE_ADDED);
+	ck_assert_ptr_eq(libinput_event_get_device(event), devices[2]);
+	libinput_event_destroy(event);
+
+	litest_assert_empty_queue(li);
+
+	ck_assert_int_eq(libinput_path_add_devices(li, paths, 0, NULL), 0);
+
+	paths[1] = NULL;
+	litest_set_log_handler_bug(li);
+	ck_assert_int_eq(libinput_path_add_devices(li, paths, 3, NULL), -1);
+	litest_restore_log_handler(li);
+
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	litest_destroy_context(li);
+	libevdev_uinput_destroy(uinput1);
+	libevdev_uinput_destroy(uinput2);
+}
+END_TEST
+
+START_TEST(path_shared_data)
+{
+	struct libinput *li1, *li2;
+	struct libinput_shared_data *data;
+	struct libinput_device *device1, *device2;
+	struct libevdev_uinput *uinput;
+	const char *path;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+	path = libevdev_uinput_get_devnode(uinput);
+
+	data = libinput_shared_data_new();
+	ck_assert_notnull(data);
+
+	li1 = litest_create_context();
+	li2 = litest_create_context();
+	ck_assert_int_eq(libinput_attach_shared_data(li1, data), 0);
+	ck_assert_int_eq(libinput_attach_shared_data(li2, data), 0);
+
+	litest_set_log_handler_bug(li1);
+	ck_assert_int_eq(libinput_attach_shared_data(li1, data), -1);
+	litest_restore_log_handler(li1);
+
+	/* the contexts keep the data alive */
+	ck_assert(libinput_shared_data_unref(data) == data);
+
+	device1 = libinput_path_add_device(li1, path);
+	device2 = libinput_path_add_device(li2, path);
+	ck_assert_notnull(device1);
+	ck_assert_notnull(device2);
+
+	litest_drain_events(li1);
+	litest_drain_events(li2);
+
+	libinput_path_remove_device(device1);
+	litest_destroy_context(li1);
+
+	libinput_path_remove_device(device2);
+	libinput_dispatch(li2);
+	litest_drain_events(li2);
+	litest_destroy_context(li2);
+
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+static struct libinput *quirks_log_li1, *quirks_log_li2;
+static int quirks_log_reason[2];
+static int quirks_log_failed[2];
+
+LIBINPUT_ATTRIBUTE_PRINTF(3, 0)
+static void
+shared_quirks_log_handler(struct libinput *libinput,
+			  enum libinput_log_priority priority,
+			  const char *format,
+			  va_list args)
+{
+	char msg[256];
+	int idx;
+
+	if (priority != LIBINPUT_LOG_PRIORITY_ERROR)
+		return;
+
+	if (libinput == quirks_log_li1)
+		idx = 0;
+	else if (libinput == quirks_log_li2)
+		idx = 1;
+	else
+		litest_abort_msg("Log message for an unknown context");
+
+	vsnprintf(msg, sizeof(msg), format, args);
+	if (strstr(msg, "failed to find data files"))
+		quirks_log_reason[idx]++;
+	if (strstr(msg, "Failed to load the device quirks"))
+		quirks_log_failed[idx]++;
+}
+
+START_TEST(path_shared_data_quirks_log)
+{
+	struct libinput *li1, *li2;
+	struct libinput_shared_data *data;
+	struct libinput_device *device1, *device2;
+	struct libevdev_uinput *uinput;
+	char quirks_dir[] = "/tmp/litest-quirks-XXXXXX";
+	char *old_quirks_dir;
+	const char *path;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+	path = libevdev_uinput_get_devnode(uinput);
+
+	/* An empty quirks directory fails to load, the reason must be
+	 * logged through the context that loads the shared quirks */
+	ck_assert_notnull(mkdtemp(quirks_dir));
+	old_quirks_dir = safe_strdup(getenv("LIBINPUT_QUIRKS_DIR"));
+	setenv("LIBINPUT_QUIRKS_DIR", quirks_dir, 1);
+
+	data = libinput_shared_data_new();
+	li1 = litest_create_context();
+	li2 = litest_create_context();
+	ck_assert_int_eq(libinput_attach_shared_data(li1, data), 0);
+	ck_assert_int_eq(libinput_attach_shared_data(li2, data), 0);
+	libinput_shared_data_unref(data);
+
+	quirks_log_li1 = li1;
+	quirks_log_li2 = li2;
+	libinput_log_set_handler(li1, shared_quirks_log_handler);
+	libinput_log_set_handler(li2, shared_quirks_log_handler);
+
+	device1 = libinput_path_add_device(li1, path);
+	device2 = libinput_path_add_device(li2, path);
+	ck_assert_notnull(device1);
+	ck_assert_notnull(device2);
+
+	ck_assert_int_eq(quirks_log_reason[0], 1);
+	ck_assert_int_eq(quirks_log_reason[1], 0);
+	ck_assert_int_eq(quirks_log_failed[0], 1);
+	ck_assert_int_eq(quirks_log_failed[1], 1);
+
+	if (old_quirks_dir)
+		setenv("LIBINPUT_QUIRKS_DIR", old_quirks_dir, 1);
+	else
+		unsetenv("LIBINPUT_QUIRKS_DIR");
+	free(old_quirks_dir);
+	rmdir(quirks_dir);
+
+	litest_restore_log_handler(li1);
+	litest_restore_log_handler(li2);
+
+	libinput_path_remove_device(device1);
+	litest_destroy_context(li1);
+
+	libinput_path_remove_device(device2);
+	libinput_dispatch(li2);
+	litest_drain_events(li2);
+	litest_destroy_context(li2);
+
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+START_TEST(path_shared_data_after_device)
+{
+	struct libinput *li;
+	struct libinput_shared_data *data;
+	struct libevdev_uinput *uinput;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+
+	li = litest_create_context();
+	ck_assert_notnull(libinput_path_add_device(li,
+				libevdev_uinput_get_devnode(uinput)));
+
+	data = libinput_shared_data_new();
+	litest_set_log_handler_bug(li);
+	ck_assert_int_eq(libinput_attach_shared_data(li, data), -1);
+	litest_restore_log_handler(li);
+	ck_assert(libinput_shared_data_unref(data) == NULL);
+
+	litest_destroy_context(li);
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+START_TEST(path_loop)
+{
+	struct libinput *li1, *li2;
+	struct libinput_loop *loop;
+	struct libinput_event *event;
+	struct libevdev_uinput *uinput;
+	const char *path;
+	struct libinput *contexts[2];
+	struct libinput **li;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+	path = libevdev_uinput_get_devnode(uinput);
+
+	loop = libinput_loop_new();
+	ck_assert_notnull(loop);
+
+	li1 = litest_create_context();
+	li2 = litest_create_context();
+	ck_assert_int_eq(libinput_attach_loop(li1, loop), 0);
+	ck_assert_int_eq(libinput_attach_loop(li2, loop), 0);
+	ck_assert_int_eq(libinput_get_fd(li1), libinput_loop_get_fd(loop));
+	ck_assert_int_eq(libinput_get_fd(li2), libinput_loop_get_fd(loop));
+
+	litest_set_log_handler_bug(li1);
+	ck_assert_int_eq(libinput_attach_loop(li1, loop), -1);
+	litest_restore_log_handler(li1);
+
+	/* the contexts keep the loop alive */
+	ck_assert(libinput_loop_unref(loop) == loop);
+
+	ck_assert_notnull(libinput_path_add_device(li1, path));
+	ck_assert_notnull(libinput_path_add_device(li2, path));
+	litest_drain_events(li1);
+	litest_drain_events(li2);
+
+	libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+
+	/* one dispatch reads the events of both contexts */
+	msleep(10);
+	ck_assert_int_eq(libinput_loop_dispatch(loop), 0);
+
+	contexts[0] = li1;
+	contexts[1] = li2;
+	ARRAY_FOR_EACH(contexts, li) {
+		event = libinput_get_event(*li);
+		ck_assert_notnull(event);
+		ck_assert_int_eq(libinput_event_get_type(event),
+				 LIBINPUT_EVENT_POINTER_MOTION);
+		libinput_event_destroy(event);
+	}
+
+	litest_destroy_context(li1);
+	litest_destroy_context(li2);
+
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+START_TEST(path_loop_after_device)
+{
+	struct libinput *li;
+	struct libinput_loop *loop;
+	struct libevdev_uinput *uinput;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+
+	li = litest_create_context();
+	ck_assert_notnull(libinput_path_add_device(li,
+				libevdev_uinput_get_devnode(uinput)));
+
+	loop = libinput_loop_new();
+	litest_set_log_handler_bug(li);
+	ck_assert_int_eq(libinput_attach_loop(li, loop), -1);
+	litest_restore_log_handler(li);
+	ck_assert(libinput_loop_unref(loop) == NULL);
+
+	litest_destroy_context(li);
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+static int source_added_fd = -1;
+static int source_removed_fd = -1;
+
+static void
+source_handler(struct libinput *li,
+	       int fd,
+	       enum libinput_source_change change)
+{
+	switch (change) {
+	case LIBINPUT_SOURCE_ADDED:
+		source_added_fd = fd;
+		break;
+	case LIBINPUT_SOURCE_REMOVED:
+		source_removed_fd = fd;
+		break;
+	}
+}
+
+START_TEST(path_dispatch_source)
+{
+	struct libinput *li;
+	struct libinput_device *device;
+	struct libinput_event *event;
+	struct libevdev_uinput *uinput;
+	struct pollfd fds;
+	int sources[4];
+	int fd;
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+
+	li = litest_create_context();
+	libinput_set_source_handler(li, source_handler);
+
+	/* the timer only */
+	ck_assert_int_eq(libinput_get_source_fds(li, sources, 4), 1);
+
+	source_added_fd = -1;
+	device = libinput_path_add_device(li,
+					  libevdev_uinput_get_devnode(uinput));
+	ck_assert_notnull(device);
+	fd = source_added_fd;
+	ck_assert_int_ge(fd, 0);
+
+	ck_assert_int_eq(libinput_get_source_fds(li, NULL, 0), 2);
+	ck_assert_int_eq(libinput_get_source_fds(li, sources, 4), 2);
+	ck_assert(sources[0] == fd || sources[1] == fd);
+
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+
+	fds.fd = fd;
+	fds.events = POLLIN;
+	fds.revents = 0;
+	ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+
+	ck_assert_int_eq(libinput_dispatch_source(li, fd), 0);
+	event = libinput_get_event(li);
+	ck_assert_notnull(event);
+	ck_assert_int_eq(libinput_event_get_type(event),
+			 LIBINPUT_EVENT_POINTER_MOTION);
+	libinput_event_destroy(event);
+
+	ck_assert_int_eq(libinput_dispatch_source(li, -1), -ENOENT);
+
+	source_removed_fd = -1;
+	libinput_path_remove_device(device);
+	ck_assert_int_eq(source_removed_fd, fd);
+	ck_assert_int_eq(libinput_get_source_fds(li, sources, 4), 1);
+	ck_assert_int_eq(libinput_dispatch_source(li, fd), -ENOENT);
+
+	litest_destroy_context(li);
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
+START_TEST(path_io_uring)
+{
+	struct libinput *li;
+	struct libinput_device *device;
+	struct libinput_event *event;
+	struct libevdev_uinput *uinput;
+	struct pollfd fds;
+	int sources[4];
+
+	uinput = litest_create_uinput_device("test device", NULL,
+					     EV_KEY, BTN_LEFT,
+					     EV_KEY, BTN_RIGHT,
+					     EV_REL, REL_X,
+					     EV_REL, REL_Y,
+					     -1);
+
+	li = litest_create_context();
+	if (libinput_enable_io_uring(li, 1) != 0) {
+		/* not supported by the kernel, nothing to test */
+		litest_destroy_context(li);
+		libevdev_uinput_destroy(uinput);
+		return;
+	}
+
+	device = libinput_path_add_device(li,
+					  libevdev_uinput_get_devnode(uinput));
+	ck_assert_notnull(device);
+
+	/* the timer and the ring, no source for the device */
+	ck_assert_int_eq(libinput_get_source_fds(li, sources, 4), 2);
+
+	litest_drain_events(li);
+
+	libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+	libevdev_uinput_write_event(uinput, EV_KEY, BTN_LEFT, 1);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+
+	fds.fd = libinput_get_fd(li);
+	fds.events = POLLIN;
+	fds.revents = 0;
+	ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	ck_assert_notnull(event);
+	ck_assert_int_eq(libinput_event_get_type(event),
+			 LIBINPUT_EVENT_POINTER_MOTION);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	ck_assert_notnull(event);
+	ck_assert_int_eq(libinput_event_get_type(event),
+			 LIBINPUT_EVENT_POINTER_BUTTON);
+	libinput_event_destroy(event);
+
+	libevdev_uinput_write_event(uinput, EV_KEY, BTN_LEFT, 0);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+	ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	ck_assert_notnull(event);
+	ck_assert_int_eq(libinput_event_get_type(event),
+			 LIBINPUT_EVENT_POINTER_BUTTON);
+	libinput_event_destroy(event);
+
+	libinput_path_remove_device(device);
+	litest_drain_events(li);
+
+	litest_destroy_context(li);
+	libevdev_uinput_destroy(uinput);
+}
+END_TEST
+
 START_TEST(path_device_sysname)
 {
 	struct litest_device *dev = litest_current_device();
@@ -1034,6 +1531,14 @@ TEST_COLLECTION(path)
 	litest_add(path_device_sysname, LITEST_ANY, LITEST_ANY);
 	litest_add_for_device(path_add_device, LITEST_SYNAPTICS_CLICKPAD_X220);
 	litest_add_no_device(path_add_invalid_path);
+	litest_add_no_device(path_add_devices);
+	litest_add_no_device(path_shared_data);
+	litest_add_no_device(path_shared_data_after_device);
+	litest_add_no_device(path_shared_data_quirks_log);
+	litest_add_no_device(path_loop);
+	litest_add_no_device(path_loop_after_device);
+	litest_add_no_device(path_dispatch_source);
+	litest_add_no_device(path_io_uring);
 	litest_add_for_device(path_remove_device, LITEST_SYNAPTICS_CLICKPAD_X220);
 	litest_add_for_device(path_double_remove_device, LITEST_SYNAPTICS_CLICKPAD_X220);
 	litest_add_no_device(path_seat_recycle);
@@ -3147,6 +3147,161 @@ START_TEST(debounce_remove_device_button_down)
 }
 END_TEST
 
+static inline double
+passthrough_motion_ratio(struct litest_device *dev, int dx)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+	double ratio;
+
+	litest_event(dev, EV_REL, REL_X, dx);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_motion_event(event);
+	ratio = libinput_event_pointer_get_dx(ptrev) /
+		libinput_event_pointer_get_dx_unaccelerated(ptrev);
+	libinput_event_destroy(event);
+
+	return ratio;
+}
+
+START_TEST(pointer_passthrough)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	enum libinput_config_status status;
+	double slow, fast;
+
+	if (!libinput_device_config_passthrough_is_available(device))
+		return;
+
+	ck_assert_int_eq(libinput_device_config_passthrough_get_default_enabled(device),
+			 LIBINPUT_CONFIG_PASSTHROUGH_DISABLED);
+	ck_assert_int_eq(libinput_device_config_passthrough_get_enabled(device),
+			 LIBINPUT_CONFIG_PASSTHROUGH_DISABLED);
+
+	status = libinput_device_config_passthrough_set_enabled(device,
+					LIBINPUT_CONFIG_PASSTHROUGH_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_passthrough_get_enabled(device),
+			 LIBINPUT_CONFIG_PASSTHROUGH_ENABLED);
+	status = libinput_device_config_passthrough_set_enabled(device, 3);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+
+	/* takes effect at the end of the next frame */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+
+	/* no acceleration */
+	slow = passthrough_motion_ratio(dev, 1);
+	fast = passthrough_motion_ratio(dev, 50);
+	litest_assert_double_lt(fabs(slow - fast), 0.0001);
+
+	/* no debouncing */
+	litest_event(dev, EV_KEY, BTN_LEFT, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_KEY, BTN_LEFT, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_KEY, BTN_LEFT, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_KEY, BTN_LEFT, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+
+	status = libinput_device_config_passthrough_set_enabled(device,
+					LIBINPUT_CONFIG_PASSTHROUGH_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(pointer_passthrough_during_click)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	enum libinput_config_status status;
+
+	if (!libinput_device_config_passthrough_is_available(device))
+		return;
+
+	disable_button_scrolling(dev);
+	litest_drain_events(li);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+
+	status = libinput_device_config_passthrough_set_enabled(device,
+					LIBINPUT_CONFIG_PASSTHROUGH_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+
+	/* still debounced while the button is down */
+	litest_event(dev, EV_KEY, BTN_LEFT, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_KEY, BTN_LEFT, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+	litest_timeout_debounce();
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+
+	/* switch happens with the next frame */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_drain_events(li);
+
+	litest_event(dev, EV_KEY, BTN_LEFT, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_KEY, BTN_LEFT, 0);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(pointer_passthrough_unavailable)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert(!libinput_device_config_passthrough_is_available(device));
+	status = libinput_device_config_passthrough_set_enabled(device,
+					LIBINPUT_CONFIG_PASSTHROUGH_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_UNSUPPORTED);
+	status = libinput_device_config_passthrough_set_enabled(device,
+					LIBINPUT_CONFIG_PASSTHROUGH_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_passthrough_get_enabled(device),
+			 LIBINPUT_CONFIG_PASSTHROUGH_DISABLED);
+}
+END_TEST
+
 TEST_COLLECTION(pointer)
 {
 	struct range axis_range = {ABS_X, ABS_Y + 1};
@@ -3239,4 +3394,9 @@ TEST_COLLECTION(pointer)
 	litest_add(debounce_spurious_switch_to_otherbutton, LITEST_BUTTON, LITEST_TOUCHPAD|LITEST_NO_DEBOUNCE);
 	litest_add_no_device(debounce_remove_device_button_down);
 	litest_add_no_device(debounce_remove_device_button_up);
+
+	litest_add_for_device(pointer_passthrough, LITEST_MOUSE);
+	litest_add_for_device(pointer_passthrough_during_click, LITEST_MOUSE);
+	litest_add(pointer_passthrough_unavailable, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add(pointer_passthrough_unavailable, LITEST_TOUCH, LITEST_ANY);
 }
@@ -590,6 +590,42 @@ START_TEST(lid_open_on_key)
 }
 END_TEST
 
+START_TEST(lid_open_on_key_switch_readded)
+{
+	struct litest_device *keyboard = litest_current_device();
+	struct litest_device *sw;
+	struct libinput *li = keyboard->libinput;
+	struct libinput_event *event;
+
+	/* the switch is added after the keyboard, removed and added again
+	 * and must pair with the keyboard each time */
+	sw = litest_add_device(li, LITEST_LID_SWITCH);
+	litest_delete_device(sw);
+	sw = litest_add_device(li, LITEST_LID_SWITCH);
+	litest_drain_events(li);
+
+	litest_grab_device(sw);
+	litest_switch_action(sw,
+			     LIBINPUT_SWITCH_LID,
+			     LIBINPUT_SWITCH_STATE_ON);
+	litest_drain_events(li);
+
+	litest_keyboard_key(keyboard, KEY_A, true);
+	litest_keyboard_key(keyboard, KEY_A, false);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	litest_is_switch_event(event,
+			       LIBINPUT_SWITCH_LID,
+			       LIBINPUT_SWITCH_STATE_OFF);
+	libinput_event_destroy(event);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_KEYBOARD_KEY);
+	litest_ungrab_device(sw);
+
+	litest_delete_device(sw);
+}
+END_TEST
+
 START_TEST(lid_open_on_key_touchpad_enabled)
 {
 	struct litest_device *sw = litest_current_device();
@@ -950,6 +986,47 @@ START_TEST(tablet_mode_disable_touchpad_on_init)
 }
 END_TEST
 
+START_TEST(tablet_mode_disable_touchpad_switch_readded)
+{
+	struct litest_device *touchpad = litest_current_device();
+	struct litest_device *sw;
+	struct libinput *li = touchpad->libinput;
+
+	litest_disable_tap(touchpad->libinput_device);
+
+	/* the switch is added after the touchpad, removed and added again
+	 * and must pair with the touchpad each time */
+	sw = litest_add_device(li, LITEST_THINKPAD_EXTRABUTTONS);
+	litest_delete_device(sw);
+	sw = litest_add_device(li, LITEST_THINKPAD_EXTRABUTTONS);
+	litest_drain_events(li);
+
+	litest_grab_device(sw);
+	litest_switch_action(sw,
+			     LIBINPUT_SWITCH_TABLET_MODE,
+			     LIBINPUT_SWITCH_STATE_ON);
+	litest_drain_events(li);
+
+	litest_touch_down(touchpad, 0, 50, 50);
+	litest_touch_move_to(touchpad, 0, 50, 50, 70, 50, 10);
+	litest_touch_up(touchpad, 0);
+	litest_assert_empty_queue(li);
+
+	litest_switch_action(sw,
+			     LIBINPUT_SWITCH_TABLET_MODE,
+			     LIBINPUT_SWITCH_STATE_OFF);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_SWITCH_TOGGLE);
+
+	litest_touch_down(touchpad, 0, 50, 50);
+	litest_touch_move_to(touchpad, 0, 50, 50, 70, 50, 10);
+	litest_touch_up(touchpad, 0);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+	litest_ungrab_device(sw);
+
+	litest_delete_device(sw);
+}
+END_TEST
+
 START_TEST(tablet_mode_disable_touchpad_on_resume)
 {
 	struct litest_device *sw = litest_current_device();
@@ -1389,6 +1466,7 @@ TEST_COLLECTION(switch)
 	litest_add_ranged_no_device(switch_suspend_with_touchpad, &switches);
 
 	litest_add(lid_open_on_key, LITEST_SWITCH, LITEST_ANY);
+	litest_add_for_device(lid_open_on_key_switch_readded, LITEST_KEYBOARD);
 	litest_add(lid_open_on_key_touchpad_enabled, LITEST_SWITCH, LITEST_ANY);
 	litest_add_for_device(lid_update_hw_on_key, LITEST_LID_SWITCH_SURFACE3);
 	litest_add_for_device(lid_update_hw_on_key_closed_on_init, LITEST_LID_SWITCH_SURFACE3);
@@ -1396,6 +1474,7 @@ TEST_COLLECTION(switch)
 	litest_add_for_device(lid_key_press, LITEST_GPIO_KEYS);
 
 	litest_add(tablet_mode_disable_touchpad_on_init, LITEST_SWITCH, LITEST_ANY);
+	litest_add_for_device(tablet_mode_disable_touchpad_switch_readded, LITEST_SYNAPTICS_I2C);
 	litest_add(tablet_mode_disable_touchpad_on_resume, LITEST_SWITCH, LITEST_ANY);
 	litest_add(tablet_mode_enable_touchpad_on_resume, LITEST_SWITCH, LITEST_ANY);
 	litest_add(tablet_mode_disable_keyboard, LITEST_SWITCH, LITEST_ANY);
@@ -1031,6 +1031,48 @@ START_TEST(proximity_in_out)
 }
 END_TEST
 
+START_TEST(proximity_in_out_masked)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	enum libinput_event_type types[] = {
+		LIBINPUT_EVENT_TABLET_TOOL_AXIS,
+		LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY,
+		LIBINPUT_EVENT_TABLET_TOOL_TIP,
+		LIBINPUT_EVENT_TABLET_TOOL_BUTTON,
+	};
+	enum libinput_event_type *type;
+
+	litest_drain_events(li);
+
+	ARRAY_FOR_EACH(types, type)
+		ck_assert_int_eq(libinput_set_event_mask(li, *type, 1), 0);
+
+	/* masked tablet events are discarded, not leaked or crashing */
+	litest_tablet_proximity_in(dev, 10, 10, axes);
+	litest_tablet_motion(dev, 20, 20, axes);
+	litest_tablet_proximity_out(dev);
+	libinput_dispatch(li);
+	litest_timeout_tablet_proxout();
+	libinput_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	ARRAY_FOR_EACH(types, type)
+		ck_assert_int_eq(libinput_set_event_mask(li, *type, 0), 0);
+
+	litest_tablet_proximity_in(dev, 10, 10, axes);
+	libinput_dispatch(li);
+	litest_assert_tablet_proximity_event(li,
+					     LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN);
+	litest_drain_events(li);
+}
+END_TEST
+
 START_TEST(proximity_in_button_down)
 {
 	struct litest_device *dev = litest_current_device();
@@ -1817,6 +1859,199 @@ START_TEST(motion)
 }
 END_TEST
 
+START_TEST(motion_history)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_event *event;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ ABS_TILT_X, 40 },
+		{ ABS_TILT_Y, 60 },
+		{ -1, -1 }
+	};
+	double last_x = 0, last_tilt = -90;
+	uint64_t last_time = 0;
+
+	litest_tablet_proximity_in(dev, 5, 50, axes);
+	litest_drain_events(li);
+
+	libinput_enable_tablet_tool_history(li, 1);
+
+	for (int i = 0; i < 5; i++) {
+		litest_axis_set_value(axes, ABS_TILT_X, 40 + i * 5);
+		litest_tablet_motion(dev, 10 + i * 10, 50, axes);
+	}
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 4);
+	ck_assert(libinput_event_tablet_tool_x_has_changed(tev));
+	ck_assert(libinput_event_tablet_tool_tilt_x_has_changed(tev));
+
+	for (unsigned int i = 0; i < 4; i++) {
+		double x, tilt;
+		uint64_t time;
+
+		x = libinput_event_tablet_tool_get_historical_x(tev, i);
+		tilt = libinput_event_tablet_tool_get_historical_tilt_x(tev, i);
+		time = libinput_event_tablet_tool_get_historical_time_usec(tev, i);
+
+		litest_assert_double_gt(x, last_x);
+		litest_assert_double_gt(tilt, last_tilt);
+		ck_assert_int_ge(time, last_time);
+		litest_assert_double_eq(libinput_event_tablet_tool_get_historical_pressure(tev, i),
+					0.0);
+
+		last_x = x;
+		last_tilt = tilt;
+		last_time = time;
+	}
+
+	litest_assert_double_gt(libinput_event_tablet_tool_get_x(tev), last_x);
+	litest_assert_double_gt(libinput_event_tablet_tool_get_tilt_x(tev), last_tilt);
+	ck_assert_int_ge(libinput_event_tablet_tool_get_time_usec(tev), last_time);
+
+	/* out of range */
+	litest_disable_log_handler(li);
+	litest_assert_double_eq(libinput_event_tablet_tool_get_historical_x(tev, 4),
+				0.0);
+	litest_restore_log_handler(li);
+
+	libinput_event_destroy(event);
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(motion_history_tip)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_event *event;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+
+	litest_tablet_proximity_in(dev, 5, 50, axes);
+	litest_drain_events(li);
+
+	libinput_enable_tablet_tool_history(li, 1);
+
+	litest_tablet_motion(dev, 10, 50, axes);
+	litest_tablet_motion(dev, 20, 50, axes);
+	litest_axis_set_value(axes, ABS_DISTANCE, 0);
+	litest_axis_set_value(axes, ABS_PRESSURE, 30);
+	litest_push_event_frame(dev);
+	litest_tablet_motion(dev, 30, 50, axes);
+	litest_event(dev, EV_KEY, BTN_TOUCH, 1);
+	litest_pop_event_frame(dev);
+	litest_tablet_motion(dev, 40, 50, axes);
+	litest_tablet_motion(dev, 50, 50, axes);
+	libinput_dispatch(li);
+
+	/* never coalesced across the tip event */
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 1);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_TIP);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 0);
+	libinput_event_destroy(event);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 1);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_tip_state(tev),
+			 LIBINPUT_TABLET_TOOL_TIP_DOWN);
+	libinput_event_destroy(event);
+
+	litest_assert_empty_queue(li);
+
+	/* disabled again: one event per frame */
+	libinput_enable_tablet_tool_history(li, 0);
+	litest_tablet_motion(dev, 60, 50, axes);
+	litest_tablet_motion(dev, 70, 50, axes);
+	libinput_dispatch(li);
+
+	for (int i = 0; i < 2; i++) {
+		event = libinput_get_event(li);
+		tev = litest_is_tablet_event(event,
+					     LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+		ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 0);
+		libinput_event_destroy(event);
+	}
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(motion_history_export)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_event *event;
+	struct libinput_event_export_reader *reader;
+	struct libinput_event_export_record record;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+
+	litest_tablet_proximity_in(dev, 5, 50, axes);
+	litest_drain_events(li);
+
+	libinput_enable_tablet_tool_history(li, 1);
+	ck_assert_int_eq(libinput_enable_event_export(li, 16), 0);
+	reader = libinput_event_export_reader_new(libinput_get_event_export_fd(li));
+	ck_assert_notnull(reader);
+
+	for (int i = 0; i < 5; i++)
+		litest_tablet_motion(dev, 10 + i * 10, 50, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	ck_assert_int_eq(libinput_event_tablet_tool_get_history_size(tev), 4);
+
+	/* one record per sample, the last one is the merged event */
+	for (unsigned int i = 0; i < 5; i++) {
+		double x;
+		uint64_t time;
+
+		if (i < 4) {
+			x = libinput_event_tablet_tool_get_historical_x(tev, i);
+			time = libinput_event_tablet_tool_get_historical_time_usec(tev, i);
+		} else {
+			x = libinput_event_tablet_tool_get_x(tev);
+			time = libinput_event_tablet_tool_get_time_usec(tev);
+		}
+
+		ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 1);
+		ck_assert_int_eq(record.type, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+		litest_assert_double_eq(record.x, x);
+		ck_assert(record.time_usec == time);
+	}
+	ck_assert_int_eq(libinput_event_export_reader_read(reader, &record), 0);
+	ck_assert(libinput_event_export_reader_get_overflow_count(reader) == 0);
+
+	libinput_event_destroy(event);
+	litest_assert_empty_queue(li);
+
+	libinput_event_export_reader_destroy(reader);
+	libinput_enable_event_export(li, 0);
+	libinput_enable_tablet_tool_history(li, 0);
+}
+END_TEST
+
 START_TEST(left_handed)
 {
 #if HAVE_LIBWACOM
@@ -6069,6 +6304,132 @@ START_TEST(tablet_smoothing)
 }
 END_TEST
 
+START_TEST(tablet_smoothing_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_tablet_smoothing_method method;
+	enum libinput_config_status status;
+	uint32_t methods;
+
+	methods = libinput_device_config_tablet_smoothing_get_methods(device);
+	ck_assert(methods & LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE);
+	ck_assert(methods & LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+
+	method = libinput_device_config_tablet_smoothing_get_default_method(device);
+	ck_assert_int_eq(libinput_device_config_tablet_smoothing_get_method(device),
+			 method);
+
+	status = libinput_device_config_tablet_smoothing_set_method(device,
+			LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_tablet_smoothing_get_method(device),
+			 LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+	status = libinput_device_config_tablet_smoothing_set_method(device,
+			LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE |
+			LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	ck_assert_int_eq(libinput_device_config_tablet_smoothing_get_method(device),
+			 LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+
+	litest_assert_double_eq(libinput_device_config_tablet_smoothing_get_default_responsiveness(device),
+				libinput_device_config_tablet_smoothing_get_responsiveness(device));
+	status = libinput_device_config_tablet_smoothing_set_responsiveness(device, 0.8);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	litest_assert_double_eq(libinput_device_config_tablet_smoothing_get_responsiveness(device),
+				0.8);
+	status = libinput_device_config_tablet_smoothing_set_responsiveness(device, 1.2);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	status = libinput_device_config_tablet_smoothing_set_responsiveness(device, -0.1);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+	litest_assert_double_eq(libinput_device_config_tablet_smoothing_get_responsiveness(device),
+				0.8);
+}
+END_TEST
+
+START_TEST(tablet_smoothing_config_unsupported)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert_int_eq(libinput_device_config_tablet_smoothing_get_methods(device),
+			 0);
+	ck_assert_int_eq(libinput_device_config_tablet_smoothing_get_method(device),
+			 LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE);
+	status = libinput_device_config_tablet_smoothing_set_method(device,
+			LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	status = libinput_device_config_tablet_smoothing_set_method(device,
+			LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_UNSUPPORTED);
+	status = libinput_device_config_tablet_smoothing_set_responsiveness(device, 0.5);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_UNSUPPORTED);
+}
+END_TEST
+
+static double
+tablet_smoothing_step(struct litest_device *dev,
+		      enum libinput_config_tablet_smoothing_method method)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 }
+	};
+	double x;
+
+	libinput_device_config_tablet_smoothing_set_method(dev->libinput_device,
+							   method);
+	libinput_device_config_tablet_smoothing_set_responsiveness(dev->libinput_device,
+								   1.0);
+
+	litest_tablet_proximity_in(dev, 20, 50, axes);
+	for (int i = 0; i < 5; i++) {
+		msleep(10);
+		litest_tablet_motion(dev, 20, 50, axes);
+	}
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	/* A fast stroke, the tool jumps to the new position */
+	msleep(10);
+	litest_tablet_motion(dev, 60, 50, axes);
+	libinput_dispatch(li);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_AXIS);
+	x = libinput_event_tablet_tool_get_x_transformed(tev, 100);
+	libinput_event_destroy(event);
+
+	litest_tablet_proximity_out(dev);
+	litest_drain_events(li);
+
+	return x;
+}
+
+START_TEST(tablet_smoothing_adaptive)
+{
+	struct litest_device *dev = litest_current_device();
+	double average, adaptive, none;
+
+	litest_drain_events(dev->libinput);
+
+	none = tablet_smoothing_step(dev, LIBINPUT_CONFIG_TABLET_SMOOTHING_NONE);
+	average = tablet_smoothing_step(dev, LIBINPUT_CONFIG_TABLET_SMOOTHING_AVERAGE);
+	adaptive = tablet_smoothing_step(dev, LIBINPUT_CONFIG_TABLET_SMOOTHING_ADAPTIVE);
+
+	/* The average lags by several events, the adaptive filter
+	 * follows a fast stroke almost immediately */
+	litest_assert_double_lt(average, 40);
+	litest_assert_double_gt(adaptive, 50);
+	litest_assert_double_le(adaptive, none);
+}
+END_TEST
+
 TEST_COLLECTION(tablet)
 {
 	struct range with_timeout = { 0, 2 };
@@ -6097,6 +6458,7 @@ TEST_COLLECTION(tablet)
 	litest_add_for_device(tool_delayed_serial, LITEST_WACOM_HID4800_PEN);
 	litest_add(proximity_out_clear_buttons, LITEST_TABLET, LITEST_FORCED_PROXOUT);
 	litest_add(proximity_in_out, LITEST_TABLET, LITEST_ANY);
+	litest_add(proximity_in_out_masked, LITEST_TABLET, LITEST_ANY);
 	litest_add(proximity_in_button_down, LITEST_TABLET, LITEST_ANY);
 	litest_add(proximity_out_button_up, LITEST_TABLET, LITEST_ANY);
 	litest_add(proximity_has_axes, LITEST_TABLET, LITEST_ANY);
@@ -6129,6 +6491,9 @@ TEST_COLLECTION(tablet)
 	litest_add_no_device(tip_up_on_delete);
 	litest_add(motion, LITEST_TABLET, LITEST_ANY);
 	litest_add(motion_event_state, LITEST_TABLET, LITEST_ANY);
+	litest_add_for_device(motion_history, LITEST_WACOM_INTUOS);
+	litest_add_for_device(motion_history_tip, LITEST_WACOM_INTUOS);
+	litest_add_for_device(motion_history_export, LITEST_WACOM_INTUOS);
 	litest_add_for_device(motion_outside_bounds, LITEST_WACOM_CINTIQ_24HD);
 	litest_add(tilt_available, LITEST_TABLET|LITEST_TILT, LITEST_ANY);
 	litest_add(tilt_not_available, LITEST_TABLET, LITEST_TILT);
@@ -6195,4 +6560,7 @@ TEST_COLLECTION(tablet)
 	litest_add_ranged_for_device(huion_static_btn_tool_pen_disable_quirk_on_prox_out, LITEST_HUION_TABLET, &with_timeout);
 
 	litest_add_for_device(tablet_smoothing, LITEST_WACOM_HID4800_PEN);
+	litest_add(tablet_smoothing_config, LITEST_TABLET, LITEST_TOTEM);
+	litest_add(tablet_smoothing_config_unsupported, LITEST_ANY, LITEST_TABLET);
+	litest_add_for_device(tablet_smoothing_adaptive, LITEST_WACOM_INTUOS);
 }
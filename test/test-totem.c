@@ -549,6 +549,32 @@ START_TEST(totem_arbitration_during)
 }
 END_TEST
 
+START_TEST(totem_arbitration_totem_readded)
+{
+	struct litest_device *touch = litest_current_device();
+	struct litest_device *totem;
+	struct libinput *li = touch->libinput;
+
+	/* the totem is added after the touchscreen, removed and added
+	 * again and must pair with the touchscreen each time */
+	totem = litest_add_device(li, LITEST_DELL_CANVAS_TOTEM);
+	litest_delete_device(totem);
+	totem = litest_add_device(li, LITEST_DELL_CANVAS_TOTEM);
+	litest_drain_events(li);
+
+	litest_tablet_proximity_in(totem, 50, 50, NULL);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	litest_touch_down(touch, 0, 51, 51);
+	litest_touch_move_to(touch, 0, 51, 50, 90, 80, 10);
+	litest_touch_up(touch, 0);
+	litest_assert_empty_queue(li);
+
+	litest_delete_device(totem);
+}
+END_TEST
+
 START_TEST(totem_arbitration_outside_rect)
 {
 	struct litest_device *totem = litest_current_device();
@@ -601,5 +627,6 @@ TEST_COLLECTION(totem)
 
 	litest_add(totem_arbitration_below, LITEST_TOTEM, LITEST_ANY);
 	litest_add(totem_arbitration_during, LITEST_TOTEM, LITEST_ANY);
+	litest_add_for_device(totem_arbitration_totem_readded, LITEST_DELL_CANVAS_TOTEM_TOUCH);
 	litest_add(totem_arbitration_outside_rect, LITEST_TOTEM, LITEST_ANY);
 }
@@ -64,6 +64,157 @@ START_TEST(touch_frame_events)
 }
 END_TEST
 
+static struct libinput_event_touch *
+assert_touch_frame(struct libinput *li, unsigned int nslots)
+{
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_FRAME);
+	ck_assert_int_eq(libinput_event_touch_get_frame_size(tev), nslots);
+
+	return tev;
+}
+
+START_TEST(touch_frame_aggregated)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event_touch *tev;
+
+	litest_drain_events(li);
+	libinput_enable_touch_frame_aggregation(li, 1);
+
+	litest_push_event_frame(dev);
+	litest_touch_down(dev, 0, 20, 30);
+	litest_touch_down(dev, 1, 70, 60);
+	litest_pop_event_frame(dev);
+	libinput_dispatch(li);
+
+	tev = assert_touch_frame(li, 2);
+	for (unsigned int i = 0; i < 2; i++) {
+		ck_assert_int_eq(libinput_event_touch_get_frame_type(tev, i),
+				 LIBINPUT_EVENT_TOUCH_DOWN);
+		ck_assert_int_eq(libinput_event_touch_get_frame_slot(tev, i), i);
+		ck_assert_int_eq(libinput_event_touch_get_frame_seat_slot(tev, i), i);
+	}
+	litest_assert_double_gt(libinput_event_touch_get_frame_y_transformed(tev, 1, 100),
+				libinput_event_touch_get_frame_y_transformed(tev, 0, 100));
+	litest_assert_double_gt(libinput_event_touch_get_frame_x(tev, 1),
+				libinput_event_touch_get_frame_x(tev, 0));
+
+	litest_disable_log_handler(li);
+	ck_assert_int_eq(libinput_event_touch_get_frame_slot(tev, 2), -1);
+	ck_assert_int_eq(libinput_event_touch_get_frame_type(tev, 2),
+			 LIBINPUT_EVENT_NONE);
+	litest_restore_log_handler(li);
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+	litest_assert_empty_queue(li);
+
+	litest_touch_move_to(dev, 1, 70, 60, 80, 70, 1);
+	libinput_dispatch(li);
+	while (libinput_next_event_type(li) != LIBINPUT_EVENT_NONE) {
+		tev = assert_touch_frame(li, 1);
+		ck_assert_int_eq(libinput_event_touch_get_frame_type(tev, 0),
+				 LIBINPUT_EVENT_TOUCH_MOTION);
+		ck_assert_int_eq(libinput_event_touch_get_frame_slot(tev, 0), 1);
+		libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+	}
+
+	litest_push_event_frame(dev);
+	litest_touch_up(dev, 0);
+	litest_touch_up(dev, 1);
+	litest_pop_event_frame(dev);
+	libinput_dispatch(li);
+
+	tev = assert_touch_frame(li, 2);
+	for (unsigned int i = 0; i < 2; i++) {
+		ck_assert_int_eq(libinput_event_touch_get_frame_type(tev, i),
+				 LIBINPUT_EVENT_TOUCH_UP);
+		litest_assert_double_eq(libinput_event_touch_get_frame_x(tev, i),
+					0.0);
+	}
+	libinput_event_destroy(libinput_event_touch_get_base_event(tev));
+	litest_assert_empty_queue(li);
+
+	/* disabled again, per-slot events and empty frames */
+	libinput_enable_touch_frame_aggregation(li, 0);
+	litest_touch_down(dev, 0, 20, 30);
+	libinput_dispatch(li);
+	litest_assert_touch_down_frame(li);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_assert_touch_up_frame(li);
+}
+END_TEST
+
+START_TEST(touch_motion_prediction)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_touch *tev;
+	uint64_t time;
+	double x, predicted_x;
+
+	litest_drain_events(li);
+	libinput_enable_motion_prediction(li, 1);
+
+	litest_touch_down(dev, 0, 20, 50);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_DOWN);
+	litest_assert_double_eq(libinput_event_touch_get_prediction_confidence(tev),
+				0.0);
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	for (int i = 1; i <= 10; i++) {
+		litest_touch_move(dev, 0, 20 + i * 2, 50);
+		msleep(5);
+	}
+	litest_drain_events(li);
+
+	litest_touch_move(dev, 0, 44, 50);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_MOTION);
+	litest_assert_double_gt(libinput_event_touch_get_prediction_confidence(tev),
+				0.0);
+	time = libinput_event_touch_get_time_usec(tev);
+	x = libinput_event_touch_get_x_transformed(tev, 1000);
+	predicted_x = libinput_event_touch_get_predicted_x_transformed(tev,
+								      time + ms2us(10),
+								      1000);
+	litest_assert_double_gt(predicted_x, x);
+	litest_assert_double_eq(libinput_event_touch_get_predicted_x_transformed(tev, time, 1000),
+				x);
+	litest_assert_double_eq(libinput_event_touch_get_predicted_y_transformed(tev, time, 1000),
+				libinput_event_touch_get_y_transformed(tev, 1000));
+	libinput_event_destroy(event);
+	litest_drain_events(li);
+
+	/* disabled: prediction is the current position */
+	libinput_enable_motion_prediction(li, 0);
+	litest_touch_move(dev, 0, 50, 50);
+	libinput_dispatch(li);
+	event = libinput_get_event(li);
+	tev = litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_MOTION);
+	time = libinput_event_touch_get_time_usec(tev);
+	litest_assert_double_eq(libinput_event_touch_get_prediction_confidence(tev),
+				0.0);
+	litest_assert_double_eq(libinput_event_touch_get_predicted_x_transformed(tev,
+										 time + ms2us(10),
+										 1000),
+				libinput_event_touch_get_x_transformed(tev, 1000));
+	libinput_event_destroy(event);
+
+	litest_touch_up(dev, 0);
+	litest_drain_events(li);
+}
+END_TEST
+
 START_TEST(touch_downup_no_motion)
 {
 	struct litest_device *dev = litest_current_device();
@@ -1343,6 +1494,8 @@ TEST_COLLECTION(touch)
 	struct range axes = { ABS_X, ABS_Y + 1};
 
 	litest_add(touch_frame_events, LITEST_TOUCH, LITEST_ANY);
+	litest_add_for_device(touch_frame_aggregated, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add_for_device(touch_motion_prediction, LITEST_GENERIC_MULTITOUCH_SCREEN);
 	litest_add(touch_downup_no_motion, LITEST_TOUCH, LITEST_ANY);
 	litest_add(touch_downup_no_motion, LITEST_SINGLE_TOUCH, LITEST_TOUCHPAD);
 	litest_add_no_device(touch_abs_transform);
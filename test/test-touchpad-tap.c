@@ -4188,6 +4188,131 @@ START_TEST(touchpad_drag_lock_default_unavailable)
 }
 END_TEST
 
+START_TEST(touchpad_tap_adaptive_timeout_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+
+	ck_assert_int_eq(libinput_device_config_tap_get_adaptive_timeout_enabled(device),
+			 LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED);
+	ck_assert_int_eq(libinput_device_config_tap_get_default_adaptive_timeout_enabled(device),
+			 LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED);
+
+	status = libinput_device_config_tap_set_adaptive_timeout_enabled(device,
+			LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	ck_assert_int_eq(libinput_device_config_tap_get_adaptive_timeout_enabled(device),
+			 LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED);
+
+	status = libinput_device_config_tap_set_adaptive_timeout_enabled(device, 3);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+
+	ck_assert_int_eq(libinput_device_get_tap_timeout_stats(device,
+							       NULL, NULL,
+							       NULL, NULL),
+			 0);
+}
+END_TEST
+
+START_TEST(touchpad_tap_adaptive_timeout_unavailable)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+	uint64_t timeout;
+
+	ck_assert_int_eq(libinput_device_config_tap_get_adaptive_timeout_enabled(device),
+			 LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED);
+
+	status = libinput_device_config_tap_set_adaptive_timeout_enabled(device,
+			LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_UNSUPPORTED);
+	status = libinput_device_config_tap_set_adaptive_timeout_enabled(device,
+			LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED);
+	ck_assert_int_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+
+	ck_assert_int_eq(libinput_device_get_tap_timeout_stats(device,
+							       &timeout, NULL,
+							       NULL, NULL),
+			 -1);
+}
+END_TEST
+
+START_TEST(touchpad_tap_adaptive_timeout)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	uint64_t default_timeout, timeout, ntaps, saved, nsplit;
+
+	litest_enable_tap(device);
+	litest_drain_events(li);
+
+	libinput_device_get_tap_timeout_stats(device, &default_timeout,
+					      NULL, NULL, NULL);
+	libinput_device_config_tap_set_adaptive_timeout_enabled(device,
+			LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_ENABLED);
+
+	/* Quick double-taps */
+	for (int i = 0; i < 10; i++) {
+		litest_touch_down(dev, 0, 50, 50);
+		litest_touch_up(dev, 0);
+		msleep(40);
+		litest_touch_down(dev, 0, 50, 50);
+		litest_touch_up(dev, 0);
+		litest_timeout_tap();
+		litest_drain_events(li);
+	}
+
+	libinput_device_get_tap_timeout_stats(device, &timeout, &ntaps,
+					      &saved, &nsplit);
+	ck_assert_int_lt(timeout, default_timeout);
+	ck_assert_int_ge(timeout, ms2us(80));
+	ck_assert_int_eq(nsplit, 0);
+
+	/* A single tap is released before the default timeout */
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_PRESSED);
+	msleep(us2ms(timeout) + 10);
+	libinput_dispatch(li);
+	litest_assert_button_event(li, BTN_LEFT,
+				   LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_empty_queue(li);
+
+	libinput_device_get_tap_timeout_stats(device, NULL, &ntaps,
+					      &saved, NULL);
+	ck_assert_int_gt(ntaps, 0);
+	ck_assert_int_ge(saved, default_timeout - timeout);
+
+	/* A second touch after the adaptive timeout but before the default
+	 * timeout is counted as split double-tap */
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	libinput_dispatch(li);
+	msleep(us2ms(timeout) + 10);
+	libinput_dispatch(li);
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	litest_timeout_tap();
+	litest_drain_events(li);
+
+	libinput_device_get_tap_timeout_stats(device, NULL, NULL,
+					      NULL, &nsplit);
+	ck_assert_int_eq(nsplit, 1);
+
+	/* Disabled: back to the default timeout */
+	libinput_device_config_tap_set_adaptive_timeout_enabled(device,
+			LIBINPUT_CONFIG_TAP_ADAPTIVE_TIMEOUT_DISABLED);
+	libinput_device_get_tap_timeout_stats(device, &timeout, NULL,
+					      NULL, NULL);
+	ck_assert_int_eq(timeout, default_timeout);
+}
+END_TEST
+
 static inline bool
 touchpad_has_palm_pressure(struct litest_device *dev)
 {
@@ -5701,6 +5826,9 @@ TEST_COLLECTION(touchpad_tap)
 
 	litest_add(touchpad_drag_lock_default_disabled, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add(touchpad_drag_lock_default_unavailable, LITEST_ANY, LITEST_TOUCHPAD);
+	litest_add(touchpad_tap_adaptive_timeout_config, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add(touchpad_tap_adaptive_timeout_unavailable, LITEST_ANY, LITEST_TOUCHPAD);
+	litest_add(touchpad_tap_adaptive_timeout, LITEST_TOUCHPAD, LITEST_ANY);
 
 	litest_add(touchpad_drag_default_disabled, LITEST_ANY, LITEST_TOUCHPAD);
 	litest_add(touchpad_drag_default_enabled, LITEST_TOUCHPAD, LITEST_BUTTON);
@@ -419,6 +419,206 @@ START_TEST(udev_suspend_resume)
 }
 END_TEST
 
+static struct libinput_device *
+find_device_added(struct libinput *li, const char *name)
+{
+	struct libinput_event *event;
+	struct libinput_device *found = NULL;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li))) {
+		struct libinput_device *device;
+
+		if (libinput_event_get_type(event) ==
+		    LIBINPUT_EVENT_DEVICE_ADDED) {
+			device = libinput_event_get_device(event);
+			if (streq(libinput_device_get_name(device), name))
+				found = libinput_device_ref(device);
+		}
+		libinput_event_destroy(event);
+	}
+
+	return found;
+}
+
+START_TEST(udev_warm_suspend_resume)
+{
+	struct udev *udev;
+	struct libinput *li;
+	struct libinput_device *device;
+	struct libinput_event *event;
+	struct litest_device *dev;
+	int num_devices = 0;
+	bool have_motion = false;
+
+	dev = litest_create(LITEST_MOUSE, NULL, NULL, NULL, NULL);
+
+	udev = udev_new();
+	ck_assert_notnull(udev);
+
+	li = libinput_udev_create_context(&simple_interface, NULL, udev);
+	ck_assert_notnull(li);
+	libinput_enable_warm_suspend(li, 1);
+	ck_assert_int_eq(libinput_udev_assign_seat(li, "seat0"), 0);
+
+	device = find_device_added(li, libevdev_get_name(dev->evdev));
+	ck_assert_notnull(device);
+
+	/* The device is kept, no removed/added events */
+	libinput_suspend(li);
+	ck_assert_int_ge(libinput_dispatch(li), 0);
+	process_events_count_devices(li, &num_devices);
+	ck_assert_int_eq(num_devices, 0);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+
+	ck_assert_int_eq(libinput_resume(li), 0);
+	ck_assert_int_ge(libinput_dispatch(li), 0);
+	process_events_count_devices(li, &num_devices);
+	ck_assert_int_eq(num_devices, 0);
+
+	/* Events sent while suspended are discarded */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		if (libinput_event_get_device(event) == device) {
+			ck_assert_int_eq(libinput_event_get_type(event),
+					 LIBINPUT_EVENT_POINTER_MOTION);
+			ck_assert(!have_motion);
+			have_motion = true;
+		}
+		libinput_event_destroy(event);
+	}
+	ck_assert(have_motion);
+
+	libinput_device_unref(device);
+	libinput_unref(li);
+	udev_unref(udev);
+
+	litest_delete_device(dev);
+}
+END_TEST
+
+START_TEST(udev_warm_suspend_unplug)
+{
+	struct udev *udev;
+	struct libinput *li;
+	struct libinput_device *device;
+	struct libinput_event *event;
+	struct litest_device *dev;
+	bool removed = false;
+
+	dev = litest_create(LITEST_MOUSE, NULL, NULL, NULL, NULL);
+
+	udev = udev_new();
+	ck_assert_notnull(udev);
+
+	li = libinput_udev_create_context(&simple_interface, NULL, udev);
+	ck_assert_notnull(li);
+	libinput_enable_warm_suspend(li, 1);
+	ck_assert_int_eq(libinput_udev_assign_seat(li, "seat0"), 0);
+
+	device = find_device_added(li, libevdev_get_name(dev->evdev));
+	ck_assert_notnull(device);
+
+	libinput_suspend(li);
+	litest_delete_device(dev);
+
+	/* A device unplugged while suspended is removed on resume */
+	ck_assert_int_eq(libinput_resume(li), 0);
+	libinput_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		if (libinput_event_get_type(event) ==
+		    LIBINPUT_EVENT_DEVICE_REMOVED &&
+		    libinput_event_get_device(event) == device)
+			removed = true;
+		libinput_event_destroy(event);
+	}
+	ck_assert(removed);
+
+	libinput_device_unref(device);
+	libinput_unref(li);
+	udev_unref(udev);
+}
+END_TEST
+
+START_TEST(udev_hotplug_storm)
+{
+	struct udev *udev;
+	struct libinput *li;
+	struct libinput_event *event;
+	struct litest_device *transient, *dev;
+	char *transient_name;
+	const char *name;
+	bool added = false;
+	uint64_t nevents, ncancelled, nstorms;
+
+	udev = udev_new();
+	ck_assert_notnull(udev);
+
+	li = libinput_udev_create_context(&simple_interface, NULL, udev);
+	ck_assert_notnull(li);
+	ck_assert_int_eq(libinput_udev_assign_seat(li, "seat0"), 0);
+	libinput_dispatch(li);
+	litest_drain_events(li);
+
+	/* Both devices change before we dispatch, so they arrive as one
+	 * burst and the transient device is never added */
+	transient = litest_create(LITEST_MOUSE, "transient mouse",
+				  NULL, NULL, NULL);
+	transient_name = safe_strdup(libevdev_get_name(transient->evdev));
+	litest_delete_device(transient);
+	dev = litest_create(LITEST_KEYBOARD, NULL, NULL, NULL, NULL);
+	name = libevdev_get_name(dev->evdev);
+
+	while (!added) {
+		litest_wait_for_event_of_type(li,
+					      LIBINPUT_EVENT_DEVICE_ADDED,
+					      -1);
+		event = libinput_get_event(li);
+		ck_assert_str_ne(libinput_device_get_name(libinput_event_get_device(event)),
+				 transient_name);
+		added = streq(libinput_device_get_name(libinput_event_get_device(event)),
+			      name);
+		libinput_event_destroy(event);
+	}
+
+	ck_assert_int_eq(libinput_udev_get_hotplug_stats(li,
+							 &nevents,
+							 &ncancelled,
+							 &nstorms),
+			 0);
+	ck_assert_int_ge(nevents, 3);
+	ck_assert_int_ge(ncancelled, 2);
+	ck_assert_int_ge(nstorms, 1);
+
+	libinput_unref(li);
+	udev_unref(udev);
+
+	litest_delete_device(dev);
+	free(transient_name);
+}
+END_TEST
+
+START_TEST(udev_hotplug_stats_path)
+{
+	struct libinput *li;
+
+	li = litest_create_context();
+
+	litest_set_log_handler_bug(li);
+	ck_assert_int_eq(libinput_udev_get_hotplug_stats(li, NULL, NULL, NULL),
+			 -1);
+	litest_restore_log_handler(li);
+
+	litest_destroy_context(li);
+}
+END_TEST
+
 START_TEST(udev_resume_before_seat)
 {
 	struct libinput *li;
@@ -688,6 +888,10 @@ TEST_COLLECTION(udev)
 	litest_add_for_device(udev_suspend_resume, LITEST_SYNAPTICS_CLICKPAD_X220);
 	litest_add_for_device(udev_resume_before_seat, LITEST_SYNAPTICS_CLICKPAD_X220);
 	litest_add_for_device(udev_suspend_resume_before_seat, LITEST_SYNAPTICS_CLICKPAD_X220);
+	litest_add_no_device(udev_warm_suspend_resume);
+	litest_add_no_device(udev_warm_suspend_unplug);
+	litest_add_no_device(udev_hotplug_storm);
+	litest_add_no_device(udev_hotplug_stats_path);
 	litest_add_for_device(udev_device_sysname, LITEST_SYNAPTICS_CLICKPAD_X220);
 	litest_add_for_device(udev_seat_recycle, LITEST_SYNAPTICS_CLICKPAD_X220);
 
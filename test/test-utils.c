@@ -33,8 +33,11 @@
 #include "util-prop-parsers.h"
 #include "util-macros.h"
 #include "util-bits.h"
+#include "util-hash.h"
 #include "util-ratelimit.h"
+#include "util-log-ring.h"
 #include "util-matrix.h"
+#include "util-prediction.h"
 
 #define  TEST_VERSIONSORT
 #include "libinput-versionsort.h"
@@ -195,6 +198,146 @@ START_TEST(ratelimit_helpers)
 }
 END_TEST
 
+static void
+log_ring_add(struct log_ring *ring,
+	     const char *prefix,
+	     bool copy_format,
+	     const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	log_ring_record(ring,
+			1500000,
+			LIBINPUT_LOG_PRIORITY_DEBUG,
+			prefix,
+			format,
+			copy_format,
+			args);
+	va_end(args);
+}
+
+START_TEST(log_ring_helpers)
+{
+	struct log_ring ring = {0};
+	char buf[256];
+	char fmt[LOG_RING_FORMAT_SIZE * 2];
+	size_t len;
+
+	ck_assert(!log_ring_is_enabled(&ring));
+
+	log_ring_init(&ring, 2);
+	ck_assert(log_ring_is_enabled(&ring));
+
+	log_ring_add(&ring, NULL, false, "%d %5.2f %s %-*u|%%", -3, 3.14159, "foo", 4, 7u);
+	len = log_ring_format_record(&ring.records[0], buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.500000 debug: -3  3.14 foo 7   |%\n");
+	ck_assert_int_eq(len, strlen(buf));
+
+	log_ring_add(&ring, "event3", false, "%s %s\n", "a", NULL);
+	log_ring_format_record(&ring.records[1], buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.500000 debug: event3  - a (null)\n");
+
+	/* wraps around, overwriting the oldest record */
+	log_ring_add(&ring, NULL, false, "%lx %zu %hhd\n", 0xabcUL, (size_t)12, 257);
+	log_ring_format_record(&ring.records[0], buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.500000 debug: abc 12 1\n");
+
+	/* unsupported conversions truncate the message */
+	log_ring_add(&ring, NULL, false, "foo %n bar", NULL);
+	log_ring_format_record(&ring.records[1], buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.500000 debug: foo [...]\n");
+
+	/* output is truncated but still newline-terminated */
+	len = log_ring_format_record(&ring.records[0], buf, 20);
+	ck_assert_int_eq(len, 19);
+	ck_assert_str_eq(buf, "1.500000 debug: ab\n");
+
+	/* copied formats don't refer to the caller's buffer */
+	snprintf(fmt, sizeof(fmt), "libevdev: %%s %%d\n");
+	log_ring_add(&ring, NULL, true, fmt, "foo", 3);
+	memset(fmt, 'x', sizeof(fmt) - 1);
+	fmt[sizeof(fmt) - 1] = '\0';
+	log_ring_format_record(&ring.records[0], buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.500000 debug: libevdev: foo 3\n");
+
+	/* a copied format that does not fit is cut short */
+	log_ring_add(&ring, NULL, true, fmt);
+	len = log_ring_format_record(&ring.records[1], buf, sizeof(buf));
+	ck_assert_int_eq(len,
+			 strlen("1.500000 debug: ") + LOG_RING_FORMAT_SIZE - 1 +
+			 strlen("[...]\n"));
+	ck_assert(strstr(buf, "xx[...]\n"));
+
+	log_ring_destroy(&ring);
+	ck_assert(!log_ring_is_enabled(&ring));
+}
+END_TEST
+
+START_TEST(prediction_helpers)
+{
+	struct predictor predictor;
+	struct prediction prediction;
+	double x, y;
+	uint64_t t = ms2us(1000);
+
+	predictor_reset(&predictor);
+
+	/* first sample: no motion, no confidence */
+	predictor_add_sample(&predictor, t, 100, 200, &prediction);
+	ck_assert(prediction.confidence == 0.0);
+	prediction_at(&prediction, t + ms2us(10), &x, &y);
+	ck_assert(x == 100.0);
+	ck_assert(y == 200.0);
+
+	/* constant velocity of 2 units/ms in x, -1 in y */
+	for (int i = 1; i < 8; i++)
+		predictor_add_sample(&predictor,
+				     t + ms2us(5 * i),
+				     100 + 10 * i,
+				     200 - 5 * i,
+				     &prediction);
+	ck_assert(prediction.confidence == 1.0);
+	prediction_at(&prediction, t + ms2us(5 * 7 + 10), &x, &y);
+	ck_assert(fabs(x - (170 + 20)) < 0.01);
+	ck_assert(fabs(y - (165 - 10)) < 0.01);
+
+	/* times before the event return the event position */
+	prediction_at(&prediction, t, &x, &y);
+	ck_assert(x == 170.0);
+	ck_assert(y == 165.0);
+
+	/* horizon is clamped */
+	prediction_at(&prediction, t + s2us(10), &x, &y);
+	ck_assert(fabs(x - (170 + 2 * us2ms(PREDICTOR_MAX_HORIZON))) < 0.01);
+
+	/* constant acceleration: x = t² with t in ms */
+	predictor_reset(&predictor);
+	for (int i = 0; i < 6; i++)
+		predictor_add_sample(&predictor,
+				     t + ms2us(i * 4),
+				     (i * 4) * (i * 4),
+				     0,
+				     &prediction);
+	prediction_at(&prediction, t + ms2us(20 + 8), &x, &y);
+	ck_assert(fabs(x - 28 * 28) < 0.01);
+	ck_assert(fabs(y) < 0.01);
+
+	/* direction change restarts the prediction */
+	predictor_add_sample(&predictor, t + ms2us(24), 300, 0, &prediction);
+	ck_assert(prediction.confidence == 0.0);
+	ck_assert(prediction.vx < 0);
+	predictor_add_sample(&predictor, t + ms2us(28), 200, 0, &prediction);
+	ck_assert(prediction.confidence > 0.0);
+	ck_assert(prediction.confidence < 1.0);
+
+	/* a gap restarts the history */
+	predictor_add_sample(&predictor, t + ms2us(200), 200, 0, &prediction);
+	ck_assert(prediction.confidence == 0.0);
+	ck_assert(prediction.vx == 0.0);
+}
+END_TEST
+
 struct parser_test {
 	char *tag;
 	int expected_value;
@@ -1295,6 +1438,63 @@ START_TEST(list_test_append)
 }
 END_TEST
 
+START_TEST(hash_table_test)
+{
+	struct hash_test {
+		uint32_t key;
+		struct hash_node node;
+	} tests[100] = {0};
+	struct hash_test *t;
+	struct hash_table table;
+
+	hash_table_init(&table);
+
+	for (size_t i = 0; i < ARRAY_LENGTH(tests); i++) {
+		tests[i].key = i * 7;
+		hash_table_insert(&table, &tests[i].node, hash_u64(i * 7));
+	}
+	ck_assert_int_eq(table.count, ARRAY_LENGTH(tests));
+	ck_assert_int_ge(table.nbuckets, ARRAY_LENGTH(tests)/2);
+
+	for (size_t i = 0; i < ARRAY_LENGTH(tests); i += 2)
+		hash_node_remove(&tests[i].node);
+	ck_assert_int_eq(table.count, ARRAY_LENGTH(tests)/2);
+
+	/* removing twice is a noop */
+	hash_node_remove(&tests[0].node);
+	ck_assert_int_eq(table.count, ARRAY_LENGTH(tests)/2);
+
+	for (size_t i = 0; i < ARRAY_LENGTH(tests); i++) {
+		uint32_t key = i * 7;
+		int found = 0;
+
+		hash_table_for_each_match(t, &table, hash_u64(key), node) {
+			if (t->key == key)
+				found++;
+		}
+		ck_assert_int_eq(found, i % 2 ? 1 : 0);
+	}
+
+	/* colliding hashes are both found */
+	hash_table_insert(&table, &tests[0].node, hash_u64(7));
+	tests[0].key = 7;
+	{
+		int found = 0;
+
+		hash_table_for_each_match(t, &table, hash_u64(7), node) {
+			ck_assert_int_eq(t->key, 7);
+			found++;
+		}
+		ck_assert_int_eq(found, 2);
+	}
+
+	hash_table_destroy(&table);
+
+	ck_assert(hash_string("event0") != hash_string("event1"));
+	ck_assert(hash_string("event0") == hash_string("event0"));
+}
+END_TEST
+
 START_TEST(strverscmp_test)
 {
 	ck_assert_int_eq(libinput_strverscmp("", ""), 0);
@@ -1398,6 +1598,8 @@ litest_utils_suite(void)
 	tcase_add_test(tc, bitfield_helpers);
 	tcase_add_test(tc, matrix_helpers);
 	tcase_add_test(tc, ratelimit_helpers);
+	tcase_add_test(tc, log_ring_helpers);
+	tcase_add_test(tc, prediction_helpers);
 	tcase_add_test(tc, dpi_parser);
 	tcase_add_test(tc, wheel_click_parser);
 	tcase_add_test(tc, wheel_click_count_parser);
@@ -1427,6 +1629,7 @@ litest_utils_suite(void)
 
 	tcase_add_test(tc, list_test_insert);
 	tcase_add_test(tc, list_test_append);
+	tcase_add_test(tc, hash_table_test);
 	tcase_add_test(tc, strverscmp_test);
 	tcase_add_test(tc, streq_test);
 	tcase_add_test(tc, strneq_test);
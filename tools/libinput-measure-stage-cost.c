@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+
+#include <libinput.h>
+
+#include "util-macros.h"
+#include "shared.h"
+
+static volatile sig_atomic_t stop = 0;
+static bool passthrough = false;
+static struct libinput_device *devices[60];
+
+static const char *stage_names[] = {
+	[LIBINPUT_STAGE_READ] = "read",
+	[LIBINPUT_STAGE_TP_PRE_PROCESS_STATE] = "tp_pre_process_state",
+	[LIBINPUT_STAGE_TP_PROCESS_STATE] = "tp_process_state",
+	[LIBINPUT_STAGE_TP_THUMB] = "  tp_thumb",
+	[LIBINPUT_STAGE_TP_PALM] = "  tp_palm",
+	[LIBINPUT_STAGE_TP_BUTTONS] = "  tp_buttons",
+	[LIBINPUT_STAGE_TP_EDGE_SCROLL] = "  tp_edge_scroll",
+	[LIBINPUT_STAGE_TP_POST_EVENTS] = "tp_post_events",
+	[LIBINPUT_STAGE_TP_TAP] = "  tp_tap",
+	[LIBINPUT_STAGE_TP_GESTURE] = "tp_gesture",
+	[LIBINPUT_STAGE_FALLBACK_HANDLE_STATE] = "fallback_handle_state",
+	[LIBINPUT_STAGE_TABLET_FLUSH] = "tablet_flush",
+	[LIBINPUT_STAGE_FILTER_DISPATCH] = "filter_dispatch",
+};
+
+static void
+print_device_stages(struct libinput_device *device)
+{
+	bool header = false;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(stage_names); i++) {
+		uint64_t count, nsec, cycles;
+
+		if (libinput_device_get_stage_counters(device,
+						       i,
+						       &count,
+						       &nsec,
+						       &cycles) != 0 ||
+		    count == 0)
+			continue;
+
+		if (!header) {
+			printf("%s: %s\n",
+			       libinput_device_get_sysname(device),
+			       libinput_device_get_name(device));
+			printf("  %-24s %10s %12s %10s %12s\n",
+			       "stage", "count", "total (ms)",
+			       "avg (us)", "avg (cycles)");
+			header = true;
+		}
+
+		printf("  %-24s %10" PRIu64 " %12.3f %10.3f %12" PRIu64 "\n",
+		       stage_names[i],
+		       count,
+		       nsec/1000000.0,
+		       nsec/1000.0/count,
+		       cycles/count);
+	}
+
+	if (header)
+		printf("\n");
+}
+
+static void
+handle_events(struct libinput *li)
+{
+	struct libinput_event *ev;
+
+	tools_dispatch(li);
+	while ((ev = libinput_get_event(li))) {
+		struct libinput_device *device = libinput_event_get_device(ev);
+
+		switch (libinput_event_get_type(ev)) {
+		case LIBINPUT_EVENT_DEVICE_ADDED:
+			if (passthrough)
+				libinput_device_config_passthrough_set_enabled(device,
+						LIBINPUT_CONFIG_PASSTHROUGH_ENABLED);
+			for (size_t i = 0; i < ARRAY_LENGTH(devices); i++) {
+				if (devices[i] == NULL) {
+					devices[i] = libinput_device_ref(device);
+					break;
+				}
+			}
+			break;
+		case LIBINPUT_EVENT_DEVICE_REMOVED:
+			for (size_t i = 0; i < ARRAY_LENGTH(devices); i++) {
+				if (devices[i] == device) {
+					print_device_stages(device);
+					libinput_device_unref(device);
+					devices[i] = NULL;
+					break;
+				}
+			}
+			break;
+		default:
+			break;
+		}
+
+		libinput_event_destroy(ev);
+	}
+}
+
+static void
+sighandler(int signal, siginfo_t *siginfo, void *userdata)
+{
+	stop = 1;
+}
+
+static void
+mainloop(struct libinput *li)
+{
+	struct pollfd fds;
+
+	fds.fd = libinput_get_fd(li);
+	fds.events = POLLIN;
+	fds.revents = 0;
+
+	handle_events(li);
+
+	printf("Collecting stage counters, press Ctrl+C to stop and print the results\n");
+
+	while (!stop && poll(&fds, 1, -1) > -1)
+		handle_events(li);
+
+	printf("\n");
+
+	for (size_t i = 0; i < ARRAY_LENGTH(devices); i++) {
+		if (devices[i] == NULL)
+			continue;
+
+		print_device_stages(devices[i]);
+		libinput_device_unref(devices[i]);
+		devices[i] = NULL;
+	}
+}
+
+static void
+usage(void) {
+	printf("Usage: libinput measure stage-cost [--help] [--passthrough] [--udev <seat>|--device /dev/input/event0 ...]\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libinput *li;
+	enum tools_backend backend = BACKEND_NONE;
+	const char *seat_or_devices[60] = {NULL};
+	size_t ndevices = 0;
+	bool grab = false;
+	bool verbose = false;
+	struct sigaction act;
+
+	while (1) {
+		int c;
+		int option_index = 0;
+		enum {
+			OPT_DEVICE = 1,
+			OPT_UDEV,
+			OPT_VERBOSE,
+			OPT_PASSTHROUGH,
+		};
+		static struct option opts[] = {
+			{ "help",                      no_argument,       0, 'h' },
+			{ "device",                    required_argument, 0, OPT_DEVICE },
+			{ "udev",                      required_argument, 0, OPT_UDEV },
+			{ "verbose",                   no_argument,       0, OPT_VERBOSE },
+			{ "passthrough",               no_argument,       0, OPT_PASSTHROUGH },
+			{ 0, 0, 0, 0}
+		};
+
+		c = getopt_long(argc, argv, "h", opts, &option_index);
+		if (c == -1)
+			break;
+
+		switch(c) {
+		case 'h':
+			usage();
+			return EXIT_SUCCESS;
+		case OPT_DEVICE:
+			if (backend == BACKEND_UDEV ||
+			    ndevices >= ARRAY_LENGTH(seat_or_devices)) {
+				usage();
+				return EXIT_INVALID_USAGE;
+			}
+			backend = BACKEND_DEVICE;
+			seat_or_devices[ndevices++] = optarg;
+			break;
+		case OPT_UDEV:
+			if (backend == BACKEND_DEVICE ||
+			    ndevices >= ARRAY_LENGTH(seat_or_devices)) {
+				usage();
+				return EXIT_INVALID_USAGE;
+			}
+			backend = BACKEND_UDEV;
+			seat_or_devices[0] = optarg;
+			ndevices = 1;
+			break;
+		case OPT_VERBOSE:
+			verbose = true;
+			break;
+		case OPT_PASSTHROUGH:
+			passthrough = true;
+			break;
+		default:
+			usage();
+			return EXIT_INVALID_USAGE;
+		}
+	}
+
+	if (optind < argc) {
+		if (backend == BACKEND_UDEV) {
+			usage();
+			return EXIT_INVALID_USAGE;
+		}
+		backend = BACKEND_DEVICE;
+		do {
+			if (ndevices >= ARRAY_LENGTH(seat_or_devices)) {
+				usage();
+				return EXIT_INVALID_USAGE;
+			}
+			seat_or_devices[ndevices++] = argv[optind];
+		} while(++optind < argc);
+	} else if (backend == BACKEND_NONE) {
+		backend = BACKEND_UDEV;
+		seat_or_devices[0] = "seat0";
+	}
+
+	memset(&act, 0, sizeof(act));
+	act.sa_sigaction = sighandler;
+	act.sa_flags = SA_SIGINFO;
+
+	if (sigaction(SIGINT, &act, NULL) == -1) {
+		fprintf(stderr, "Failed to set up signal handling (%s)\n",
+				strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	li = tools_open_backend(backend, seat_or_devices, verbose, &grab);
+	if (!li)
+		return EXIT_FAILURE;
+
+	libinput_enable_stage_counters(li, 1);
+
+	mainloop(li);
+
+	libinput_unref(li);
+
+	return EXIT_SUCCESS;
+}
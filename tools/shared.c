@@ -107,6 +107,7 @@ tools_init_options(struct tools_options *options)
 	options->left_handed = -1;
 	options->middlebutton = -1;
 	options->dwt = -1;
+	options->gesture_low_latency = -1;
 	options->click_method = -1;
 	options->scroll_method = -1;
 	options->scroll_button = -1;
@@ -175,6 +176,12 @@ tools_parse_option(int option,
 	case OPT_DWT_DISABLE:
 		options->dwt = LIBINPUT_CONFIG_DWT_DISABLED;
 		break;
+	case OPT_GESTURE_LOW_LATENCY_ENABLE:
+		options->gesture_low_latency = LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_ENABLED;
+		break;
+	case OPT_GESTURE_LOW_LATENCY_DISABLE:
+		options->gesture_low_latency = LIBINPUT_CONFIG_GESTURE_LOW_LATENCY_DISABLED;
+		break;
 	case OPT_CLICK_METHOD:
 		if (!optarg)
 			return 1;
@@ -437,6 +444,10 @@ tools_device_apply_config(struct libinput_device *device,
 	if (options->dwt != -1)
 		libinput_device_config_dwt_set_enabled(device, options->dwt);
 
+	if (options->gesture_low_latency != -1)
+		libinput_device_config_gesture_low_latency_set_enabled(device,
+								       options->gesture_low_latency);
+
 	if (options->click_method != (enum libinput_config_click_method)-1)
 		libinput_device_config_click_set_method(device, options->click_method);
 